@@ -133,7 +133,9 @@ double ground_state(Simulation_context& ctx,
 
     if (ctx.control().print_stress_ && !ctx.full_potential()) {
         Stress& s       = dft.stress();
-        auto stress_tot = s.calc_stress_total();
+        /* forces are computed in the same pass over k-points if they are requested as well */
+        auto stress_tot = ctx.control().print_forces_ ? s.calc_stress_and_forces_total(dft.forces())
+                                                      : s.calc_stress_total();
         s.print_info();
         result["stress"] = std::vector<std::vector<double>>(3, std::vector<double>(3));
         for (int i = 0; i < 3; i++) {
@@ -144,7 +146,8 @@ double ground_state(Simulation_context& ctx,
     }
     if (ctx.control().print_forces_) {
         Force& f         = dft.forces();
-        auto& forces_tot = f.calc_forces_total();
+        auto& forces_tot = (ctx.control().print_stress_ && !ctx.full_potential()) ? f.forces_total()
+                                                                                  : f.calc_forces_total();
         f.print_info();
         result["forces"] = std::vector<std::vector<double>>(ctx.unit_cell().num_atoms(), std::vector<double>(3));
         for (int i = 0; i < ctx.unit_cell().num_atoms(); i++) {
@@ -333,17 +336,36 @@ void run_tasks(cmd_args const& args)
         potential.generate(density);
         Band band(*ctx);
         Hamiltonian0 H0(potential);
+        /* the subspace of the first k-point of each rank is initialized by Band::solve_band_structure() */
         if (!ctx->full_potential()) {
-            band.initialize_subspace(ks, H0);
             if (ctx->hubbard_correction()) {
                 TERMINATE("fix me");
                 //potential.U().compute_occupation_matrix(ks); // TODO: this is wrong; U matrix should come form the saved file
                 //potential.U().calculate_hubbard_potential_and_energy(potential.U().occupation_matrix());
             }
         }
-        band.solve(ks, H0, true);
+        /* each rank streams the band energies of its own part of the path as soon as they are available */
+        std::ofstream ofs_k;
+        if (ks.spl_num_kpoints().local_size() && ctx->comm_band().rank() == 0) {
+            std::stringstream s;
+            s << "bands." << std::setfill('0') << std::setw(4) << ctx->comm_k().rank() << ".dat";
+            ofs_k.open(s.str(), std::ofstream::out | std::ofstream::trunc);
+            ofs_k << std::scientific << std::setprecision(12);
+        }
+        band.solve_band_structure(ks, H0, [&](int ik)
+            {
+                if (!ofs_k.is_open()) {
+                    return;
+                }
+                ofs_k << ik << " " << x_axis[ik];
+                for (int ispn = 0; ispn < ctx->num_spin_dims(); ispn++) {
+                    for (int j = 0; j < ctx->num_bands(); j++) {
+                        ofs_k << " " << ks[ik]->band_energy(j, ispn);
+                    }
+                }
+                ofs_k << std::endl;
+            });
 
-        ks.sync_band_energies();
         if (Communicator::world().rank() == 0) {
             json dict;
             dict["header"] = {};
@@ -393,6 +415,7 @@ int main(int argn, char** argv)
     args.register_key("--test_against=", "{string} json file with reference values");
     args.register_key("--repeat_update=", "{int} number of times to repeat update()");
     args.register_key("--fpe", "enable check of floating-point exceptions using GNUC library");
+    args.register_key("--timer_trace=", "{string} file name of the timer trace in Chrome trace event format");
     args.register_key("--control.processing_unit=", "");
     args.register_key("--control.verbosity=", "");
     args.register_key("--control.verification=", "");
@@ -435,6 +458,10 @@ int main(int argn, char** argv)
                                           rt_graph::Stat::Max});
         std::ofstream ofs("timers.json", std::ofstream::out | std::ofstream::trunc);
         ofs << timing_result.json();
+        if (args.exist("timer_trace")) {
+            std::ofstream ofs_trace(args.value<std::string>("timer_trace"), std::ofstream::out | std::ofstream::trunc);
+            ofs_trace << ::utils::global_rtgraph_timer.trace_json();
+        }
     }
     if (std::fetestexcept(FE_DIVBYZERO)) {
         std::cout << "FE_DIVBYZERO exception\n";
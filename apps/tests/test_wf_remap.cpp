@@ -0,0 +1,115 @@
+#include <sirius.hpp>
+
+using namespace sirius;
+
+/* benchmark of the wave-functions remapping between the slab and the FFT-friendly distributions */
+void test_wf_remap(std::vector<int> mpi_grid_dims__, double cutoff__, int num_bands__, int num_repeat__)
+{
+    MPI_grid mpi_grid(mpi_grid_dims__, Communicator::world());
+
+    auto& comm_fft   = mpi_grid.communicator(1 << 0);
+    auto& comm_ortho = mpi_grid.communicator(1 << 1);
+
+    matrix3d<double> M = {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+
+    /* create G-vectors */
+    Gvec gvec(M, cutoff__, Communicator::world(), false);
+
+    Gvec_partition gvp(gvec, comm_fft, comm_ortho);
+
+    if (Communicator::world().rank() == 0) {
+        printf("number of bands          : %i\n", num_bands__);
+        printf("total number of G-vectors: %i\n", gvec.num_gvec());
+        printf("FFT communicator size    : %i\n", comm_fft.size());
+        printf("ortho communicator size  : %i\n", comm_ortho.size());
+    }
+
+    matrix_storage<double_complex, matrix_storage_t::slab> mst(gvp, num_bands__);
+    for (int i = 0; i < num_bands__; i++) {
+        for (int igloc = 0; igloc < gvec.count(); igloc++) {
+            mst.prime(igloc, i) = double_complex(gvec.offset() + igloc, i);
+        }
+    }
+
+    double t_fwd{0};
+    double t_bwd{0};
+    for (int k = 0; k < num_repeat__; k++) {
+        Communicator::world().barrier();
+        auto t0 = utils::time_now();
+        mst.remap_forward(num_bands__, 0, nullptr);
+        t_fwd += utils::time_interval(t0);
+
+        /* check the remapped data */
+        for (int i = 0; i < mst.spl_num_col().local_size(); i++) {
+            int j = mst.spl_num_col()[i];
+            for (int igloc = 0; igloc < gvp.gvec_count_fft(); igloc++) {
+                int ig = gvp.idx_gvec(igloc);
+                if (std::abs(mst.extra()(igloc, i) - double_complex(ig, j)) > 1e-12) {
+                    TERMINATE("wrong remapped data");
+                }
+            }
+        }
+
+        mst.zero(memory_t::host, 0, num_bands__);
+
+        Communicator::world().barrier();
+        t0 = utils::time_now();
+        mst.remap_backward(num_bands__, 0);
+        t_bwd += utils::time_interval(t0);
+    }
+
+    double diff{0};
+    for (int i = 0; i < num_bands__; i++) {
+        for (int igloc = 0; igloc < gvec.count(); igloc++) {
+            diff += std::abs(mst.prime(igloc, i) - double_complex(gvec.offset() + igloc, i));
+        }
+    }
+    Communicator::world().allreduce(&diff, 1);
+    Communicator::world().allreduce<double, mpi_op_t::max>(&t_fwd, 1);
+    Communicator::world().allreduce<double, mpi_op_t::max>(&t_bwd, 1);
+
+    if (Communicator::world().rank() == 0) {
+        printf("remap_forward time : %12.6f sec.\n", t_fwd / num_repeat__);
+        printf("remap_backward time: %12.6f sec.\n", t_bwd / num_repeat__);
+        printf("difference         : %18.12f\n", diff);
+        if (diff > 1e-12) {
+            printf("\x1b[31m" "Fail\n" "\x1b[0m" "\n");
+        } else {
+            printf("\x1b[32m" "OK\n" "\x1b[0m" "\n");
+        }
+    }
+}
+
+int main(int argn, char** argv)
+{
+    cmd_args args;
+    args.register_key("--mpi_grid_dims=", "{int int} dimensions of MPI grid (FFT and orthogonal communicators)");
+    args.register_key("--cutoff=", "{double} wave-functions cutoff");
+    args.register_key("--num_bands=", "{int} number of bands");
+    args.register_key("--repeat=", "{int} number of repetitions");
+
+    args.parse_args(argn, argv);
+    if (args.exist("help")) {
+        printf("Usage: %s [options]\n", argv[0]);
+        args.print_help();
+        return 0;
+    }
+    auto mpi_grid_dims = args.value<std::vector<int>>("mpi_grid_dims", {1, 1});
+    auto cutoff = args.value<double>("cutoff", 8.0);
+    auto num_bands = args.value<int>("num_bands", 100);
+    auto repeat = args.value<int>("repeat", 10);
+
+    sirius::initialize(1);
+
+    test_wf_remap(mpi_grid_dims, cutoff, num_bands, repeat);
+
+    Communicator::world().barrier();
+    int rank = Communicator::world().rank();
+
+    sirius::finalize(1);
+
+    if (rank == 0)  {
+        const auto timing_result = ::utils::global_rtgraph_timer.process();
+        std::cout << timing_result.print();
+    }
+}
@@ -0,0 +1,141 @@
+#include <sirius.hpp>
+#include "dft/smearing.hpp"
+
+using namespace sirius;
+
+/* compare Fermi energy and band occupancies found by K_point_set::find_band_occupancies() with the
+   step-and-halve search over all k-points */
+int run_test(cmd_args& args)
+{
+    auto nk = args.value<int>("nk", 17);
+
+    /* create simulation context */
+    Simulation_context ctx(
+        "{"
+        "   \"parameters\" : {"
+        "        \"electronic_structure_method\" : \"pseudopotential\""
+        "    }"
+        "}", Communicator::world());
+
+    /* add a new atom type to the unit cell */
+    auto& atype = ctx.unit_cell().add_atom_type("A");
+    atype.zn(3);
+    atype.set_radial_grid(radial_grid_t::lin_exp, 1000, 0.0, 20.0, 6);
+    std::vector<double> vloc(atype.radial_grid().num_points(), 0);
+    atype.local_potential(vloc);
+    std::vector<double> arho(atype.radial_grid().num_points());
+    for (int i = 0; i < atype.radial_grid().num_points(); i++) {
+        double x = atype.radial_grid(i);
+        arho[i] = 2 * atype.zn() * std::exp(-x * x) * x;
+    }
+    atype.ps_total_charge_density(arho);
+
+    ctx.unit_cell().set_lattice_vectors({{5, 0, 0}, {0, 5, 0}, {0, 0, 5}});
+    ctx.unit_cell().add_atom("A", {0.1, 0.2, 0.3});
+    ctx.unit_cell().add_atom("A", {0.6, 0.7, 0.8});
+
+    ctx.pw_cutoff(10);
+    ctx.gk_cutoff(3);
+    ctx.num_bands(12);
+    ctx.initialize();
+
+    /* k-points with different weights; the weights sum up to one */
+    std::vector<double> wk(nk);
+    for (int ik = 0; ik < nk; ik++) {
+        wk[ik] = 1.0 + 0.1 * (ik % 3);
+    }
+    double wsum = std::accumulate(wk.begin(), wk.end(), 0.0);
+
+    K_point_set kset(ctx);
+    for (int ik = 0; ik < nk; ik++) {
+        double vk[] = {0.5 * ik / nk, 0.1, 0.2};
+        kset.add_kpoint(vk, wk[ik] / wsum);
+    }
+    kset.initialize();
+
+    /* band energies are set on all ranks for all k-points */
+    for (int ik = 0; ik < nk; ik++) {
+        for (int ispn = 0; ispn < ctx.num_spin_dims(); ispn++) {
+            for (int j = 0; j < ctx.num_bands(); j++) {
+                kset[ik]->band_energy(j, ispn, -0.5 + 0.1 * j + 0.05 * std::sin(ik + 0.3 * j + ispn));
+            }
+        }
+    }
+
+    double ne_target = ctx.unit_cell().num_valence_electrons();
+    int nerr{0};
+
+    for (double delta : {0.1, 0.01, 0.001}) {
+        ctx.set_smearing_width(delta);
+        kset.find_band_occupancies();
+        double ef = kset.energy_fermi();
+
+        /* reference: step-and-halve search of the Fermi energy */
+        auto num_electrons = [&](double ef__) {
+            double ne{0};
+            for (int ik = 0; ik < nk; ik++) {
+                for (int ispn = 0; ispn < ctx.num_spin_dims(); ispn++) {
+                    for (int j = 0; j < ctx.num_bands(); j++) {
+                        ne += smearing::gaussian(kset[ik]->band_energy(j, ispn) - ef__, delta) *
+                              ctx.max_occupancy() * kset[ik]->weight();
+                    }
+                }
+            }
+            return ne;
+        };
+        double ef_ref{0};
+        double de{0.1};
+        int s{1};
+        double ne{0};
+        for (int step = 0; std::abs(ne - ne_target) >= 1e-11 && step < 10000; step++) {
+            ef_ref += de;
+            ne = num_electrons(ef_ref);
+            int sp = s;
+            s = (ne > ne_target) ? -1 : 1;
+            de = (s != sp) ? (-de * 0.5) : (de * 1.25);
+        }
+
+        /* both searches converge the number of electrons; occupancies must agree */
+        double diff{0};
+        for (int ik = 0; ik < nk; ik++) {
+            for (int ispn = 0; ispn < ctx.num_spin_dims(); ispn++) {
+                for (int j = 0; j < ctx.num_bands(); j++) {
+                    double occ = smearing::gaussian(kset[ik]->band_energy(j, ispn) - ef_ref, delta) *
+                                 ctx.max_occupancy();
+                    diff = std::max(diff, std::abs(occ - kset[ik]->band_occupancy(j, ispn)));
+                }
+            }
+        }
+        if (std::abs(num_electrons(ef) - ne_target) > 1e-10 || diff > 1e-8) {
+            printf("smearing width: %f, Fermi energy: %18.12f, reference: %18.12f, occupancy difference: %18.12e\n",
+                   delta, ef, ef_ref, diff);
+            nerr++;
+        }
+    }
+    return nerr;
+}
+
+int main(int argn, char** argv)
+{
+    cmd_args args;
+    args.register_key("--nk=", "{int} number of k-points");
+
+    args.parse_args(argn, argv);
+    if (args.exist("help")) {
+        printf("Usage: %s [options]\n", argv[0]);
+        args.print_help();
+        return 0;
+    }
+
+    sirius::initialize(true);
+    printf("running %-30s : ", argv[0]);
+    int result = run_test(args);
+    if (result) {
+        printf("\x1b[31m" "Failed" "\x1b[0m" "\n");
+    } else {
+        printf("\x1b[32m" "OK" "\x1b[0m" "\n");
+    }
+    sirius::finalize();
+
+    return result;
+}
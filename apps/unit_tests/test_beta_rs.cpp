@@ -0,0 +1,147 @@
+#include <sirius.hpp>
+
+using namespace sirius;
+
+/* compare <beta|psi> computed with the real-space beta-projectors against the plane-wave beta-projectors */
+int run_test(cmd_args& args)
+{
+    auto gk_cutoff = args.value<double>("gk_cutoff", 10);
+    auto a         = args.value<double>("a", 5);
+
+    /* create simulation context */
+    Simulation_context ctx(
+        "{"
+        "   \"parameters\" : {"
+        "        \"electronic_structure_method\" : \"pseudopotential\""
+        "    },"
+        "   \"control\" : {"
+        "       \"beta_real_space\" : true"
+        "    }"
+        "}", Communicator::self());
+
+    /* add a new atom type to the unit cell */
+    auto& atype = ctx.unit_cell().add_atom_type("A");
+    atype.zn(1);
+    atype.set_radial_grid(radial_grid_t::lin_exp, 1000, 0.0, 20.0, 6);
+    /* smooth beta-projectors; the projector sphere (twice the cutoff radius of beta) is larger than the cell */
+    std::vector<double> beta(atype.radial_grid().num_points());
+    for (int l = 0; l <= 2; l++) {
+        for (int i = 0; i < atype.radial_grid().num_points(); i++) {
+            double x = atype.radial_grid(i);
+            beta[i] = std::pow(x, l + 1) * std::exp(-2 * x * x);
+        }
+        atype.add_beta_radial_function(l, beta);
+    }
+    std::vector<double> vloc(atype.radial_grid().num_points(), 0);
+    atype.local_potential(vloc);
+    int nbf = atype.num_beta_radial_functions();
+    matrix<double> dion(nbf, nbf);
+    dion.zero();
+    atype.d_mtrx_ion(dion);
+    std::vector<double> arho(atype.radial_grid().num_points());
+    for (int i = 0; i < atype.radial_grid().num_points(); i++) {
+        double x = atype.radial_grid(i);
+        arho[i] = 2 * atype.zn() * std::exp(-x * x) * x;
+    }
+    atype.ps_total_charge_density(arho);
+
+    ctx.unit_cell().set_lattice_vectors({{a, 0, 0}, {0, a, 0}, {0, 0, a}});
+    ctx.unit_cell().add_atom("A", {0.1, 0.2, 0.3});
+    ctx.unit_cell().add_atom("A", {0.6, 0.7, 0.8});
+
+    ctx.pw_cutoff(2 * gk_cutoff);
+    ctx.gk_cutoff(gk_cutoff);
+    ctx.num_bands(4);
+    ctx.initialize();
+
+    if (!ctx.beta_real_space()) {
+        return 1;
+    }
+
+    double vk[] = {0.1, 0.2, 0.3};
+    K_point kp(ctx, vk, 1.0, 0);
+    kp.initialize();
+
+    auto& psi = kp.spinor_wave_functions();
+    int nwf   = ctx.num_bands();
+    for (int i = 0; i < nwf; i++) {
+        for (int ig = 0; ig < kp.num_gkvec_loc(); ig++) {
+            psi.pw_coeffs(0).prime(ig, i) = utils::random<double_complex>();
+        }
+    }
+
+    /* plane-wave projections */
+    int nbeta = ctx.unit_cell().mt_lo_basis_size();
+    matrix<double_complex> beta_psi_pw(nbeta, nwf);
+    auto& bp = kp.beta_projectors();
+    bp.prepare();
+    for (int ichunk = 0; ichunk < bp.num_chunks(); ichunk++) {
+        bp.generate(ichunk);
+        auto bpsi = bp.inner<double_complex>(ichunk, psi, 0, 0, nwf);
+        for (int i = 0; i < bp.chunk(ichunk).num_atoms_; i++) {
+            int ia  = bp.chunk(ichunk).desc_(static_cast<int>(beta_desc_idx::ia), i);
+            int ofs = bp.chunk(ichunk).desc_(static_cast<int>(beta_desc_idx::offset), i);
+            for (int j = 0; j < nwf; j++) {
+                for (int xi = 0; xi < ctx.unit_cell().atom(ia).mt_basis_size(); xi++) {
+                    beta_psi_pw(ctx.unit_cell().atom(ia).offset_lo() + xi, j) = bpsi(ofs + xi, j);
+                }
+            }
+        }
+    }
+    bp.dismiss();
+
+    /* real-space projections */
+    auto& spfftk = kp.spfft_transform();
+    psi.pw_coeffs(0).remap_forward(nwf, 0, &ctx.mem_pool(memory_t::host));
+    auto buf = reinterpret_cast<double_complex*>(spfftk.space_domain_data(SPFFT_PU_HOST));
+    int nr   = spfftk.local_slice_size();
+    mdarray<double_complex, 2> psi_r(nr, nwf);
+    for (int j = 0; j < nwf; j++) {
+        spfftk.backward(reinterpret_cast<double const*>(psi.pw_coeffs(0).extra().at(memory_t::host, 0, j)),
+                        SPFFT_PU_HOST);
+        std::copy(buf, buf + nr, &psi_r(0, j));
+    }
+    mdarray<double_complex, 2> beta_psi_rs(nbeta, nwf);
+    kp.beta_projectors_rs()->inner(nwf, psi_r.at(memory_t::host), nr, beta_psi_rs);
+
+    double diff{0};
+    double norm{0};
+    for (int j = 0; j < nwf; j++) {
+        for (int xi = 0; xi < nbeta; xi++) {
+            diff = std::max(diff, std::abs(beta_psi_rs(xi, j) - beta_psi_pw(xi, j)));
+            norm = std::max(norm, std::abs(beta_psi_pw(xi, j)));
+        }
+    }
+    /* real-space projectors are Fourier-filtered and truncated, so the agreement is only approximate */
+    if (diff > 5e-3 * norm) {
+        printf("maximum difference of <beta|psi>: %18.12e, maximum |<beta|psi>|: %18.12e\n", diff, norm);
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argn, char** argv)
+{
+    cmd_args args;
+    args.register_key("--gk_cutoff=", "{double} cutoff for the wave-functions");
+    args.register_key("--a=", "{double} lattice constant");
+
+    args.parse_args(argn, argv);
+    if (args.exist("help")) {
+        printf("Usage: %s [options]\n", argv[0]);
+        args.print_help();
+        return 0;
+    }
+
+    sirius::initialize(true);
+    printf("running %-30s : ", argv[0]);
+    int result = run_test(args);
+    if (result) {
+        printf("\x1b[31m" "Failed" "\x1b[0m" "\n");
+    } else {
+        printf("\x1b[32m" "OK" "\x1b[0m" "\n");
+    }
+    sirius::finalize();
+
+    return result;
+}
@@ -23,7 +23,40 @@ int run_test(cmd_args& args)
     if (gvec_r.num_gvec() * 2 != gvec.num_gvec() + 1) {
         return 1;
     }
-    return 0;
+
+    /* shell index of the remote G-vectors must match the shell index stored by the owner rank */
+    std::vector<int> igsh(gvec.num_gvec());
+    for (int igloc = 0; igloc < gvec.count(); igloc++) {
+        igsh[gvec.offset() + igloc] = gvec.shell(gvec.offset() + igloc);
+    }
+    gvec.comm().allgather(igsh.data(), gvec.offset(), gvec.count());
+    int nerr{0};
+    for (int ig = 0; ig < gvec.num_gvec(); ig++) {
+        if (gvec.shell(ig) != igsh[ig]) {
+            nerr++;
+        }
+    }
+
+    /* G-vectors remapped by shells must come back unchanged */
+    Gvec_shells gvec_shells(gvec);
+    std::vector<int> idx(gvec.count());
+    std::iota(idx.begin(), idx.end(), gvec.offset());
+    auto idx_remapped = gvec_shells.remap_forward(idx.data());
+    for (int igloc = 0; igloc < gvec_shells.gvec_count_remapped(); igloc++) {
+        int ig = idx_remapped[igloc];
+        auto G = gvec_shells.gvec_remapped(igloc);
+        if (gvec.index_by_gvec(G) != ig || gvec_shells.gvec_shell_remapped(igloc) != igsh[ig]) {
+            nerr++;
+        }
+    }
+    std::vector<int> idx1(gvec.count());
+    gvec_shells.remap_backward(idx_remapped, idx1.data());
+    if (idx1 != idx) {
+        nerr++;
+    }
+    gvec.comm().allreduce(&nerr, 1);
+
+    return nerr ? 1 : 0;
 }
 
 int main(int argn, char** argv)
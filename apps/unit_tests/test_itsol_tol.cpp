@@ -0,0 +1,159 @@
+#include <sirius.hpp>
+
+using namespace sirius;
+
+/* check the bounds of the k-point tolerance and of the number of steps of the iterative solver set by
+   DFT_ground_state::adapt_iterative_solver_tolerance() and their reset in DFT_ground_state::find() */
+int run_test(cmd_args& args)
+{
+    auto nk = args.value<int>("nk", 5);
+
+    /* create simulation context */
+    Simulation_context ctx(
+        "{"
+        "   \"parameters\" : {"
+        "        \"electronic_structure_method\" : \"pseudopotential\","
+        "        \"xc_functionals\" : [\"XC_LDA_X\", \"XC_LDA_C_PZ\"],"
+        "        \"smearing_width\" : 0.05"
+        "    },"
+        "   \"iterative_solver\" : {"
+        "        \"init_subspace\" : \"random\","
+        "        \"adaptive_tolerance\" : true,"
+        "        \"num_steps\" : 20"
+        "    }"
+        "}", Communicator::world());
+
+    /* add a new atom type to the unit cell */
+    auto& atype = ctx.unit_cell().add_atom_type("A");
+    atype.zn(2);
+    atype.set_radial_grid(radial_grid_t::lin_exp, 1000, 0.0, 20.0, 6);
+    std::vector<double> vloc(atype.radial_grid().num_points());
+    std::vector<double> arho(atype.radial_grid().num_points());
+    for (int i = 0; i < atype.radial_grid().num_points(); i++) {
+        double x = atype.radial_grid(i);
+        vloc[i]  = -atype.zn() * std::erf(x) / std::max(x, 1e-12);
+        arho[i]  = 2 * atype.zn() * std::exp(-x * x) * x;
+    }
+    vloc[0] = -atype.zn() * 2 / std::sqrt(pi);
+    atype.local_potential(vloc);
+    atype.ps_total_charge_density(arho);
+
+    ctx.unit_cell().set_lattice_vectors({{5, 0, 0}, {0, 5, 0}, {0, 0, 5}});
+    ctx.unit_cell().add_atom("A", {0.1, 0.2, 0.3});
+
+    ctx.pw_cutoff(10);
+    ctx.gk_cutoff(3);
+    ctx.num_bands(4);
+    ctx.initialize();
+
+    K_point_set kset(ctx);
+    for (int ik = 0; ik < nk; ik++) {
+        double vk[] = {0.5 * ik / nk, 0.1, 0.2};
+        kset.add_kpoint(vk, 1.0 / nk);
+    }
+    kset.initialize();
+
+    DFT_ground_state dft(kset);
+    dft.initial_state();
+
+    double tol_min  = ctx.settings().itsol_tol_min_;
+    int num_steps   = ctx.iterative_solver_input().num_steps_;
+    int ns_min      = std::max(2, static_cast<int>(std::round(0.5 * num_steps)));
+    int ns_max      = static_cast<int>(std::round(1.5 * num_steps));
+    double tol_max0 = 1e-2;
+
+    int nerr{0};
+
+    auto check_reset = [&](std::string label) {
+        for (int ikloc = 0; ikloc < kset.spl_num_kpoints().local_size(); ikloc++) {
+            auto kp = kset[kset.spl_num_kpoints(ikloc)];
+            if (kp->iterative_solver_tolerance() != ctx.iterative_solver_tolerance() ||
+                kp->iterative_solver_num_steps() != num_steps) {
+                printf("%s: k-point tolerance %18.12e and number of steps %i are not reset\n", label.c_str(),
+                       kp->iterative_solver_tolerance(), kp->iterative_solver_num_steps());
+                nerr++;
+            }
+        }
+    };
+
+    /* band energies change by the decreasing amount between the calls */
+    kset.find_band_occupancies();
+    for (double tol : {1e-3, 1e-5, 1e-8, 1e-11, 1e-14}) {
+        ctx.iterative_solver_tolerance(tol);
+        for (double de : {1e-1, 1e-4, 1e-7, 1e-10, 1e-13, 0.0}) {
+            for (int ikloc = 0; ikloc < kset.spl_num_kpoints().local_size(); ikloc++) {
+                auto kp = kset[kset.spl_num_kpoints(ikloc)];
+                for (int j = 0; j < ctx.num_bands(); j++) {
+                    kp->band_energy(j, 0, kp->band_energy(j, 0) + de * (j + 1) * (ikloc + 1));
+                }
+            }
+            dft.adapt_iterative_solver_tolerance(tol_max0);
+
+            double tol_lo = std::max(tol_min, tol);
+            double tol_hi = std::max(tol_lo, std::min(10 * tol, std::max(tol_max0, tol)));
+            for (int ikloc = 0; ikloc < kset.spl_num_kpoints().local_size(); ikloc++) {
+                auto kp = kset[kset.spl_num_kpoints(ikloc)];
+                double tol_k = kp->iterative_solver_tolerance();
+                int ns       = kp->iterative_solver_num_steps();
+                if (tol_k < tol_lo * (1 - 1e-12) || tol_k > tol_hi * (1 + 1e-12) || ns < ns_min || ns > ns_max) {
+                    printf("tol: %12.6e, de: %12.6e, tol_k: %12.6e is not in [%12.6e, %12.6e] "
+                           "or num_steps: %i is not in [%i, %i]\n", tol, de, tol_k, tol_lo, tol_hi, ns, ns_min,
+                           ns_max);
+                    nerr++;
+                }
+            }
+        }
+        dft.reset_iterative_solver_tolerance();
+        check_reset("reset_iterative_solver_tolerance()");
+    }
+
+    /* leave the stale band energies and k-point tolerances of a previous run */
+    dft.adapt_iterative_solver_tolerance(tol_max0);
+    dft.adapt_iterative_solver_tolerance(tol_max0);
+
+    double initial_tolerance{1e-4};
+    auto result = dft.find(1e-12, 1e-12, initial_tolerance, 2, false);
+
+    /* band energies of the previous run must be forgotten: the first SCF iteration uses the global tolerance */
+    auto& hist = result["itsol_history"];
+    if (hist.size() == 0) {
+        printf("itsol_history is empty\n");
+        nerr++;
+    } else {
+        double tol = hist[0]["tolerance"].get<double>();
+        auto tol_k = hist[0]["tolerance_k"].get<std::vector<double>>();
+        if (tol_k[0] != std::max(tol_min, tol) || tol_k[1] != std::max(tol_min, tol)) {
+            printf("first SCF iteration: k-point tolerance [%12.6e, %12.6e] differs from the global value %12.6e\n",
+                   tol_k[0], tol_k[1], tol);
+            nerr++;
+        }
+    }
+    check_reset("find()");
+
+    return nerr;
+}
+
+int main(int argn, char** argv)
+{
+    cmd_args args;
+    args.register_key("--nk=", "{int} number of k-points");
+
+    args.parse_args(argn, argv);
+    if (args.exist("help")) {
+        printf("Usage: %s [options]\n", argv[0]);
+        args.print_help();
+        return 0;
+    }
+
+    sirius::initialize(true);
+    printf("running %-30s : ", argv[0]);
+    int result = run_test(args);
+    if (result) {
+        printf("\x1b[31m" "Failed" "\x1b[0m" "\n");
+    } else {
+        printf("\x1b[32m" "OK" "\x1b[0m" "\n");
+    }
+    sirius::finalize();
+
+    return result;
+}
@@ -0,0 +1,109 @@
+#include <sirius.hpp>
+#include "mixer/mixer_factory.hpp"
+
+using namespace sirius;
+
+/* solve a small non-linear fixed-point problem x = f(x) with each of the mixers */
+int run_test(cmd_args& args)
+{
+    auto n = args.value<int>("n", 50);
+
+    auto& comm = Communicator::world();
+
+    /* vectors are replicated; the local inner product is a fraction of the full one, so that the sum over
+       the communicator gives the full inner product */
+    auto prop = mixer::FunctionProperties<std::vector<double>>(
+        [](const std::vector<double>& x) -> double { return x.size(); },
+        [](const std::vector<double>& x, const std::vector<double>& y) {
+            return std::inner_product(x.begin(), x.end(), y.begin(), 0.0);
+        },
+        [](double alpha, std::vector<double>& x) {
+            for (auto& v : x) {
+                v *= alpha;
+            }
+        },
+        [](const std::vector<double>& x, std::vector<double>& y) { y = x; },
+        [](double alpha, const std::vector<double>& x, std::vector<double>& y) {
+            for (size_t i = 0; i < x.size(); i++) {
+                y[i] += alpha * x[i];
+            }
+        },
+        [&comm](const std::vector<double>& x, const std::vector<double>& y) {
+            return std::inner_product(x.begin(), x.end(), y.begin(), 0.0) / comm.size();
+        });
+
+    std::map<std::string, std::vector<double>> solution;
+    std::map<std::string, int> num_iter;
+    for (std::string type : {"linear", "broyden1", "broyden2"}) {
+        Mixer_input cfg;
+        cfg.type_                = type;
+        cfg.beta_                = 0.5;
+        cfg.beta0_               = 0.1;
+        cfg.beta_scaling_factor_ = 1.0;
+        cfg.max_history_         = 6;
+
+        auto mixer = mixer::Mixer_factory<std::vector<double>>(cfg, comm);
+
+        std::vector<double> x(n, 0);
+        mixer->initialize_function<0>(prop, x, n);
+
+        double rms{1};
+        int iter{0};
+        for (; iter < 200 && rms > 1e-7; iter++) {
+            std::vector<double> fx(n);
+            for (int i = 0; i < n; i++) {
+                fx[i] = 0.3 * std::cos(x[i]) + 0.2 * x[(i + 1) % n] + 1.0 / (i + 1);
+            }
+            mixer->set_input<0>(fx);
+            rms = mixer->mix(1e-7);
+            mixer->get_output<0>(x);
+        }
+        if (rms > 1e-7) {
+            printf("%s mixer is not converged, rms: %18.12e\n", type.c_str(), rms);
+            return 1;
+        }
+        solution[type] = x;
+        num_iter[type] = iter;
+    }
+
+    /* all mixers must find the same fixed point */
+    for (std::string type : {"broyden1", "broyden2"}) {
+        for (int i = 0; i < n; i++) {
+            if (std::abs(solution[type][i] - solution["linear"][i]) > 1e-6) {
+                printf("wrong solution of %s mixer\n", type.c_str());
+                return 1;
+            }
+        }
+    }
+    /* Broyden mixer must converge faster than the linear one */
+    if (num_iter["broyden1"] >= num_iter["linear"]) {
+        printf("number of iterations: linear: %i, broyden1: %i\n", num_iter["linear"], num_iter["broyden1"]);
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argn, char** argv)
+{
+    cmd_args args;
+    args.register_key("--n=", "{int} size of the problem");
+
+    args.parse_args(argn, argv);
+    if (args.exist("help")) {
+        printf("Usage: %s [options]\n", argv[0]);
+        args.print_help();
+        return 0;
+    }
+
+    sirius::initialize(true);
+    printf("running %-30s : ", argv[0]);
+    int result = run_test(args);
+    if (result) {
+        printf("\x1b[31m" "Failed" "\x1b[0m" "\n");
+    } else {
+        printf("\x1b[32m" "OK" "\x1b[0m" "\n");
+    }
+    sirius::finalize();
+
+    return result;
+}
@@ -358,6 +358,52 @@ int test6()
     return 0;
 }
 
+int test7()
+{
+    auto rgrid = Radial_grid_factory<double>(radial_grid_t::exponential, 1000, 1e-7, 2.0, 1.0);
+    SHT sht(device_t::CPU, 8);
+
+    Spheric_function<function_domain_t::spatial, double> vxc_tp(sht.num_points(), rgrid);
+    Spheric_function<function_domain_t::spatial, double> vsigma_tp(sht.num_points(), rgrid);
+    Spheric_function<function_domain_t::spatial, double> lapl_rho_tp(sht.num_points(), rgrid);
+    Spheric_vector_function<function_domain_t::spatial, double> grad_rho_tp(sht.num_points(), rgrid);
+
+    for (int ir = 0; ir < rgrid.num_points(); ir++) {
+        for (int tp = 0; tp < sht.num_points(); tp++) {
+            vxc_tp(tp, ir)      = utils::random<double>();
+            vsigma_tp(tp, ir)   = utils::random<double>();
+            lapl_rho_tp(tp, ir) = utils::random<double>();
+            for (int x: {0, 1, 2}) {
+                grad_rho_tp[x](tp, ir) = utils::random<double>();
+            }
+        }
+    }
+
+    /* reference result computed with the operators */
+    Spheric_function<function_domain_t::spatial, double> vxc_ref(sht.num_points(), rgrid);
+    vxc_tp >> vxc_ref;
+    vxc_ref -= 2.0 * vsigma_tp * lapl_rho_tp;
+    auto grad_rho_grad_rho_ref = grad_rho_tp * grad_rho_tp;
+
+    /* the same result computed in a single pass */
+    pointwise(vxc_tp, [&](size_t i) { return vxc_tp[i] - 2.0 * vsigma_tp[i] * lapl_rho_tp[i]; });
+    Spheric_function<function_domain_t::spatial, double> grad_rho_grad_rho_tp(sht.num_points(), rgrid);
+    dot(grad_rho_tp, grad_rho_tp, grad_rho_grad_rho_tp);
+
+    double d{0};
+    for (int ir = 0; ir < rgrid.num_points(); ir++) {
+        for (int tp = 0; tp < sht.num_points(); tp++) {
+            d += std::abs(vxc_tp(tp, ir) - vxc_ref(tp, ir));
+            d += std::abs(grad_rho_grad_rho_tp(tp, ir) - grad_rho_grad_rho_ref(tp, ir));
+        }
+    }
+    if (d < 1e-10) {
+        return 0;
+    } else {
+        return 1;
+    }
+}
+
 int main(int argn, char** argv)
 {
     int err{0};
@@ -369,6 +415,7 @@ int main(int argn, char** argv)
     err += call_test("Gradient", test4);
     err += call_test("Many gradients", test5);
     err += call_test("MT rho", test6);
+    err += call_test("Pointwise expressions", test7);
 
     return std::min(err, 1);
 }
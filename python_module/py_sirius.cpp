@@ -96,12 +96,34 @@ std::string show_vec(const vector3d<T>& vec)
 // forward declaration
 void initialize_subspace(DFT_ground_state&, Simulation_context&);
 void apply_hamiltonian(Hamiltonian0& H0, K_point& kp, Wave_functions& wf_out, Wave_functions& wf, std::shared_ptr<Wave_functions>& swf);
+void apply_h_s(Hamiltonian0& H0, K_point& kp, Wave_functions& psi, std::shared_ptr<Wave_functions>& hpsi,
+               std::shared_ptr<Wave_functions>& spsi, int N, int n);
 
     /* typedefs */
     template <typename T>
     using matrix_storage_slab = sddk::matrix_storage<T, sddk::matrix_storage_t::slab>;
     using complex_double      = std::complex<double>;
 
+/// Describe the host memory of mdarray for the Python buffer protocol.
+/** Numpy arrays created from this buffer are column-major views of the mdarray data and keep the owner alive. */
+template <typename T, int N>
+py::buffer_info mdarray_buffer_info(mdarray<T, N>& arr__)
+{
+    if (arr__.at(memory_t::host) == nullptr) {
+        throw std::runtime_error("trying to access null pointer");
+    }
+    std::vector<py::ssize_t> shape(N);
+    std::vector<py::ssize_t> strides(N);
+    py::ssize_t stride = sizeof(T);
+    for (int i = 0; i < N; i++) {
+        shape[i]   = arr__.size(i);
+        strides[i] = stride;
+        stride *= arr__.size(i);
+    }
+    return py::buffer_info(arr__.at(memory_t::host), sizeof(T), py::format_descriptor<T>::format(), N, shape,
+                           strides);
+}
+
 PYBIND11_MODULE(py_sirius, m)
 {
     // this is needed to be able to pass MPI_Comm from Python->C++
@@ -541,6 +563,8 @@ PYBIND11_MODULE(py_sirius, m)
     py::class_<Stress>(m, "Stress")
         .def(py::init<Simulation_context&, Density&, Potential&, K_point_set&>())
         .def("calc_stress_total", &Stress::calc_stress_total, py::return_value_policy::reference_internal)
+        .def("calc_stress_and_forces_total", &Stress::calc_stress_and_forces_total,
+             py::return_value_policy::reference_internal)
         .def("calc_stress_har", &Stress::calc_stress_har, py::return_value_policy::reference_internal)
         .def("calc_stress_ewald", &Stress::calc_stress_ewald, py::return_value_policy::reference_internal)
         .def("calc_stress_xc", &Stress::calc_stress_xc, py::return_value_policy::reference_internal)
@@ -579,7 +603,8 @@ PYBIND11_MODULE(py_sirius, m)
 
     py::class_<Force>(m, "Force")
         .def(py::init<Simulation_context&, Density&, Potential&, K_point_set&>())
-        .def("calc_forces_total", &Force::calc_forces_total, py::return_value_policy::reference_internal)
+        .def("calc_forces_total", py::overload_cast<>(&Force::calc_forces_total),
+             py::return_value_policy::reference_internal)
         .def_property_readonly("ewald", &Force::forces_ewald)
         .def_property_readonly("hubbard", &Force::forces_hubbard)
         .def_property_readonly("vloc", &Force::forces_vloc)
@@ -604,12 +629,14 @@ PYBIND11_MODULE(py_sirius, m)
     //    .def_property_readonly("local_size", &FFT3D::local_size)
     //    ;
 
-    py::class_<matrix_storage_slab<complex_double>>(m, "MatrixStorageSlabC")
+    py::class_<matrix_storage_slab<complex_double>>(m, "MatrixStorageSlabC", py::buffer_protocol())
+        .def_buffer([](matrix_storage_slab<complex_double>& ms) { return mdarray_buffer_info(ms.prime()); })
         .def("is_remapped", &matrix_storage_slab<complex_double>::is_remapped)
         .def("prime", py::overload_cast<>(&matrix_storage_slab<complex_double>::prime),
              py::return_value_policy::reference_internal);
 
-    py::class_<mdarray<complex_double, 1>>(m, "mdarray1c")
+    py::class_<mdarray<complex_double, 1>>(m, "mdarray1c", py::buffer_protocol())
+        .def_buffer([](mdarray<complex_double, 1>& arr) { return mdarray_buffer_info(arr); })
         .def("on_device", &mdarray<complex_double, 1>::on_device)
         .def("copy_to_host", [](mdarray<complex_double, 1>& mdarray) { mdarray.copy_to(memory_t::host); })
         .def("__array__", [](py::object& obj) {
@@ -620,7 +647,8 @@ PYBIND11_MODULE(py_sirius, m)
                                                                arr.at(memory_t::host), obj);
                           });
 
-    py::class_<mdarray<double, 1>>(m, "mdarray1r")
+    py::class_<mdarray<double, 1>>(m, "mdarray1r", py::buffer_protocol())
+        .def_buffer([](mdarray<double, 1>& arr) { return mdarray_buffer_info(arr); })
         .def("on_device", &mdarray<double, 1>::on_device)
         .def("copy_to_host", [](mdarray<double, 1>& mdarray) { mdarray.copy_to(memory_t::host); })
         .def("__array__", [](py::object& obj) {
@@ -631,7 +659,8 @@ PYBIND11_MODULE(py_sirius, m)
                                                                arr.at(memory_t::host), obj);
                           });
 
-    py::class_<mdarray<complex_double, 2>>(m, "mdarray2c")
+    py::class_<mdarray<complex_double, 2>>(m, "mdarray2c", py::buffer_protocol())
+        .def_buffer([](mdarray<complex_double, 2>& arr) { return mdarray_buffer_info(arr); })
         .def("on_device", &mdarray<complex_double, 2>::on_device)
         .def("copy_to_host", [](mdarray<complex_double, 2>& mdarray) { mdarray.copy_to(memory_t::host); })
         .def("__array__", [](py::object& obj) {
@@ -645,7 +674,8 @@ PYBIND11_MODULE(py_sirius, m)
 
     py::class_<dmatrix<complex_double>, mdarray<complex_double, 2>>(m, "dmatrix");
 
-    py::class_<mdarray<double, 2>>(m, "mdarray2")
+    py::class_<mdarray<double, 2>>(m, "mdarray2", py::buffer_protocol())
+        .def_buffer([](mdarray<double, 2>& arr) { return mdarray_buffer_info(arr); })
         .def("on_device", &mdarray<double, 2>::on_device)
         .def("copy_to_host", [](mdarray<double, 2>& mdarray) { mdarray.copy_to(memory_t::host, 0, mdarray.size(1)); })
         .def("__array__", [](py::object& obj) {
@@ -759,6 +789,9 @@ PYBIND11_MODULE(py_sirius, m)
     m.def("sprint_magnetization", &sprint_magnetization);
     m.def("apply_hamiltonian", &apply_hamiltonian, "Hamiltonian0"_a, "kpoint"_a, "wf_out"_a,
           "wf_in"_a, py::arg("swf_out") = nullptr);
+    m.def("apply_h_s", &apply_h_s, "Hamiltonian0"_a, "kpoint"_a, "psi"_a, py::arg("hpsi") = nullptr,
+          py::arg("spsi") = nullptr, py::arg("N") = 0, py::arg("n") = -1,
+          "Apply H and/or S to the bands [N, N + n) of psi in place of the output wave-functions.");
     m.def("initialize_subspace", &initialize_subspace);
 }
 
@@ -768,44 +801,64 @@ void apply_hamiltonian(Hamiltonian0& H0, K_point& kp, Wave_functions& wf_out, Wa
     /////////////////////////////////////////////////////////////
     // // TODO: Hubbard needs manual call to copy to device // //
     /////////////////////////////////////////////////////////////
-    int num_wf = wf.num_wf();
-    int num_sc = wf.num_sc();
-    if (num_wf != wf_out.num_wf() || wf_out.num_sc() != num_sc) {
+    if (wf.num_wf() != wf_out.num_wf() || wf_out.num_sc() != wf.num_sc()) {
         throw std::runtime_error("Hamiltonian::apply_ref (python bindings): num_sc or num_wf do not match");
     }
+    /* wf_out is owned by the caller; wrap it without taking the ownership */
+    std::shared_ptr<Wave_functions> hwf(&wf_out, [](Wave_functions*) {});
+    /* apply H to all wave functions */
+    apply_h_s(H0, kp, wf, hwf, swf, 0, wf.num_wf());
+}
+
+/// Apply H and/or S to a block of bands without any intermediate copy of the wave-functions.
+/** The output wave-functions are provided by the caller and can be reused between the calls; their plane-wave
+ *  coefficients are accessible from Python as zero-copy numpy views. */
+void apply_h_s(Hamiltonian0& H0, K_point& kp, Wave_functions& psi, std::shared_ptr<Wave_functions>& hpsi,
+               std::shared_ptr<Wave_functions>& spsi, int N, int n)
+{
+    if (n < 0) {
+        n = psi.num_wf() - N;
+    }
+    for (auto wf : {hpsi.get(), spsi.get()}) {
+        if (wf && (wf->num_wf() < N + n || wf->num_sc() != psi.num_sc())) {
+            throw std::runtime_error("apply_h_s (python bindings): num_sc or num_wf do not match");
+        }
+    }
     auto H    = H0(kp);
     auto& ctx = H0.ctx();
 #ifdef __GPU
     if (is_device_memory(ctx.preferred_memory_t())) {
         auto& mpd = ctx.mem_pool(memory_t::device);
-        for (int ispn = 0; ispn < num_sc; ++ispn) {
-            wf_out.pw_coeffs(ispn).allocate(mpd);
-            wf.pw_coeffs(ispn).allocate(mpd);
-            wf.pw_coeffs(ispn).copy_to(memory_t::device, 0, num_wf);
+        for (int ispn = 0; ispn < psi.num_sc(); ++ispn) {
+            for (auto wf : {hpsi.get(), spsi.get()}) {
+                if (wf && !wf->pw_coeffs(ispn).prime().on_device()) {
+                    wf->pw_coeffs(ispn).allocate(mpd);
+                }
+            }
+            if (!psi.pw_coeffs(ispn).prime().on_device()) {
+                psi.pw_coeffs(ispn).allocate(mpd);
+            }
+            psi.pw_coeffs(ispn).copy_to(memory_t::device, N, n);
         }
     }
 #endif
-    /* apply H to all wave functions */
-    int N = 0;
-    int n = num_wf;
     for (int ispn_step = 0; ispn_step < ctx.num_spin_dims(); ispn_step++) {
-        // sping_range: 2 for non-colinear magnetism, otherwise ispn_step
         auto spin_range = sddk::spin_range((ctx.num_mag_dims() == 3) ? 2 : ispn_step);
-        H.apply_h_s<complex_double>(spin_range, N, n, wf, &wf_out, swf.get());
+        H.apply_h_s<complex_double>(spin_range, N, n, psi, hpsi.get(), spsi.get());
     }
 #ifdef __GPU
     if (is_device_memory(ctx.preferred_memory_t())) {
-        for (int ispn = 0; ispn < num_sc; ++ispn) {
-            wf_out.pw_coeffs(ispn).copy_to(memory_t::host, 0, n);
-            if (swf) {
-                swf->pw_coeffs(ispn).copy_to(memory_t::host, 0, n);
+        for (int ispn = 0; ispn < psi.num_sc(); ++ispn) {
+            for (auto wf : {hpsi.get(), spsi.get()}) {
+                if (wf) {
+                    wf->pw_coeffs(ispn).copy_to(memory_t::host, N, n);
+                }
             }
         }
     }
 #endif // __GPU
 }
 
-
 void initialize_subspace(DFT_ground_state& dft_gs, Simulation_context& ctx)
 {
     auto& kset = dft_gs.k_point_set();
@@ -105,6 +105,22 @@ class ApplyHamiltonian:
         assert not isinstance(potential, ApplyHamiltonian)
         self.potential = potential
         self.kpointset = kpointset
+        # wave-functions workspace (input, output) per k-point, reused between the calls
+        self._workspace = {}
+
+    def _get_workspace(self, k, num_wf):
+        """
+        Return (Psi_x, Psi_y) for the k-point k with at least num_wf bands.
+        """
+        ws = self._workspace.get(k, None)
+        if ws is None or ws[0].num_wf() < num_wf:
+            ctx = self.kpointset.ctx()
+            kpoint = self.kpointset[k]
+            ws = tuple(Wave_functions(kpoint.gkvec_partition(), num_wf,
+                                      ctx.preferred_memory_t(), ctx.num_spins())
+                       for _ in range(2))
+            self._workspace[k] = ws
+        return ws
 
     def apply(self, cn, scale=True, ki=None, ispn=None):
         """
@@ -112,10 +128,8 @@ class ApplyHamiltonian:
         cn -- input coefficient array
         """
         from ..coefficient_array import PwCoeffs
-        from ..py_sirius import apply_hamiltonian
+        from ..py_sirius import apply_h_s
 
-        ctx = self.kpointset.ctx()
-        num_sc = ctx.num_spins()
         H0 = Hamiltonian0(self.potential)
         if isinstance(cn, PwCoeffs):
             assert (ki is None)
@@ -125,27 +139,21 @@ class ApplyHamiltonian:
                 kpoint = self.kpointset[k]
                 # spins might have different number of bands ...
                 num_wf = max(ispn_coeffs, key=lambda x: x[1].shape[1])[1].shape[1]
-                Psi_x = Wave_functions(kpoint.gkvec_partition(), num_wf,
-                                       ctx.preferred_memory_t(),
-                                       num_sc)
-                Psi_y = Wave_functions(kpoint.gkvec_partition(), num_wf,
-                                       ctx.preferred_memory_t(),
-                                       num_sc)
+                Psi_x, Psi_y = self._get_workspace(k, num_wf)
+                # pw_coeffs are zero-copy views of the wave-functions
                 for i, val in ispn_coeffs:
                     Psi_x.pw_coeffs(i)[:, :val.shape[1]] = val
-                apply_hamiltonian(H0, kpoint, Psi_y, Psi_x)
+                apply_h_s(H0, kpoint, Psi_x, hpsi=Psi_y, N=0, n=num_wf)
 
                 w = kpoint.weight()
-                # copy coefficients from Psi_y
+                # copy coefficients from Psi_y (the workspace is overwritten by the next call)
                 for i, _ in ispn_coeffs:
                     num_wf = cn[(k, i)].shape[1]
                     if scale:
                         bnd_occ = np.array(kpoint.band_occupancy(i))
-                        out[(k, i)] = np.array(
-                            Psi_y.pw_coeffs(i), copy=False)[:, :num_wf] * bnd_occ * w
+                        out[(k, i)] = Psi_y.pw_coeffs(i)[:, :num_wf] * (bnd_occ * w)
                     else:
-                        out[(k, i)] = np.array(
-                            Psi_y.pw_coeffs(i), copy=False)[:, :num_wf]
+                        out[(k, i)] = np.array(Psi_y.pw_coeffs(i)[:, :num_wf])
             return out
 
     def __matmul__(self, cn):
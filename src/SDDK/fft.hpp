@@ -25,9 +25,15 @@
 #ifndef __FFT_HPP__
 #define __FFT_HPP__
 
+#include <array>
+#include <list>
+#include <mutex>
+#include <vector>
+#include <cstring>
 #include "splindex.hpp"
 #include "mpi/communicator.hpp"
 #include "spfft/spfft.hpp"
+#include "utils/profiler.hpp"
 
 using double_complex = std::complex<double>;
 
@@ -178,6 +184,120 @@ inline sddk::splindex<sddk::splindex_t::block> split_fft_z(int size_z__, sddk::C
     return sddk::splindex<sddk::splindex_t::block>(size_z__, comm_fft__.size(), comm_fft__.rank());
 }
 
+/// Cache of the SpFFT transforms created from a single SpFFT grid.
+/** Transforms are keyed by the processing unit, the type of the transform, the dimensions of the FFT box, the local
+ *  size of the z-dimension and the list of local G-vector index triplets. K-points with the same set of G+k vectors
+ *  (e.g. the same k-point of a re-created k-point set or a k-point with the same G-vector sphere) share a single
+ *  transform. The number of cached transforms is limited; the least recently used transform is dropped from the
+ *  cache and destroyed as soon as it is not referenced by any k-point.
+ *
+ *  The creation of a transform is a collective operation on the FFT communicator, therefore the decision to reuse
+ *  a cached transform is taken by all ranks of the communicator together. */
+class spfft_transform_cache
+{
+  private:
+    struct entry
+    {
+        SpfftProcessingUnitType pu;
+        SpfftTransformType type;
+        std::array<int, 4> dims;
+        std::vector<int> indices;
+        std::shared_ptr<spfft::Transform> transform;
+    };
+    /// List of cached transforms; the most recently used is at the front.
+    std::list<entry> entries_;
+    /// Maximum number of cached transforms.
+    size_t max_size_{0};
+    /// Number of transforms which were reused.
+    int num_hits_{0};
+    /// Number of transforms which were created.
+    int num_misses_{0};
+    std::mutex mutex_;
+
+  public:
+    spfft_transform_cache(size_t max_size__ = 64)
+        : max_size_(max_size__)
+    {
+    }
+
+    /// Get a cached transform or create a new one.
+    /** Arguments follow the spfft::Grid::create_transform() call. */
+    std::shared_ptr<spfft::Transform> get(spfft::Grid& grid__, SpfftProcessingUnitType pu__,
+                                          SpfftTransformType type__, int dim_x__, int dim_y__, int dim_z__,
+                                          int local_z_length__, int num_local_elements__, int const* indices__,
+                                          sddk::Communicator const& comm_fft__)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        std::array<int, 4> dims = {dim_x__, dim_y__, dim_z__, local_z_length__};
+        size_t n = static_cast<size_t>(num_local_elements__) * 3;
+
+        auto it = entries_.begin();
+        for (; it != entries_.end(); it++) {
+            if (it->pu == pu__ && it->type == type__ && it->dims == dims && it->indices.size() == n &&
+                std::memcmp(it->indices.data(), indices__, n * sizeof(int)) == 0) {
+                break;
+            }
+        }
+
+        /* all ranks of the FFT communicator must agree on the reuse */
+        int found = (it != entries_.end()) ? 1 : 0;
+        comm_fft__.allreduce<int, sddk::mpi_op_t::min>(&found, 1);
+
+        if (found) {
+            num_hits_++;
+            /* move to the front */
+            entries_.splice(entries_.begin(), entries_, it);
+            return entries_.front().transform;
+        }
+        if (it != entries_.end()) {
+            entries_.erase(it);
+        }
+
+        PROFILE("sirius::spfft_transform_cache|create");
+
+        num_misses_++;
+        auto transform = std::make_shared<spfft::Transform>(grid__.create_transform(pu__, type__, dim_x__, dim_y__,
+            dim_z__, local_z_length__, num_local_elements__, SPFFT_INDEX_TRIPLETS, indices__));
+
+        if (max_size_) {
+            entries_.push_front(entry{pu__, type__, dims, std::vector<int>(indices__, indices__ + n), transform});
+            while (entries_.size() > max_size_) {
+                entries_.pop_back();
+            }
+        }
+        return transform;
+    }
+
+    /// Number of transforms in the cache.
+    inline int size() const
+    {
+        return static_cast<int>(entries_.size());
+    }
+
+    /// Number of requests served from the cache.
+    inline int num_hits() const
+    {
+        return num_hits_;
+    }
+
+    /// Number of newly created transforms.
+    inline int num_misses() const
+    {
+        return num_misses_;
+    }
+
+    /// Size of the memory (in bytes) taken by the keys of the cached transforms.
+    inline size_t index_memory() const
+    {
+        size_t s{0};
+        for (auto& e : entries_) {
+            s += e.indices.size() * sizeof(int);
+        }
+        return s;
+    }
+};
+
 #endif // __FFT3D_H__
 
 /** \page ft_pw Fourier transform and plane wave normalization
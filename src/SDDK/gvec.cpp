@@ -27,20 +27,6 @@
 
 namespace sddk {
 
-vector3d<int> sddk::Gvec::gvec_by_full_index(uint32_t idx__) const
-{
-    /* index of the z coordinate of G-vector: first 12 bits */
-    uint32_t j = idx__ & 0xFFF;
-    /* index of z-column: last 20 bits */
-    uint32_t i = idx__ >> 12;
-    assert(i < (uint32_t)z_columns_.size());
-    assert(j < (uint32_t)z_columns_[i].z.size());
-    int x = z_columns_[i].x;
-    int y = z_columns_[i].y;
-    int z = z_columns_[i].z[j];
-    return vector3d<int>(x, y, z);
-}
-
 void sddk::Gvec::find_z_columns(double Gmax__, const FFT3D_grid& fft_box__)
 {
     mdarray<int, 2> non_zero_columns(fft_box__.limits(0), fft_box__.limits(1));
@@ -71,7 +57,12 @@ void sddk::Gvec::find_z_columns(double Gmax__, const FFT3D_grid& fft_box__)
 
         /* add column to the list */
         if (zcol.size() && !non_zero_columns(i, j)) {
-            z_columns_.push_back(z_column_descriptor(i, j, zcol));
+            auto zminmax = std::minmax_element(zcol.begin(), zcol.end());
+            z_columns_.push_back({i, j, *zminmax.first, *zminmax.second});
+            /* sphere is convex, so the z-coordinates must form a continuous range */
+            if (z_columns_.back().size() != static_cast<int>(zcol.size())) {
+                throw std::runtime_error("[sddk::Gvec] z-column is not continuous");
+            }
             num_gvec_ += static_cast<int>(zcol.size());
 
             non_zero_columns(i, j) = 1;
@@ -115,7 +106,7 @@ void sddk::Gvec::find_z_columns(double Gmax__, const FFT3D_grid& fft_box__)
     /* sort z-columns starting from the second or skip num_zcol of base distribution */
     int n = (gvec_base_) ? gvec_base_->num_zcol() : 1;
     std::sort(z_columns_.begin() + n, z_columns_.end(),
-              [](z_column_descriptor const& a, z_column_descriptor const& b) { return a.z.size() > b.z.size(); });
+              [](z_column_range const& a, z_column_range const& b) { return a.size() > b.size(); });
 }
 
 void Gvec::distribute_z_columns()
@@ -123,7 +114,7 @@ void Gvec::distribute_z_columns()
     gvec_distr_ = block_data_descriptor(comm().size());
     zcol_distr_ = block_data_descriptor(comm().size());
     /* local number of z-columns for each rank */
-    std::vector<std::vector<z_column_descriptor>> zcols_local(comm().size());
+    std::vector<std::vector<z_column_range>> zcols_local(comm().size());
 
     /* use already existing distribution of base G-vector set */
     if (gvec_base_) {
@@ -135,33 +126,36 @@ void Gvec::distribute_z_columns()
                 /* count local number of z-columns */
                 zcol_distr_.counts[rank] += 1;
                 /* count local number of G-vectors */
-                gvec_distr_.counts[rank] += static_cast<int>(z_columns_[icol].z.size());
+                gvec_distr_.counts[rank] += z_columns_[icol].size();
             }
         }
     }
 
     int n = (gvec_base_) ? gvec_base_->num_zcol() : 0;
 
-    std::vector<int> ranks;
+    /* min-heap of {number of G-vectors, rank} pairs for the ranks which didn't get a column in this round */
+    std::vector<std::pair<int, int>> ranks;
+    auto cmp = std::greater<std::pair<int, int>>();
     for (int i = n; i < static_cast<int>(z_columns_.size()); i++) {
-        /* initialize the list of ranks to 0,1,2,... */
+        /* start new round with all ranks */
         if (ranks.empty()) {
-            ranks.resize(comm().size());
-            std::iota(ranks.begin(), ranks.end(), 0);
+            for (int r = 0; r < comm().size(); r++) {
+                ranks.push_back(std::make_pair(gvec_distr_.counts[r], r));
+            }
+            std::make_heap(ranks.begin(), ranks.end(), cmp);
         }
-        /* find rank with minimum number of G-vectors */
-        auto rank_with_min_gvec = std::min_element(ranks.begin(), ranks.end(), [this](const int& a, const int& b) {
-            return gvec_distr_.counts[a] < gvec_distr_.counts[b];
-        });
+        /* find rank with minimum number of G-vectors; lower rank wins a tie */
+        std::pop_heap(ranks.begin(), ranks.end(), cmp);
+        int rank_with_min_gvec = ranks.back().second;
+        /* exclude this rank from the search */
+        ranks.pop_back();
 
         /* assign column to the found rank */
-        zcols_local[*rank_with_min_gvec].push_back(z_columns_[i]);
+        zcols_local[rank_with_min_gvec].push_back(z_columns_[i]);
         /* count local number of z-columns */
-        zcol_distr_.counts[*rank_with_min_gvec] += 1;
+        zcol_distr_.counts[rank_with_min_gvec] += 1;
         /* count local number of G-vectors */
-        gvec_distr_.counts[*rank_with_min_gvec] += static_cast<int>(z_columns_[i].z.size());
-        /* exclude this rank from the search */
-        ranks.erase(rank_with_min_gvec);
+        gvec_distr_.counts[rank_with_min_gvec] += z_columns_[i].size();
     }
     gvec_distr_.calc_offsets();
     zcol_distr_.calc_offsets();
@@ -192,98 +186,83 @@ void Gvec::find_gvec_shells()
 
     auto lat_sym = sirius::find_lat_sym(lattice_vectors_, 1e-6);
 
-    num_gvec_shells_ = 0;
-    gvec_shell_      = mdarray<int, 1>(num_gvec_);
-
-    std::fill(&gvec_shell_[0], &gvec_shell_[0] + num_gvec_, -1);
-
-    /* find G-vector shells using symmetry consideration */
-    for (int ig = 0; ig < num_gvec_; ig++) {
-        if (gvec_shell_[ig] == -1) {
-            auto G = gvec(ig);
-            for (size_t isym = 0; isym < lat_sym.size(); isym++) {
-                auto R   = lat_sym[isym];
-                auto G1  = R * G;
-                auto ig1 = index_by_gvec(G1);
-                if (ig1 == -1) {
-                    auto G1 = R * (G * (-1));
-                    ig1     = index_by_gvec(G1);
-                }
-                if (ig1 >= 0) {
-                    gvec_shell_[ig1] = num_gvec_shells_;
-                }
-            }
-            num_gvec_shells_++;
-        }
-    }
-    for (int ig = 0; ig < num_gvec_; ig++) {
-        if (gvec_shell_[ig] == -1) {
-            throw std::runtime_error("[sddk::Gvec] wrong G-vector shell");
-        }
-    }
-
-    gvec_shell_len_ = mdarray<double, 1>(num_gvec_shells_);
-    std::fill(&gvec_shell_len_[0], &gvec_shell_len_[0] + num_gvec_shells_, -1);
+    /* rounded length of each local G-vector */
+    std::vector<uint64_t> len_loc(count());
 
-    for (int ig = 0; ig < num_gvec_; ig++) {
-        auto g   = gvec_cart<index_domain_t::global>(ig).length();
-        int igsh = gvec_shell_[ig];
-        if (gvec_shell_len_[igsh] < 0) {
-            gvec_shell_len_[igsh] = g;
-        } else {
+    /* G-vectors of the same shell transform to each other under lattice symmetry operations; take the length of
+       the G-vector with the smallest global index among the images, so that all G-vectors of a shell get exactly
+       the same length independently of their distribution */
+    for (int igloc = 0; igloc < count(); igloc++) {
+        int ig    = offset() + igloc;
+        auto G    = gvec(ig);
+        double g  = gvec_cart<index_domain_t::local>(igloc).length();
+        int ig_min{ig};
+        for (size_t isym = 0; isym < lat_sym.size(); isym++) {
+            auto R   = lat_sym[isym];
+            auto G1  = R * G;
+            auto ig1 = index_by_gvec(G1);
+            if (ig1 == -1) {
+                G1  = R * (G * (-1));
+                ig1 = index_by_gvec(G1);
+            }
+            if (ig1 == -1) {
+                throw std::runtime_error("[sddk::Gvec] wrong G-vector shell");
+            }
+            double g1 = gvec_cart<index_domain_t::global>(ig1).length();
             /* lattice symmetries were found with 1e-6 tolererance for the metric tensor,
                so tolerance on length should be square root of that */
-            if (std::abs(gvec_shell_len_[igsh] - g) > 1e-3) {
+            if (std::abs(g1 - g) > 1e-3) {
                 std::stringstream s;
                 s << "[sddk::Gvec] wrong G-vector length\n"
-                  << "  length of G-shell : " << gvec_shell_len_[igsh] << "\n"
-                  << "  length of current G-vector: " << g << "\n"
+                  << "  length of G-vector : " << g << "\n"
+                  << "  length of rotated G-vector: " << g1 << "\n"
                   << "  index of G-vector: " << ig << "\n"
-                  << "  index of G-shell: " << igsh << "\n"
-                  << "  length difference: " << std::abs(gvec_shell_len_[igsh] - g);
+                  << "  index of rotated G-vector: " << ig1 << "\n"
+                  << "  length difference: " << std::abs(g1 - g);
                 throw std::runtime_error(s.str());
             }
+            ig_min = std::min(ig_min, ig1);
         }
-    }
-
-    // TODO: maybe, make an average G-shell length.
-
-    /* list of pairs (length, index of G-vector) */
-    std::vector<std::pair<uint64_t, int>> tmp(num_gvec_);
+        /* make some reasonable roundoff; round to the nearest integer, otherwise equal lengths can be truncated
+           into two different shells */
+        double len_min = gvec_cart<index_domain_t::global>(ig_min).length();
+        len_loc[igloc] = static_cast<uint64_t>(std::llround(len_min * 1e10));
+    }
+
+    /* unique local lengths */
+    std::vector<uint64_t> len_uniq(len_loc);
+    std::sort(len_uniq.begin(), len_uniq.end());
+    len_uniq.erase(std::unique(len_uniq.begin(), len_uniq.end()), len_uniq.end());
+
+    /* collect unique lengths from all ranks; their number is much smaller than the number of G-vectors */
+    block_data_descriptor d(comm().size());
+    d.counts[comm().rank()] = static_cast<int>(len_uniq.size());
+    comm().allreduce(d.counts.data(), comm().size());
+    d.calc_offsets();
+    std::vector<uint64_t> len_all(d.size());
+    std::copy(len_uniq.begin(), len_uniq.end(), len_all.begin() + d.offsets[comm().rank()]);
+    comm().allgather(len_all.data(), d.counts.data(), d.offsets.data());
+    std::sort(len_all.begin(), len_all.end());
+    len_all.erase(std::unique(len_all.begin(), len_all.end()), len_all.end());
+
+    num_gvec_shells_ = static_cast<int>(len_all.size());
+    gvec_shell_len_  = mdarray<double, 1>(num_gvec_shells_);
+    for (int igsh = 0; igsh < num_gvec_shells_; igsh++) {
+        gvec_shell_len_[igsh] = static_cast<double>(len_all[igsh]) * 1e-10;
+    }
+
+    /* index of G-shell is the position of the G-vector length in the sorted list; only local G-vectors are kept */
+    gvec_shell_ = mdarray<int, 1>(count());
     #pragma omp parallel for schedule(static)
-    for (int ig = 0; ig < num_gvec(); ig++) {
-        /* make some reasonable roundoff */
-        uint64_t len = static_cast<uint64_t>(gvec_shell_len_[gvec_shell_[ig]] * 1e10);
-        tmp[ig]      = std::make_pair(len, ig);
-    }
-    /* sort by first element in pair (length) */
-    std::sort(tmp.begin(), tmp.end());
-
-    /* index of the first shell */
-    gvec_shell_(tmp[0].second) = 0;
-    num_gvec_shells_           = 1;
-    /* temporary vector to store G-shell radius */
-    std::vector<double> tmp_len;
-    /* radius of the first shell */
-    tmp_len.push_back(static_cast<double>(tmp[0].first) * 1e-10);
-    for (int ig = 1; ig < num_gvec_; ig++) {
-        /* if this G-vector has a different length */
-        if (tmp[ig].first != tmp[ig - 1].first) {
-            /* increment number of shells */
-            num_gvec_shells_++;
-            /* save the radius of the new shell */
-            tmp_len.push_back(static_cast<double>(tmp[ig].first) * 1e-10);
-        }
-        /* assign the index of the current shell */
-        gvec_shell_(tmp[ig].second) = num_gvec_shells_ - 1;
+    for (int igloc = 0; igloc < count(); igloc++) {
+        gvec_shell_[igloc] = static_cast<int>(
+            std::lower_bound(len_all.begin(), len_all.end(), len_loc[igloc]) - len_all.begin());
     }
-    gvec_shell_len_ = mdarray<double, 1>(num_gvec_shells_);
-    std::copy(tmp_len.begin(), tmp_len.end(), gvec_shell_len_.at(memory_t::host));
 
     /* map from global index of G-shell to a list of local G-vectors */
     std::map<int, std::vector<int>> gshmap;
     for (int igloc = 0; igloc < this->count(); igloc++) {
-        int igsh = this->shell(this->offset() + igloc);
+        int igsh = gvec_shell_[igloc];
         if (gshmap.count(igsh) == 0) {
             gshmap[igsh] = std::vector<int>();
         }
@@ -303,6 +282,34 @@ void Gvec::find_gvec_shells()
     }
 }
 
+int Gvec::find_shell_by_len(double len__) const
+{
+    /* G-vectors of the same shell have the same length, so the nearest shell radius is taken */
+    auto beg = gvec_shell_len_.at(memory_t::host);
+    auto end = beg + num_gvec_shells_;
+    auto it  = std::lower_bound(beg, end, len__);
+    if (it == end || (it != beg && std::abs(*(it - 1) - len__) < std::abs(*it - len__))) {
+        it--;
+    }
+    if (std::abs(*it - len__) > 1e-3) {
+        std::stringstream s;
+        s << "[sddk::Gvec] G-vector shell is not found for the length " << len__;
+        throw std::runtime_error(s.str());
+    }
+    return static_cast<int>(it - beg);
+}
+
+void Gvec::init_gvec_shell_local()
+{
+    if (!bare_gvec_) {
+        return;
+    }
+    gvec_shell_ = mdarray<int, 1>(count());
+    for (int igloc = 0; igloc < count(); igloc++) {
+        gvec_shell_[igloc] = find_shell_by_len(gvec_cart<index_domain_t::global>(offset() + igloc).length());
+    }
+}
+
 void Gvec::init_gvec_cart()
 {
     gvec_cart_  = mdarray<double, 2>(3, count());
@@ -310,7 +317,7 @@ void Gvec::init_gvec_cart()
 
     for (int igloc = 0; igloc < count(); igloc++) {
         int ig   = offset() + igloc;
-        auto G   = gvec_by_full_index(gvec_full_index_(ig));
+        auto G   = gvec(ig);
         auto gc  = lattice_vectors_ * vector3d<double>(G[0], G[1], G[2]);
         auto gkc = lattice_vectors_ * (vector3d<double>(G[0], G[1], G[2]) + vk_);
         for (int x : {0, 1, 2}) {
@@ -333,22 +340,23 @@ void Gvec::init(FFT3D_grid const& fft_grid)
     std::fill(gvec_index_by_xy_.at(memory_t::host), gvec_index_by_xy_.at(memory_t::host) + gvec_index_by_xy_.size(),
               -1);
 
-    /* build the full G-vector index and reverse mapping */
-    gvec_full_index_ = mdarray<uint32_t, 1>(num_gvec_);
+    /* build the starting G-vector index of z-columns and reverse mapping */
+    zcol_gvec_offset_ = std::vector<int>(z_columns_.size());
     int ig{0};
     for (size_t i = 0; i < z_columns_.size(); i++) {
+        zcol_gvec_offset_[i] = ig;
         /* starting G-vector index for a z-stick */
         gvec_index_by_xy_(0, z_columns_[i].x, z_columns_[i].y) = ig;
         /* pack size of a z-stick and column index in one number */
-        gvec_index_by_xy_(1, z_columns_[i].x, z_columns_[i].y) = static_cast<int>((z_columns_[i].z.size() << 20) + i);
-        for (size_t j = 0; j < z_columns_[i].z.size(); j++) {
-            gvec_full_index_[ig++] = static_cast<uint32_t>((i << 12) + j);
-        }
+        gvec_index_by_xy_(1, z_columns_[i].x, z_columns_[i].y) = static_cast<int>((z_columns_[i].size() << 20) + i);
+        ig += z_columns_[i].size();
     }
     if (ig != num_gvec_) {
         throw std::runtime_error("wrong G-vector count");
     }
-    for (int ig = 0; ig < num_gvec_; ig++) {
+    /* check the local G-vectors */
+    for (int igloc = 0; igloc < count(); igloc++) {
+        int ig = offset() + igloc;
         auto gv = gvec(ig);
         if (index_by_gvec(gv) != ig) {
             std::stringstream s;
@@ -358,7 +366,7 @@ void Gvec::init(FFT3D_grid const& fft_grid)
     }
 
     /* first G-vector must be (0, 0, 0); never reomove this check!!! */
-    auto g0 = gvec_by_full_index(gvec_full_index_(0));
+    auto g0 = gvec(0);
     if (g0[0] || g0[1] || g0[2]) {
         throw std::runtime_error("first G-vector is not zero");
     }
@@ -405,7 +413,7 @@ Gvec& Gvec::operator=(Gvec&& src__)
         reduce_gvec_       = src__.reduce_gvec_;
         bare_gvec_         = src__.bare_gvec_;
         num_gvec_          = src__.num_gvec_;
-        gvec_full_index_   = std::move(src__.gvec_full_index_);
+        zcol_gvec_offset_  = std::move(src__.zcol_gvec_offset_);
         gvec_shell_        = std::move(src__.gvec_shell_);
         num_gvec_shells_   = std::move(src__.num_gvec_shells_);
         gvec_shell_len_    = std::move(src__.gvec_shell_len_);
@@ -468,7 +476,7 @@ int Gvec::index_by_gvec(vector3d<int> const& G__) const
        subtract first z-coordinate in column from the current z-coordinate of G-vector: in case #1 or #3 this
        already gives a proper offset, in case #2 storage of FFT frequencies must be taken into account
     */
-    int z0 = G__[2] - z_columns_[icol].z[0];
+    int z0 = G__[2] - z_columns_[icol].z_first();
     /* calculate proper offset */
     int offs = (z0 >= 0) ? z0 : z0 + col_size;
     /* full index */
@@ -486,8 +494,7 @@ void Gvec::pack(serializer& s__) const
     serialize(s__, bare_gvec_);
     serialize(s__, num_gvec_);
     serialize(s__, num_gvec_shells_);
-    serialize(s__, gvec_full_index_);
-    serialize(s__, gvec_shell_);
+    serialize(s__, zcol_gvec_offset_);
     serialize(s__, gvec_shell_len_);
     serialize(s__, gvec_index_by_xy_);
     serialize(s__, z_columns_);
@@ -505,14 +512,15 @@ void Gvec::unpack(serializer& s__, Gvec& gv__) const
     deserialize(s__, gv__.bare_gvec_);
     deserialize(s__, gv__.num_gvec_);
     deserialize(s__, gv__.num_gvec_shells_);
-    deserialize(s__, gv__.gvec_full_index_);
-    deserialize(s__, gv__.gvec_shell_);
+    deserialize(s__, gv__.zcol_gvec_offset_);
     deserialize(s__, gv__.gvec_shell_len_);
     deserialize(s__, gv__.gvec_index_by_xy_);
     deserialize(s__, gv__.z_columns_);
     deserialize(s__, gv__.gvec_distr_);
     deserialize(s__, gv__.zcol_distr_);
     deserialize(s__, gv__.gvec_base_mapping_);
+    /* shell index is stored for the local G-vectors only and depends on the rank of the receiver */
+    gv__.init_gvec_shell_local();
 }
 
 void Gvec::send_recv(Communicator const& comm__, int source__, int dest__, Gvec& gv__) const
@@ -560,7 +568,7 @@ void Gvec_partition::calc_offsets()
             /* global index of z-column */
             int icol         = idx_zcol_[zcol_distr_fft_.offsets[rank] + i];
             zcol_offs_[icol] = offs;
-            offs += static_cast<int>(gvec().zcol(icol).z.size());
+            offs += gvec().zcol_size(icol);
         }
         assert(offs == gvec_distr_fft_.counts[rank]);
     }
@@ -650,6 +658,73 @@ mdarray<int, 2> Gvec_partition::get_gvec() const
     return gv;
 }
 
+std::shared_ptr<remap_plan const> Gvec_partition::get_remap_plan(int num_cols__) const
+{
+    std::lock_guard<std::mutex> lock(remap_plans_mutex_);
+
+    for (auto it = remap_plans_.begin(); it != remap_plans_.end(); it++) {
+        if ((*it)->num_cols == num_cols__) {
+            /* move the plan to the front of the list */
+            remap_plans_.splice(remap_plans_.begin(), remap_plans_, it);
+            return remap_plans_.front();
+        }
+    }
+
+    PROFILE("sddk::Gvec_partition::get_remap_plan");
+
+    auto& comm_col  = comm_ortho_fft();
+    auto& row_distr = gvec_fft_slab();
+    int rank        = comm_col.rank();
+
+    remap_plan p;
+    p.num_cols    = num_cols__;
+    p.spl_num_col = splindex<splindex_t::block>(num_cols__, comm_col.size(), rank);
+
+    /* maximum local number of columns */
+    int nmax     = splindex_base<int>::block_size(num_cols__, comm_col.size());
+    p.chunk_size = remap_plan::get_chunk_size(num_cols__, comm_col.size());
+    if (p.chunk_size) {
+        p.num_chunks = (nmax + p.chunk_size - 1) / p.chunk_size;
+    }
+
+    /* local number of columns in chunk c on a given rank */
+    auto ncol = [&](int c, int r) {
+        return std::max(0, std::min(p.chunk_size, p.spl_num_col.local_size(r) - c * p.chunk_size));
+    };
+
+    for (int c = 0; c < p.num_chunks; c++) {
+        alltoall_descriptor fwd, bwd;
+        for (auto v : {&fwd.sendcounts, &fwd.sdispls, &fwd.recvcounts, &fwd.rdispls, &bwd.sendcounts, &bwd.sdispls,
+                       &bwd.recvcounts, &bwd.rdispls}) {
+            v->resize(comm_col.size());
+        }
+        int nc = ncol(c, rank);
+        for (int j = 0; j < comm_col.size(); j++) {
+            int ncj = ncol(c, j);
+            /* send the local rows of the j-th rank columns of this chunk */
+            fwd.sendcounts[j] = ncj * row_distr.counts[rank];
+            fwd.sdispls[j]    = (p.spl_num_col.global_offset(j) + c * p.chunk_size) * row_distr.counts[rank];
+            /* receive the rows of j-th rank for the local columns of this chunk */
+            fwd.recvcounts[j] = nc * row_distr.counts[j];
+            fwd.rdispls[j]    = nc * row_distr.offsets[j];
+            /* backward exchange is the exact reverse of the forward */
+            bwd.sendcounts[j] = fwd.recvcounts[j];
+            bwd.sdispls[j]    = fwd.rdispls[j];
+            bwd.recvcounts[j] = fwd.sendcounts[j];
+            bwd.rdispls[j]    = fwd.sdispls[j];
+        }
+        p.forward.push_back(fwd);
+        p.backward.push_back(bwd);
+        p.chunk_ncol.push_back(nc);
+    }
+
+    remap_plans_.push_front(std::make_shared<remap_plan const>(std::move(p)));
+    if (remap_plans_.size() > max_remap_plans_) {
+        remap_plans_.pop_back();
+    }
+    return remap_plans_.front();
+}
+
 void Gvec_partition::gather_pw_fft(std::complex<double>* f_pw_local__, std::complex<double>* f_pw_fft__) const
 {
     int rank = gvec().comm().rank();
@@ -692,18 +767,8 @@ Gvec_shells::Gvec_shells(Gvec const& gvec__)
     if (a2a_send.size() != gvec_.count()) {
         throw std::runtime_error("wrong number of G-vectors");
     }
-    /* count the number of elements to receive */
-    for (int r = 0; r < comm_.size(); r++) {
-        for (int igloc = 0; igloc < gvec_.gvec_count(r); igloc++) {
-            /* index of G-vector in the original distribution */
-            int ig = gvec_.gvec_offset(r) + igloc;
-            /* index of the G-vector shell */
-            int igsh = gvec_.shell(ig);
-            if (spl_num_gsh.local_rank(igsh) == comm_.rank()) {
-                a2a_recv.counts[r]++;
-            }
-        }
-    }
+    /* get the number of elements to receive from each rank */
+    comm_.alltoall(a2a_send.counts.data(), 1, a2a_recv.counts.data(), 1);
     a2a_recv.calc_offsets();
     /* sanity check: sum of local sizes in the remapped order is equal to the total number of G-vectors */
     int ng = gvec_count_remapped();
@@ -712,23 +777,41 @@ Gvec_shells::Gvec_shells(Gvec const& gvec__)
         throw std::runtime_error("wrong number of G-vectors");
     }
 
+    /* send local G-vectors together with their shell index to the ranks which store the shell */
+    std::vector<int> send_buf(4 * gvec_.count());
+    std::vector<int> counts(comm_.size(), 0);
+    for (int igloc = 0; igloc < gvec_.count(); igloc++) {
+        int ig   = gvec_.offset() + igloc;
+        int igsh = gvec_.shell(ig);
+        int r    = spl_num_gsh.local_rank(igsh);
+        auto G   = gvec_.gvec(ig);
+        int i    = a2a_send.offsets[r] + counts[r];
+        for (int x : {0, 1, 2}) {
+            send_buf[4 * i + x] = G[x];
+        }
+        send_buf[4 * i + 3] = igsh;
+        counts[r]++;
+    }
+    std::vector<int> recv_buf(4 * gvec_count_remapped());
+    block_data_descriptor send4(comm_.size());
+    block_data_descriptor recv4(comm_.size());
+    for (int r = 0; r < comm_.size(); r++) {
+        send4.counts[r] = 4 * a2a_send.counts[r];
+        recv4.counts[r] = 4 * a2a_recv.counts[r];
+    }
+    send4.calc_offsets();
+    recv4.calc_offsets();
+    comm_.alltoall(send_buf.data(), send4.counts.data(), send4.offsets.data(), recv_buf.data(), recv4.counts.data(),
+                   recv4.offsets.data());
+
     /* local set of G-vectors in the remapped order */
     gvec_remapped_       = mdarray<int, 2>(3, gvec_count_remapped());
     gvec_shell_remapped_ = mdarray<int, 1>(gvec_count_remapped());
-    std::vector<int> counts(comm_.size(), 0);
-    for (int r = 0; r < comm_.size(); r++) {
-        for (int igloc = 0; igloc < gvec_.gvec_count(r); igloc++) {
-            int ig   = gvec_.gvec_offset(r) + igloc;
-            int igsh = gvec_.shell(ig);
-            auto G   = gvec_.gvec(ig);
-            if (spl_num_gsh.local_rank(igsh) == comm_.rank()) {
-                for (int x : {0, 1, 2}) {
-                    gvec_remapped_(x, a2a_recv.offsets[r] + counts[r]) = G[x];
-                }
-                gvec_shell_remapped_(a2a_recv.offsets[r] + counts[r]) = igsh;
-                counts[r]++;
-            }
+    for (int ig = 0; ig < gvec_count_remapped(); ig++) {
+        for (int x : {0, 1, 2}) {
+            gvec_remapped_(x, ig) = recv_buf[4 * ig + x];
         }
+        gvec_shell_remapped_(ig) = recv_buf[4 * ig + 3];
     }
     for (int ig = 0; ig < gvec_count_remapped(); ig++) {
         idx_gvec[gvec_remapped(ig)] = ig;
@@ -26,7 +26,11 @@
 #define __GVEC_HPP__
 
 #include <numeric>
+#include <algorithm>
 #include <map>
+#include <list>
+#include <memory>
+#include <mutex>
 #include <iostream>
 #include <type_traits>
 #include <assert.h>
@@ -69,6 +73,37 @@ struct z_column_descriptor
     }
 };
 
+/// Compact descriptor of the z-column which is stored by the Gvec class.
+/** G-vectors inside a sphere form a continuous range of z-coordinates [z_min, z_max] for a given x and y. The
+ *  z-coordinates are ordered as FFT frequencies: first the non-negative and then the negative ones. */
+struct z_column_range
+{
+    /// X-coordinate (can be negative and positive).
+    int x;
+    /// Y-coordinate (can be negative and positive).
+    int y;
+    /// Smallest z-coordinate of the column.
+    int z_min;
+    /// Largest z-coordinate of the column.
+    int z_max;
+    /// Number of G-vectors in the column.
+    inline int size() const
+    {
+        return z_max - z_min + 1;
+    }
+    /// Z-coordinate of the first G-vector in the column.
+    inline int z_first() const
+    {
+        return (z_min < 0 && z_max >= 0) ? 0 : z_min;
+    }
+    /// Z-coordinate of the j-th G-vector in the column.
+    inline int z(int j__) const
+    {
+        int z = z_first() + j__;
+        return (z > z_max) ? z - size() : z;
+    }
+};
+
 /// Serialize a single z-column descriptor.
 inline void serialize(serializer& s__, z_column_descriptor const& zcol__)
 {
@@ -108,7 +143,13 @@ inline void deserialize(serializer& s__, std::vector<z_column_descriptor>& zcol_
 /// A set of G-vectors for FFTs and G+k basis functions.
 /** Current implemntation supports up to 2^12 (4096) z-dimension of the FFT grid and 2^20 (1048576) number of
  *  z-columns. The order of z-sticks and G-vectors is not fixed and depends on the number of MPI ranks used
- *  for the parallelization. */
+ *  for the parallelization.
+ *
+ *  Only the data per z-column (and not per G-vector) is replicated between MPI ranks. A G-vector is found from
+ *  its global index by a binary search over the starting indices of z-columns and the index of a G-vector is
+ *  found from the replicated {x, y} -> z-column map. The size of this directory is O(N^{2/3}) in the number of
+ *  G-vectors, so no distributed directory and no communication is needed for index_by_gvec(). The G-shell
+ *  index is stored only for the local G-vectors; the shell of a remote G-vector is found by its length. */
 class Gvec
 {
   private:
@@ -133,17 +174,11 @@ class Gvec
     /// Total number of G-vectors.
     int num_gvec_{0};
 
-    /// Mapping between G-vector index [0:num_gvec_) and a full index.
-    /** Full index is used to store x,y,z coordinates in a packed form in a single integer number.
-     *  The index is equal to ((i << 12) + j) where i is the global index of z_column and j is the
-     *  index of G-vector z-coordinate in the column i. This is a global array: each MPI rank stores exactly the
-     *  same copy of the gvec_full_index_.
-     *
-     *  Limitations: size of z-dimension of FFT grid: 4096, number of z-columns: 1048576
-     */
-    mdarray<uint32_t, 1> gvec_full_index_;
+    /// Global index of the first G-vector of each z-column.
+    std::vector<int> zcol_gvec_offset_;
 
-    /// Index of the shell to which the given G-vector belongs.
+    /// Index of the shell to which the given local G-vector belongs.
+    /** Only the local fraction of G-vectors is stored; shell of a remote G-vector is found by its length. */
     mdarray<int, 1> gvec_shell_;
 
     /// Number of G-vector shells (groups of G-vectors with the same length).
@@ -164,10 +199,12 @@ class Gvec
     /// Mapping between local index of G-vector and local  G-shell index.
     std::vector<int> gvec_shell_idx_local_;
 
+    /// Starting G-vector index, size and index of the z-column for each {x, y} pair.
+    /** Limitations: size of z-dimension of FFT grid: 4096, number of z-columns: 1048576 */
     mdarray<int, 3> gvec_index_by_xy_;
 
     /// Global list of non-zero z-columns.
-    std::vector<z_column_descriptor> z_columns_;
+    std::vector<z_column_range> z_columns_;
 
     /// Fine-grained distribution of G-vectors.
     block_data_descriptor gvec_distr_;
@@ -205,25 +242,31 @@ class Gvec
     /* copy assignment operator is forbidden */
     Gvec& operator=(Gvec const& src__) = delete;
 
-    /// Return corresponding G-vector for an index in the range [0, num_gvec).
-    vector3d<int> gvec_by_full_index(uint32_t idx__) const;
-
     /// Find z-columns of G-vectors inside a sphere with Gmax radius.
     /** This function also computes the total number of G-vectors. */
     void find_z_columns(double Gmax__, FFT3D_grid const& fft_box__);
 
     /// Distribute z-columns between MPI ranks.
+    /** Columns are given out in rounds: in each round every rank receives one column and the ranks with the
+        smaller number of G-vectors are served first. The order of ranks in a round is taken from a binary heap. */
     void distribute_z_columns();
 
     /// Find a list of G-vector shells.
     /** G-vectors belonging to the same shell have the same length and transform to each other
-        under a lattice symmetry operation
+        under a lattice symmetry operation. Each rank works with its local set of G-vectors; the lengths of
+        G-shells and the global G-shell index are then collected from all ranks.
      */
     void find_gvec_shells();
 
     /// Compute the Cartesian coordinates.
     void init_gvec_cart();
 
+    /// Find the index of G-vector shell by the length of G-vector.
+    int find_shell_by_len(double len__) const;
+
+    /// Set the shell index of the local G-vectors using their lengths.
+    void init_gvec_shell_local();
+
     /// Initialize everything.
     void init(FFT3D_grid const& fft_grid);
 
@@ -412,13 +455,18 @@ class Gvec
     /// Return G vector in fractional coordinates.
     inline vector3d<int> gvec(int ig__) const
     {
-        return gvec_by_full_index(gvec_full_index_(ig__));
+        assert(ig__ >= 0 && ig__ < num_gvec());
+        /* last z-column which starts at or before ig */
+        int icol = static_cast<int>(std::upper_bound(zcol_gvec_offset_.begin(), zcol_gvec_offset_.end(), ig__) -
+                                    zcol_gvec_offset_.begin()) - 1;
+        auto& zcol = z_columns_[icol];
+        return vector3d<int>(zcol.x, zcol.y, zcol.z(ig__ - zcol_gvec_offset_[icol]));
     }
 
     /// Return G+k vector in fractional coordinates.
     inline vector3d<double> gkvec(int ig__) const
     {
-        auto G = gvec_by_full_index(gvec_full_index_(ig__));
+        auto G = gvec(ig__);
         return (vector3d<double>(G[0], G[1], G[2]) + vk_);
     }
 
@@ -434,7 +482,7 @@ class Gvec
     template <index_domain_t idx_t>
     inline std::enable_if_t<idx_t == index_domain_t::global, vector3d<double>> gvec_cart(int ig__) const
     {
-        auto G = gvec_by_full_index(gvec_full_index_(ig__));
+        auto G = gvec(ig__);
         return lattice_vectors_ * vector3d<double>(G[0], G[1], G[2]);
     }
 
@@ -449,14 +497,20 @@ class Gvec
     template <index_domain_t idx_t>
     inline std::enable_if_t<idx_t == index_domain_t::global, vector3d<double>> gkvec_cart(int ig__) const
     {
-        auto G = gvec_by_full_index(gvec_full_index_(ig__));
+        auto G = gvec(ig__);
         return lattice_vectors_ * (vector3d<double>(G[0], G[1], G[2]) + vk_);
     }
 
     /// Return index of the G-vector shell by the G-vector index.
+    /** For the G-vectors stored by other ranks the shell is looked up by the G-vector length; this is a binary
+     *  search and must not be used in the loops over remote G-vectors. */
     inline int shell(int ig__) const
     {
-        return gvec_shell_(ig__);
+        int igloc = ig__ - offset();
+        if (igloc >= 0 && igloc < count()) {
+            return gvec_shell_(igloc);
+        }
+        return find_shell_by_len(gvec_cart<index_domain_t::global>(ig__).length());
     }
 
     /// Return length of the G-vector shell.
@@ -478,7 +532,7 @@ class Gvec
     /// Return length of the G-vector.
     inline double gvec_len(int ig__) const
     {
-        return gvec_shell_len_(gvec_shell_(ig__));
+        return gvec_shell_len_(shell(ig__));
     }
 
     inline int index_g12(vector3d<int> const& g1__, vector3d<int> const& g2__) const
@@ -522,9 +576,21 @@ class Gvec
         return static_cast<int>(z_columns_.size());
     }
 
-    inline z_column_descriptor const& zcol(size_t idx__) const
+    /// Return the z-column descriptor with the explicit list of z-coordinates.
+    inline z_column_descriptor zcol(size_t idx__) const
+    {
+        auto& zcol = z_columns_[idx__];
+        std::vector<int> z(zcol.size());
+        for (int j = 0; j < zcol.size(); j++) {
+            z[j] = zcol.z(j);
+        }
+        return z_column_descriptor(zcol.x, zcol.y, z);
+    }
+
+    /// Return the number of G-vectors in a z-column.
+    inline int zcol_size(size_t idx__) const
     {
-        return z_columns_[idx__];
+        return z_columns_[idx__].size();
     }
 
     inline int gvec_base_mapping(int igloc_base__) const
@@ -578,7 +644,7 @@ class Gvec
 //        serialize(s, gv__.bare_gvec_);
 //        serialize(s, gv__.num_gvec_);
 //        serialize(s, gv__.num_gvec_shells_);
-//        serialize(s, gv__.gvec_full_index_);
+//        serialize(s, gv__.zcol_gvec_offset_);
 //        serialize(s, gv__.gvec_shell_);
 //        serialize(s, gv__.gvec_shell_len_);
 //        serialize(s, gv__.gvec_index_by_xy_);
@@ -598,7 +664,7 @@ class Gvec
 //        deserialize(s, gvout->bare_gvec_);
 //        deserialize(s, gvout->num_gvec_);
 //        deserialize(s, gvout->num_gvec_shells_);
-//        deserialize(s, gvout->gvec_full_index_);
+//        deserialize(s, gvout->zcol_gvec_offset_);
 //        deserialize(s, gvout->gvec_shell_);
 //        deserialize(s, gvout->gvec_shell_len_);
 //        deserialize(s, gvout->gvec_index_by_xy_);
@@ -611,6 +677,41 @@ class Gvec
 //    return std::move(gvout);
 //}
 
+/// Communication plan for the remapping of wave-functions between the slab and the FFT-friendly distributions.
+/** The columns of the matrix are split between the ranks of the communicator orthogonal to the FFT communicator
+ *  in blocks. The exchange is done in chunks of columns: chunk c contains the local columns
+ *  [c * chunk_size, (c + 1) * chunk_size) of each rank, so that unpacking of one chunk overlaps with the exchange
+ *  of the next one. The send (forward) or receive (backward) displacements are given with respect to the first
+ *  remapped column of the slab storage; the other displacements are given with respect to the start of the
+ *  chunk buffer. */
+struct remap_plan
+{
+    /// Number of columns to remap.
+    int num_cols{0};
+    /// Number of columns in a chunk.
+    int chunk_size{0};
+    /// Number of chunks.
+    int num_chunks{0};
+    /// Split of columns between ranks.
+    splindex<splindex_t::block> spl_num_col;
+    /// Forward (slab to FFT slab) exchange for each chunk.
+    std::vector<alltoall_descriptor> forward;
+    /// Backward (FFT slab to slab) exchange for each chunk.
+    std::vector<alltoall_descriptor> backward;
+    /// Local number of columns in each chunk.
+    std::vector<int> chunk_ncol;
+
+    /// Number of columns in a chunk for a given number of columns and size of the column communicator.
+    static int get_chunk_size(int num_cols__, int comm_size__)
+    {
+        /* maximum local number of columns */
+        int nmax = splindex_base<int>::block_size(num_cols__, comm_size__);
+        /* four chunks are enough to hide the unpacking of data behind the communication */
+        int nc = std::min(nmax, 4);
+        return nc ? (nmax + nc - 1) / nc : 0;
+    }
+};
+
 /// Stores information about G-vector partitioning between MPI ranks for the FFT transformation.
 /** FFT driver works with a small communicator. G-vectors are distributed over the entire communicator which is
     larger than the FFT communicator. In order to transform the functions, G-vectors must be redistributed to the
@@ -650,6 +751,17 @@ class Gvec_partition
     /// Global index of G-vector by local index inside fat-salb.
     mdarray<int, 1> idx_gvec_;
 
+    /// Maximum number of cached remapping plans.
+    static const size_t max_remap_plans_{8};
+
+    /// Cached remapping plans for different number of wave-functions; the most recently used plan is the first.
+    /** Only a few different numbers of wave-functions are remapped in practice (all bands and the blocks of the
+        iterative solver); the least recently used plan is dropped if the cache is full. */
+    mutable std::list<std::shared_ptr<remap_plan const>> remap_plans_;
+
+    /// Guard for the cache of remapping plans; the cache is modified by the const get_remap_plan().
+    mutable std::mutex remap_plans_mutex_;
+
     void build_fft_distr();
 
     /// Calculate offsets of z-columns inside each local buffer of PW coefficients.
@@ -719,6 +831,11 @@ class Gvec_partition
         return gvec_fft_slab_;
     }
 
+    /// Return the communication plan to remap a given number of wave-functions.
+    /** The plan is created on the first request and then reused while it stays in the cache. The plan is
+        shared, so it remains valid for the caller even if it is dropped from the cache. */
+    std::shared_ptr<remap_plan const> get_remap_plan(int num_cols__) const;
+
     inline int zcol_offs(int icol__) const
     {
         return zcol_offs_(icol__);
@@ -32,10 +32,8 @@ void matrix_storage<T, matrix_storage_t::slab>::set_num_extra(int n__, int idx0_
 {
     PROFILE("sddk::matrix_storage::set_num_extra");
 
-    auto& comm_col = gvp_->comm_ortho_fft();
-
     /* this is how n columns of the matrix will be distributed between columns of the MPI grid */
-    spl_num_col_ = splindex<splindex_t::block>(n__, comm_col.size(), comm_col.rank());
+    spl_num_col_ = splindex<splindex_t::block>(n__, gvp_->comm_ortho_fft().size(), gvp_->comm_ortho_fft().rank());
 
     T* ptr{nullptr};
     T* ptr_d{nullptr};
@@ -51,17 +49,21 @@ void matrix_storage<T, matrix_storage_t::slab>::set_num_extra(int n__, int idx0_
         }
     } else {
         /* maximum local number of matrix columns */
-        ncol = splindex_base<int>::block_size(n__, comm_col.size());
+        ncol = splindex_base<int>::block_size(n__, gvp_->comm_ortho_fft().size());
         /* upper limit for the size of swapped extra matrix */
         size_t sz = gvp_->gvec_count_fft() * ncol;
+        /* two chunks of columns are exchanged at the same time */
+        size_t sz1 = 2 * gvp_->gvec_count_fft() * remap_plan::get_chunk_size(n__, gvp_->comm_ortho_fft().size());
         /* reallocate buffers if necessary */
-        if (extra_buf_.size() < sz) {
+        if (extra_buf_.size() < sz || send_recv_buf_.size() < sz1) {
             PROFILE("sddk::matrix_storage::set_num_extra|alloc");
+            sz = std::max(sz, extra_buf_.size());
+            sz1 = std::max(sz1, send_recv_buf_.size());
             if (mp__) {
-                send_recv_buf_ = mdarray<T, 1>(sz, *mp__, "matrix_storage.send_recv_buf_");
+                send_recv_buf_ = mdarray<T, 1>(sz1, *mp__, "matrix_storage.send_recv_buf_");
                 extra_buf_     = mdarray<T, 1>(sz, *mp__, "matrix_storage.extra_buf_");
             } else {
-                send_recv_buf_ = mdarray<T, 1>(sz, memory_t::host, "matrix_storage.send_recv_buf_");
+                send_recv_buf_ = mdarray<T, 1>(sz1, memory_t::host, "matrix_storage.send_recv_buf_");
                 extra_buf_     = mdarray<T, 1>(sz, memory_t::host, "matrix_storage.extra_buf_");
             }
         }
@@ -180,38 +182,44 @@ void matrix_storage<T, matrix_storage_t::slab>::remap_backward(int n__, int idx0
 
     auto& row_distr = gvp_->gvec_fft_slab();
 
-    assert(n__ == spl_num_col_.global_index_size());
+    auto plan_ptr = gvp_->get_remap_plan(n__);
+    auto& plan    = *plan_ptr;
 
-    /* local number of columns */
-    int n_loc = spl_num_col_.local_size();
-
-    /* reorder sending blocks */
-    #pragma omp parallel for
-    for (int i = 0; i < n_loc; i++) {
-        for (int j = 0; j < comm_col.size(); j++) {
-            int offset = row_distr.offsets[j];
-            int count  = row_distr.counts[j];
-            if (count) {
-                std::memcpy(&send_recv_buf_[offset * n_loc + count * i], &extra_(offset, i), count * sizeof(T));
-            }
-        }
-    }
+    assert(n__ == spl_num_col_.global_index_size());
 
-    /* send and receive dimensions */
-    block_data_descriptor sd(comm_col.size()), rd(comm_col.size());
-    for (int j = 0; j < comm_col.size(); j++) {
-        sd.counts[j] = spl_num_col_.local_size(comm_col.rank()) * row_distr.counts[j];
-        rd.counts[j] = spl_num_col_.local_size(j) * row_distr.counts[comm_col.rank()];
-    }
-    sd.calc_offsets();
-    rd.calc_offsets();
+    /* size of the chunk buffer */
+    size_t sz = gvp_->gvec_count_fft() * plan.chunk_size;
 
     T* recv_buf = (num_rows_loc_ == 0) ? nullptr : prime_.at(memory_t::host, 0, idx0__);
 
-    {
+    MPI_Request req[2];
+
+    for (int c = 0; c < plan.num_chunks; c++) {
+        T* buf = send_recv_buf_.at(memory_t::host) + (c % 2) * sz;
+        int nc = plan.chunk_ncol[c];
+        /* reorder sending blocks of this chunk while the previous chunk is in flight */
+        #pragma omp parallel for
+        for (int i = 0; i < nc; i++) {
+            for (int j = 0; j < comm_col.size(); j++) {
+                int offset = row_distr.offsets[j];
+                int count  = row_distr.counts[j];
+                if (count) {
+                    std::memcpy(&buf[offset * nc + count * i], &extra_(offset, c * plan.chunk_size + i),
+                                count * sizeof(T));
+                }
+            }
+        }
+        auto& a2a = plan.backward[c];
+        comm_col.ialltoall(buf, a2a.sendcounts.data(), a2a.sdispls.data(), recv_buf, a2a.recvcounts.data(),
+                           a2a.rdispls.data(), &req[c % 2]);
+        if (c > 0) {
+            PROFILE("sddk::matrix_storage::remap_backward|mpi");
+            CALL_MPI(MPI_Wait, (&req[(c - 1) % 2], MPI_STATUS_IGNORE));
+        }
+    }
+    if (plan.num_chunks) {
         PROFILE("sddk::matrix_storage::remap_backward|mpi");
-        comm_col.alltoall(send_recv_buf_.at(memory_t::host), sd.counts.data(), sd.offsets.data(), recv_buf,
-                          rd.counts.data(), rd.offsets.data());
+        CALL_MPI(MPI_Wait, (&req[(plan.num_chunks - 1) % 2], MPI_STATUS_IGNORE));
     }
 
     /* move data back to device */
@@ -236,34 +244,48 @@ void matrix_storage<T, matrix_storage_t::slab>::remap_forward(int n__, int idx0_
 
     auto& comm_col = gvp_->comm_ortho_fft();
 
-    /* local number of columns */
-    int n_loc = spl_num_col_.local_size();
+    auto plan_ptr = gvp_->get_remap_plan(n__);
+    auto& plan    = *plan_ptr;
 
-    /* send and receive dimensions */
-    block_data_descriptor sd(comm_col.size()), rd(comm_col.size());
-    for (int j = 0; j < comm_col.size(); j++) {
-        sd.counts[j] = spl_num_col_.local_size(j) * row_distr.counts[comm_col.rank()];
-        rd.counts[j] = spl_num_col_.local_size(comm_col.rank()) * row_distr.counts[j];
-    }
-    sd.calc_offsets();
-    rd.calc_offsets();
+    /* size of the chunk buffer */
+    size_t sz = gvp_->gvec_count_fft() * plan.chunk_size;
 
     T* send_buf = (num_rows_loc_ == 0) ? nullptr : prime_.at(memory_t::host, 0, idx0__);
 
-    {
-        PROFILE("sddk::matrix_storage::remap_forward|mpi");
-        comm_col.alltoall(send_buf, sd.counts.data(), sd.offsets.data(), send_recv_buf_.at(memory_t::host),
-                          rd.counts.data(), rd.offsets.data());
+    MPI_Request req[2];
+
+    auto post = [&](int c) {
+        auto& a2a = plan.forward[c];
+        comm_col.ialltoall(send_buf, a2a.sendcounts.data(), a2a.sdispls.data(),
+                           send_recv_buf_.at(memory_t::host) + (c % 2) * sz, a2a.recvcounts.data(),
+                           a2a.rdispls.data(), &req[c % 2]);
+    };
+
+    if (plan.num_chunks) {
+        post(0);
     }
+    for (int c = 0; c < plan.num_chunks; c++) {
+        /* start the exchange of the next chunk */
+        if (c + 1 < plan.num_chunks) {
+            post(c + 1);
+        }
+        {
+            PROFILE("sddk::matrix_storage::remap_forward|mpi");
+            CALL_MPI(MPI_Wait, (&req[c % 2], MPI_STATUS_IGNORE));
+        }
 
-    /* reorder received blocks */
-    #pragma omp parallel for
-    for (int i = 0; i < n_loc; i++) {
-        for (int j = 0; j < comm_col.size(); j++) {
-            int offset = row_distr.offsets[j];
-            int count  = row_distr.counts[j];
-            if (count) {
-                std::memcpy(&extra_(offset, i), &send_recv_buf_[offset * n_loc + count * i], count * sizeof(T));
+        T const* buf = send_recv_buf_.at(memory_t::host) + (c % 2) * sz;
+        int nc = plan.chunk_ncol[c];
+        /* reorder received blocks */
+        #pragma omp parallel for
+        for (int i = 0; i < nc; i++) {
+            for (int j = 0; j < comm_col.size(); j++) {
+                int offset = row_distr.offsets[j];
+                int count  = row_distr.counts[j];
+                if (count) {
+                    std::memcpy(&extra_(offset, c * plan.chunk_size + i), &buf[offset * nc + count * i],
+                                count * sizeof(T));
+                }
             }
         }
     }
@@ -140,7 +140,9 @@ class matrix_storage<T, matrix_storage_t::slab>
     /** \param [in] n         Number of matrix columns to distribute.
      *  \param [in] idx0      Starting column of the matrix.
      *
-     *  Prime storage is expected on the CPU (for the MPI a2a communication). */
+     *  Prime storage is expected on the CPU (for the MPI a2a communication). The communication pattern is taken from
+     *  the cached remap plan of the G-vector partition; columns are exchanged in chunks with the non-blocking
+     *  all-to-all and the reordering of the received chunk overlaps with the exchange of the next one. */
     void remap_forward(int n__, int idx0__, memory_pool* mp__);
 
     /// Remap data from extra to prime storage.
@@ -1257,6 +1257,18 @@ class mdarray
         return *this;
     }
 
+    /// Attach host memory obtained from an external allocator.
+    /** The memory is released by the deleter of the unique pointer. Elements are not constructed, so only
+     *  trivial types (and complex numbers) are allowed. */
+    inline mdarray<T, N>& allocate(std::unique_ptr<T, memory_t_deleter_base>&& ptr__)
+    {
+        static_assert(std::is_trivial<T>::value || is_complex<T>::value, "wrong type of the external memory");
+
+        unique_ptr_ = std::move(ptr__);
+        raw_ptr_    = unique_ptr_.get();
+        return *this;
+    }
+
     /// Deallocate host or device memory.
     inline void deallocate(memory_t memory__)
     {
@@ -50,6 +50,15 @@ inline int omp_get_num_threads()
     return 1;
 }
 
+inline void omp_set_num_threads(int num_threads)
+{
+}
+
+inline int omp_in_parallel()
+{
+    return 0;
+}
+
 inline double omp_get_wtime()
 {
     return 0;
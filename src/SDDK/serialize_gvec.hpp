@@ -15,8 +15,7 @@ inline void serialize(serializer& s__, Gvec& gv__)
     serialize(s__, gv__.bare_gvec_);
     serialize(s__, gv__.num_gvec_);
     serialize(s__, gv__.num_gvec_shells_);
-    serialize(s__, gv__.gvec_full_index_);
-    serialize(s__, gv__.gvec_shell_);
+    serialize(s__, gv__.zcol_gvec_offset_);
     serialize(s__, gv__.gvec_shell_len_);
     serialize(s__, gv__.gvec_index_by_xy_);
     serialize(s__, gv__.z_columns_);
@@ -34,14 +33,15 @@ inline void deserialize(serializer& s__, Gvec& gv__)
     deserialize(s__, gv__.bare_gvec_);
     deserialize(s__, gv__.num_gvec_);
     deserialize(s__, gv__.num_gvec_shells_);
-    deserialize(s__, gv__.gvec_full_index_);
-    deserialize(s__, gv__.gvec_shell_);
+    deserialize(s__, gv__.zcol_gvec_offset_);
     deserialize(s__, gv__.gvec_shell_len_);
     deserialize(s__, gv__.gvec_index_by_xy_);
     deserialize(s__, gv__.z_columns_);
     deserialize(s__, gv__.gvec_distr_);
     deserialize(s__, gv__.zcol_distr_);
     deserialize(s__, gv__.gvec_base_mapping_);
+    /* shell index is stored for the local G-vectors only and depends on the rank of the receiver */
+    gv__.init_gvec_shell_local();
 }
 
 }
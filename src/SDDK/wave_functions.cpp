@@ -391,4 +391,33 @@ Wave_functions::sumsqr(device_t pu__, spin_range spins__, int n__) const
     return s;
 }
 
+void add_weighted_row_products(int num_rows__, int num_cols__, double_complex const* A__, int ld_a__,
+                               double_complex const* B__, int ld_b__, double const* w__, double* result__)
+{
+    /* 512 rows: 8 Kb of complex coefficients per column and 4 Kb of the result */
+    const int block_size = 512;
+
+    int num_blocks = utils::num_blocks(num_rows__, block_size);
+
+    #pragma omp parallel for schedule(static)
+    for (int ib = 0; ib < num_blocks; ib++) {
+        int r0 = ib * block_size;
+        int nr = std::min(block_size, num_rows__ - r0);
+        double* res = result__ + r0;
+        for (int i = 0; i < num_cols__; i++) {
+            double w = (w__) ? w__[i] : 1.0;
+            if (w == 0) {
+                continue;
+            }
+            /* complex numbers as pairs of real numbers */
+            auto a = reinterpret_cast<double const*>(A__ + static_cast<size_t>(ld_a__) * i + r0);
+            auto b = reinterpret_cast<double const*>(B__ + static_cast<size_t>(ld_b__) * i + r0);
+            #pragma omp simd
+            for (int j = 0; j < nr; j++) {
+                res[j] += w * (a[2 * j] * b[2 * j] + a[2 * j + 1] * b[2 * j + 1]);
+            }
+        }
+    }
+}
+
 } // namespace sddk
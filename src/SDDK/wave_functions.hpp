@@ -364,6 +364,19 @@ class Wave_functions
     void print_checksum(device_t pu__, std::string label__, int N__, int n__) const;
 };
 
+/// Accumulate the weighted sum of column products for each row of two column-major matrices.
+/** The following quantity is computed:
+ *  \f[
+ *      r_{j} \mathrel{+}= \sum_{i} w_{i} {\rm Re} \big( A_{ji} B_{ji}^{*} \big)
+ *  \f]
+ *  With A = B this is a weighted sum of squares of the matrix rows (e.g. the occupation-weighted
+ *  \f$ |\psi_{i}({\bf G})|^2 \f$ for each G-vector). The rows are split into blocks, each of which is owned by
+ *  a single thread. Inside a block the columns are streamed one after another, so the matrices are accessed
+ *  contiguously and the block of the result stays in the L1 cache. If w__ is a null pointer, all weights are equal
+ *  to one. */
+void add_weighted_row_products(int num_rows__, int num_cols__, double_complex const* A__, int ld_a__,
+                               double_complex const* B__, int ld_b__, double const* w__, double* result__);
+
 
 } // namespace sddk
 
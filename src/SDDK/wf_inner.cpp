@@ -163,7 +163,118 @@ inner(::spla::Context& spla_ctx__, int ispn__, Wave_functions& bra__, int i0__,
     }
 }
 
+template <typename T>
+void
+Inner_request<T>::wait()
+{
+    if (result_ == nullptr) {
+        return;
+    }
+    PROFILE("sddk::wf_inner|wait");
+    for (auto& req : req_) {
+        CALL_MPI(MPI_Wait, (&req, MPI_STATUS_IGNORE));
+    }
+    int m = static_cast<int>(buf_.size(0));
+    int n = static_cast<int>(buf_.size(1));
+    for (int j = 0; j < n; j++) {
+        std::copy(buf_.at(memory_t::host, 0, j), buf_.at(memory_t::host, 0, j) + m,
+                  result_->at(memory_t::host, irow0_, jcol0_ + j));
+    }
+    // make sure result is updated on device as well
+    if (result_->on_device()) {
+        result_->copy_to(memory_t::device);
+    }
+    req_.clear();
+    result_ = nullptr;
+}
+
+template <typename T>
+Inner_request<T>
+inner_begin(::spla::Context& spla_ctx__, int ispn__, Wave_functions& bra__, int i0__, int m__, Wave_functions& ket__,
+            int j0__, int n__, dmatrix<T>& result__, int irow0__, int jcol0__)
+{
+    /* the conditions are the same on all ranks of the wave-functions communicator */
+    bool split = result__.comm().size() == 1 && bra__.num_mt_coeffs() == 0 &&
+                 !is_device_memory(bra__.preferred_memory_t()) && !is_device_memory(ket__.preferred_memory_t());
+
+    /* Fallback: a distributed result matrix is filled by SPLA, which reduces the local products directly into
+     * the 2D block-cyclic layout; the split reduction is implemented only for a replicated result. Device and
+     * LAPW wave-functions also go through SPLA. In these cases the product is blocking and the returned
+     * request is already completed. */
+    if (!split || m__ == 0 || n__ == 0) {
+        inner(spla_ctx__, ispn__, bra__, i0__, m__, ket__, j0__, n__, result__, irow0__, jcol0__);
+        return Inner_request<T>();
+    }
+
+    PROFILE("sddk::wf_inner|begin");
+
+    T alpha = 1.0;
+    int size_factor = 1;
+    if (std::is_same<T, double>::value) {
+        alpha = 2.0;
+        size_factor = 2;
+    }
+
+    /* number of column blocks; reduction of the block is overlapped with the local product of the next one */
+    int num_blocks = std::min(n__, 4);
+    int block_size = n__ / num_blocks + std::min(1, n__ % num_blocks);
+    num_blocks = n__ / block_size + std::min(1, n__ % block_size);
+
+    mdarray<T, 2> buf(m__, n__, memory_t::host, "inner_begin::buf");
+    std::vector<MPI_Request> req(num_blocks);
+
+    auto spins = spin_range(ispn__);
+
+    // For gamma case, contribution of g = 0 vector must not be counted double -> multiply by 0.5
+    if (bra__.comm().rank() == 0) {
+        scale_gamma_wf<T>(ispn__, m__, i0__, 0.5, bra__);
+    }
+
+    for (int ib = 0; ib < num_blocks; ib++) {
+        int j0 = ib * block_size;
+        int nb = std::min(block_size, n__ - j0);
+        T beta = 0.0;
+        for (auto s : spins) {
+            int k = size_factor * bra__.pw_coeffs(s).num_rows_loc();
+            if (k == 0) {
+                continue;
+            }
+            linalg(linalg_t::blas).gemm('C', 'N', m__, nb, k, &alpha,
+                reinterpret_cast<T const*>(bra__.pw_coeffs(s).prime().at(memory_t::host, 0, i0__)),
+                size_factor * bra__.pw_coeffs(s).prime().ld(),
+                reinterpret_cast<T const*>(ket__.pw_coeffs(s).prime().at(memory_t::host, 0, j0__ + j0)),
+                size_factor * ket__.pw_coeffs(s).prime().ld(), &beta, buf.at(memory_t::host, 0, j0), m__);
+            beta = 1.0;
+        }
+        if (beta == T(0)) {
+            std::fill(buf.at(memory_t::host, 0, j0), buf.at(memory_t::host, 0, j0) + m__ * nb, 0);
+        }
+        bra__.comm().iallreduce(buf.at(memory_t::host, 0, j0), m__ * nb, &req[ib]);
+    }
+
+    // For gamma case, g = 0 vector is rescaled back
+    if (bra__.comm().rank() == 0) {
+        scale_gamma_wf<T>(ispn__, m__, i0__, 2.0, bra__);
+    }
+
+    return Inner_request<T>(result__, irow0__, jcol0__, std::move(buf), std::move(req));
+}
+
 // instantiate for required types
+template class Inner_request<double>;
+
+template class Inner_request<double_complex>;
+
+template Inner_request<double> inner_begin<double>(::spla::Context& ctx, int ispn__, Wave_functions& bra__,
+                                                   int i0__, int m__, Wave_functions& ket__, int j0__, int n__,
+                                                   dmatrix<double>& result__, int irow0__, int jcol0__);
+
+template Inner_request<double_complex> inner_begin<double_complex>(::spla::Context& ctx, int ispn__,
+                                                                   Wave_functions& bra__, int i0__, int m__,
+                                                                   Wave_functions& ket__, int j0__, int n__,
+                                                                   dmatrix<double_complex>& result__, int irow0__,
+                                                                   int jcol0__);
+
 template void inner<double>(::spla::Context& ctx, int ispn__, Wave_functions& bra__,
                             int i0__, int m__, Wave_functions& ket__, int j0__, int n__, dmatrix<double>& result__,
                             int irow0__, int jcol0__);
@@ -53,5 +53,84 @@ namespace sddk {
 template <typename T>
 void inner(::spla::Context& spla_ctx__, int ispn__, Wave_functions& bra__, int i0__, int m__,
            Wave_functions& ket__, int j0__, int n__, dmatrix<T>& result__, int irow0__, int jcol0__);
+
+/// Pending inner product between wave-functions.
+/** The object is returned by inner_begin(). It holds the local contribution to the inner product and the
+ *  requests of the non-blocking reduction. The result matrix is updated by wait(). */
+template <typename T>
+class Inner_request
+{
+  private:
+    /// Resulting matrix.
+    dmatrix<T>* result_{nullptr};
+    /// First row of the inner product sub-matrix.
+    int irow0_{0};
+    /// First column of the inner product sub-matrix.
+    int jcol0_{0};
+    /// Local contribution to the inner product; reduced in place.
+    mdarray<T, 2> buf_;
+    /// Requests of the reduction of column blocks.
+    std::vector<MPI_Request> req_;
+
+  public:
+    /// Create a completed request.
+    Inner_request()
+    {
+    }
+
+    /// Create a pending request.
+    Inner_request(dmatrix<T>& result__, int irow0__, int jcol0__, mdarray<T, 2>&& buf__, std::vector<MPI_Request>&& req__)
+        : result_(&result__)
+        , irow0_(irow0__)
+        , jcol0_(jcol0__)
+        , buf_(std::move(buf__))
+        , req_(std::move(req__))
+    {
+    }
+
+    Inner_request(Inner_request&& src__)
+        : result_(src__.result_)
+        , irow0_(src__.irow0_)
+        , jcol0_(src__.jcol0_)
+        , buf_(std::move(src__.buf_))
+        , req_(std::move(src__.req_))
+    {
+        src__.result_ = nullptr;
+    }
+
+    Inner_request& operator=(Inner_request&& src__)
+    {
+        if (this != &src__) {
+            wait();
+            result_ = src__.result_;
+            irow0_  = src__.irow0_;
+            jcol0_  = src__.jcol0_;
+            buf_    = std::move(src__.buf_);
+            req_    = std::move(src__.req_);
+            src__.result_ = nullptr;
+        }
+        return *this;
+    }
+
+    ~Inner_request()
+    {
+        wait();
+    }
+
+    /// Wait for the reduction to complete and store the result.
+    void wait();
+};
+
+/// Start the inner product between wave-functions.
+/** The arguments are the same as in inner(). If the result matrix is not distributed and the wave-functions
+ *  are plane-wave only and stored in the host memory, the local products of column blocks are computed one by
+ *  one and the reduction of each block is started right after its local product, so that the communication
+ *  overlaps with the computation of the next block. The returned request must be completed with wait() before
+ *  the result is used; several requests can be in flight at the same time. In all other cases the inner
+ *  product is computed immediately and a completed request is returned. */
+template <typename T>
+Inner_request<T> inner_begin(::spla::Context& spla_ctx__, int ispn__, Wave_functions& bra__, int i0__, int m__,
+                             Wave_functions& ket__, int j0__, int n__, dmatrix<T>& result__, int irow0__,
+                             int jcol0__);
 }
 #endif
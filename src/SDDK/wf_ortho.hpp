@@ -29,6 +29,10 @@
 namespace sddk {
 
 /// Orthogonalize n new wave-functions to the N old wave-functions
+/** Both inner products are used right after they are computed, so no independent work is overlapped with their
+ *  reduction. The only overlap is inside sddk::inner_begin(): the reduction of a column block runs while the local
+ *  product of the next block is computed, and the reduction of the last block is always waited for. This happens
+ *  only for a non-distributed matrix \p o and plane-wave wave-functions in the host memory. */
 template <typename T, int idx_bra__, int idx_ket__>
 void orthogonalize(::spla::Context& spla_ctx__,
                    memory_t                     mem__,
@@ -3230,6 +3230,165 @@ call sirius_get_wave_functions_aux(ks_handler_ptr,ik_ptr,ispn_ptr,npw_ptr,gvec_k
 &evc_ptr,ld1_ptr,ld2_ptr)
 end subroutine sirius_get_wave_functions
 
+!
+!> @brief Register host code buffer for the wave-functions of a k-point.
+!> @details
+!> The buffer is filled by sirius_fetch_wave_functions(). The list of G-vectors is copied and the mapping
+!> to the SIRIUS order of G+k vectors is computed once on the first fetch. Only the address of evc is stored:
+!> the actual argument must be a contiguous array with the TARGET attribute and must stay allocated until
+!> sirius_clear_wave_functions() is called. Registering the same k-point and spin index again replaces the
+!> previous buffer.
+!> @param [in] ks_handler K-point set handler.
+!> @param [in] ik Global index of k-point
+!> @param [in] ispn Spin index.
+!> @param [in] npw Local number of G+k vectors.
+!> @param [in] gvec_k List of G-vectors.
+!> @param [inout] evc Wave-functions buffer of [ld1, ld2, num_bands] dimensions.
+!> @param [in] ld1 Leading dimension of evc array.
+!> @param [in] ld2 Second dimension of evc array.
+subroutine sirius_register_wave_functions(ks_handler,ik,ispn,npw,gvec_k,evc,ld1,&
+&ld2)
+implicit none
+!
+type(C_PTR), target, intent(in) :: ks_handler
+integer, target, intent(in) :: ik
+integer, target, intent(in) :: ispn
+integer, target, intent(in) :: npw
+integer, target, dimension(3,npw), intent(in) :: gvec_k
+complex(8), target, dimension(*), intent(inout) :: evc
+integer, target, intent(in) :: ld1
+integer, target, intent(in) :: ld2
+!
+type(C_PTR) :: ks_handler_ptr
+type(C_PTR) :: ik_ptr
+type(C_PTR) :: ispn_ptr
+type(C_PTR) :: npw_ptr
+type(C_PTR) :: gvec_k_ptr
+type(C_PTR) :: evc_ptr
+type(C_PTR) :: ld1_ptr
+type(C_PTR) :: ld2_ptr
+!
+interface
+subroutine sirius_register_wave_functions_aux(ks_handler,ik,ispn,npw,gvec_k,evc,&
+&ld1,ld2)&
+&bind(C, name="sirius_register_wave_functions")
+use, intrinsic :: ISO_C_BINDING
+type(C_PTR), value :: ks_handler
+type(C_PTR), value :: ik
+type(C_PTR), value :: ispn
+type(C_PTR), value :: npw
+type(C_PTR), value :: gvec_k
+type(C_PTR), value :: evc
+type(C_PTR), value :: ld1
+type(C_PTR), value :: ld2
+end subroutine
+end interface
+!
+ks_handler_ptr = C_NULL_PTR
+ks_handler_ptr = C_LOC(ks_handler)
+ik_ptr = C_NULL_PTR
+ik_ptr = C_LOC(ik)
+ispn_ptr = C_NULL_PTR
+ispn_ptr = C_LOC(ispn)
+npw_ptr = C_NULL_PTR
+npw_ptr = C_LOC(npw)
+gvec_k_ptr = C_NULL_PTR
+gvec_k_ptr = C_LOC(gvec_k)
+evc_ptr = C_NULL_PTR
+evc_ptr = C_LOC(evc)
+ld1_ptr = C_NULL_PTR
+ld1_ptr = C_LOC(ld1)
+ld2_ptr = C_NULL_PTR
+ld2_ptr = C_LOC(ld2)
+call sirius_register_wave_functions_aux(ks_handler_ptr,ik_ptr,ispn_ptr,npw_ptr,gvec_k_ptr,&
+&evc_ptr,ld1_ptr,ld2_ptr)
+end subroutine sirius_register_wave_functions
+
+!
+!> @brief Remove all registered host code buffers of wave-functions.
+!> @param [in] ks_handler K-point set handler.
+subroutine sirius_clear_wave_functions(ks_handler)
+implicit none
+!
+type(C_PTR), target, intent(in) :: ks_handler
+!
+type(C_PTR) :: ks_handler_ptr
+!
+interface
+subroutine sirius_clear_wave_functions_aux(ks_handler)&
+&bind(C, name="sirius_clear_wave_functions")
+use, intrinsic :: ISO_C_BINDING
+type(C_PTR), value :: ks_handler
+end subroutine
+end interface
+!
+ks_handler_ptr = C_NULL_PTR
+ks_handler_ptr = C_LOC(ks_handler)
+call sirius_clear_wave_functions_aux(ks_handler_ptr)
+end subroutine sirius_clear_wave_functions
+
+!
+!> @brief Copy wave-functions of all registered k-points to the host code buffers.
+!> @details
+!> This is a collective operation. Each rank fills the buffers it has registered with
+!> sirius_register_wave_functions(); ranks of the same band communicator must register the same k-points in the
+!> same order.
+!> @param [in] ks_handler K-point set handler.
+subroutine sirius_fetch_wave_functions(ks_handler)
+implicit none
+!
+type(C_PTR), target, intent(in) :: ks_handler
+!
+type(C_PTR) :: ks_handler_ptr
+!
+interface
+subroutine sirius_fetch_wave_functions_aux(ks_handler)&
+&bind(C, name="sirius_fetch_wave_functions")
+use, intrinsic :: ISO_C_BINDING
+type(C_PTR), value :: ks_handler
+end subroutine
+end interface
+!
+ks_handler_ptr = C_NULL_PTR
+ks_handler_ptr = C_LOC(ks_handler)
+call sirius_fetch_wave_functions_aux(ks_handler_ptr)
+end subroutine sirius_fetch_wave_functions
+
+!
+!> @brief Get band energies of all k-points and spins.
+!> @param [in] ks_handler K-point set handler.
+!> @param [out] band_energies Array of band energies of [ld, num_spin_dims, num_kpoints] dimensions.
+!> @param [in] ld Leading dimension of band_energies array.
+subroutine sirius_get_band_energies_all(ks_handler,band_energies,ld)
+implicit none
+!
+type(C_PTR), target, intent(in) :: ks_handler
+real(8), target, intent(out) :: band_energies
+integer, target, intent(in) :: ld
+!
+type(C_PTR) :: ks_handler_ptr
+type(C_PTR) :: band_energies_ptr
+type(C_PTR) :: ld_ptr
+!
+interface
+subroutine sirius_get_band_energies_all_aux(ks_handler,band_energies,ld)&
+&bind(C, name="sirius_get_band_energies_all")
+use, intrinsic :: ISO_C_BINDING
+type(C_PTR), value :: ks_handler
+type(C_PTR), value :: band_energies
+type(C_PTR), value :: ld
+end subroutine
+end interface
+!
+ks_handler_ptr = C_NULL_PTR
+ks_handler_ptr = C_LOC(ks_handler)
+band_energies_ptr = C_NULL_PTR
+band_energies_ptr = C_LOC(band_energies)
+ld_ptr = C_NULL_PTR
+ld_ptr = C_LOC(ld)
+call sirius_get_band_energies_all_aux(ks_handler_ptr,band_energies_ptr,ld_ptr)
+end subroutine sirius_get_band_energies_all
+
 !
 !> @brief Set occupation matrix for LDA+U.
 !> @param [in] handler Ground state handler.
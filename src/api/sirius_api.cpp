@@ -123,6 +123,78 @@ sirius::K_point_set& get_ks(void* const* h)
     return static_cast<utils::any_ptr*>(*h)->get<sirius::K_point_set>();
 }
 
+/// Host code buffer for the wave-functions of a single k-point and spin.
+/** The buffer is registered once by the host code; the G-vector mapping and the exchange plan between the ranks
+ *  of the band communicator are computed on the first transfer and reused afterwards. */
+struct host_wf_buffer
+{
+    /// Global index of k-point.
+    int ik;
+    /// Spin index.
+    int ispn;
+    /// Local number of host code G+k vectors.
+    int npw;
+    /// Host code G-vectors in lattice coordinates.
+    std::vector<int> gvec_k;
+    /// Host code wave-functions array of [ld1, ld2, num_bands] dimensions.
+    std::complex<double>* evc;
+    int ld1;
+    int ld2;
+    /// G+k vectors of the k-point.
+    std::unique_ptr<sirius::Gvec> gkvec;
+    /// Counts and offsets of G-vectors sent to each rank of the band communicator.
+    sddk::block_data_descriptor send_gvec;
+    /// Local index of the sent G-vectors.
+    std::vector<int> send_idx;
+    /// Counts and offsets of G-vectors received from each rank of the band communicator.
+    sddk::block_data_descriptor recv_gvec;
+    /// Host index of the received G-vectors; negative value means the coefficient of -G is conjugated.
+    std::vector<int> recv_idx;
+};
+
+/// Registered host code wave-function buffers for each k-point set handler.
+static std::map<void*, std::vector<std::unique_ptr<host_wf_buffer>>> host_wf_buffers;
+
+/// Map host code G+k vectors to the global index of G+k vectors of SIRIUS.
+/** Negative index means that the coefficient of -G has to be conjugated; vectors that are not found are marked
+ *  with std::numeric_limits<int>::max(). */
+static std::vector<int> host_gvec_mapping(sirius::K_point_set& kset__, sirius::Gvec const& gkvec__, int npw__,
+                                          int const* gvec_k__)
+{
+    std::vector<int> igm(npw__, std::numeric_limits<int>::max());
+
+    mdarray<int, 2> gvec_k(const_cast<int*>(gvec_k__), 3, npw__);
+
+    for (int ig = 0; ig < npw__; ig++) {
+        /* G vector of host code */
+        auto gvc = kset__.ctx().unit_cell().reciprocal_lattice_vectors() *
+                   (vector3d<double>(gvec_k(0, ig), gvec_k(1, ig), gvec_k(2, ig)) + gkvec__.vk());
+        if (gvc.length() > kset__.ctx().gk_cutoff()) {
+            continue;
+        }
+        int ig1 = gkvec__.index_by_gvec({gvec_k(0, ig), gvec_k(1, ig), gvec_k(2, ig)});
+        /* vector is out of bounds */
+        if (ig1 >= gkvec__.num_gvec()) {
+            continue;
+        }
+        /* index of G was not found */
+        if (ig1 < 0) {
+            /* try -G */
+            ig1 = gkvec__.index_by_gvec({-gvec_k(0, ig), -gvec_k(1, ig), -gvec_k(2, ig)});
+            /* index of -G was not found */
+            if (ig1 < 0) {
+                continue;
+            } else {
+                /* this will tell co conjugate PW coefficients as we take them from -G index */
+                igm[ig] = -ig1;
+            }
+        } else {
+            igm[ig] = ig1;
+        }
+    }
+    return igm;
+}
+
 /// Index of Rlm in QE in the block of lm coefficients for a given l.
 static inline int idx_m_qe(int m__)
 {
@@ -1006,6 +1078,7 @@ void sirius_free_handler(void** handler__, int* error_code__)
     call_sirius([&]()
     {
         if (*handler__ != nullptr) {
+            host_wf_buffers.erase(*handler__);
             delete static_cast<utils::any_ptr*>(*handler__);
         }
         *handler__ = nullptr;
@@ -3073,10 +3146,13 @@ void sirius_get_q_operator(void*          const* handler__,
 
     int idx = utils::packed_index(xi1, xi2);
 
+    auto q_pw_loc = sim_ctx.augmentation_op(type.id())->q_pw_block(0, sim_ctx.gvec().count(),
+                                                                     sim_ctx.mem_pool(memory_t::host));
+
     std::vector<double_complex> q_pw(sim_ctx.gvec().num_gvec());
     for (int ig = 0; ig < sim_ctx.gvec().count(); ig++) {
-        double x = sim_ctx.augmentation_op(type.id())->q_pw(idx, 2 * ig);
-        double y = sim_ctx.augmentation_op(type.id())->q_pw(idx, 2 * ig + 1);
+        double x = q_pw_loc(idx, 2 * ig);
+        double y = q_pw_loc(idx, 2 * ig + 1);
         q_pw[sim_ctx.gvec().offset() + ig] = double_complex(x, y) * static_cast<double>(p1 * p2);
     }
     sim_ctx.comm().allgather(q_pw.data(), sim_ctx.gvec().offset(), sim_ctx.gvec().count());
@@ -3189,42 +3265,6 @@ void sirius_get_wave_functions(void*          const* ks_handler__,
 
     std::vector<int> igmap;
 
-    auto gvec_mapping = [&](Gvec const& gkvec)
-    {
-        std::vector<int> igm(*npw__, std::numeric_limits<int>::max());
-
-        mdarray<int, 2> gvec_k(gvec_k__, 3, *npw__);
-
-        for (int ig = 0; ig < *npw__; ig++) {
-            /* G vector of host code */
-            auto gvc = kset.ctx().unit_cell().reciprocal_lattice_vectors() *
-                       (vector3d<double>(gvec_k(0, ig), gvec_k(1, ig), gvec_k(2, ig)) + gkvec.vk());
-            if (gvc.length() > kset.ctx().gk_cutoff()) {
-                continue;
-            }
-            int ig1 = gkvec.index_by_gvec({gvec_k(0, ig), gvec_k(1, ig), gvec_k(2, ig)});
-            /* vector is out of bounds */
-            if (ig1 >= gkvec.num_gvec()) {
-                continue;
-            }
-            /* index of G was not found */
-            if (ig1 < 0) {
-                /* try -G */
-                ig1 = gkvec.index_by_gvec({-gvec_k(0, ig), -gvec_k(1, ig), -gvec_k(2, ig)});
-                /* index of -G was not found */
-                if (ig1 < 0) {
-                    continue;
-                } else {
-                    /* this will tell co conjugate PW coefficients as we take them from -G index */
-                    igm[ig] = -ig1;
-                }
-            } else {
-                igm[ig] = ig1;
-            }
-        }
-        return igm;
-    };
-
     auto store_wf = [&](std::vector<double_complex>& wf_tmp, int i, int s, mdarray<double_complex, 3>& evc)
     {
         int ispn = s;
@@ -3258,7 +3298,7 @@ void sirius_get_wave_functions(void*          const* ks_handler__,
 
                 /* build G-vector mapping */
                 if (my_rank == r) {
-                    igmap = gvec_mapping(gkvec);
+                    igmap = host_gvec_mapping(kset, gkvec, *npw__, gvec_k__);
                 }
 
                 /* target array of wave-functions */
@@ -3344,6 +3384,354 @@ void sirius_get_wave_functions(void*          const* ks_handler__,
     }
 }
 
+/*
+@api begin
+sirius_register_wave_functions:
+  doc: Register host code buffer for the wave-functions of a k-point.
+  full_doc: ['The buffer is filled by sirius_fetch_wave_functions(). The list of G-vectors is copied and the mapping',
+    'to the SIRIUS order of G+k vectors is computed once on the first fetch. Only the address of evc is stored:',
+    'the actual argument must be a contiguous array with the TARGET attribute and must stay allocated until',
+    'sirius_clear_wave_functions() is called. Registering the same k-point and spin index again replaces the',
+    'previous buffer.']
+  arguments:
+    ks_handler:
+      type: void*
+      attr: in, required
+      doc: K-point set handler.
+    ik:
+      type: int
+      attr: in, required
+      doc: Global index of k-point
+    ispn:
+      type: int
+      attr: in, required
+      doc: Spin index.
+    npw:
+      type: int
+      attr: in, required
+      doc: Local number of G+k vectors.
+    gvec_k:
+      type: int
+      attr: in, required, dimension(3,npw)
+      doc: List of G-vectors.
+    evc:
+      type: complex
+      attr: inout, required, dimension(*)
+      doc: Wave-functions buffer of [ld1, ld2, num_bands] dimensions.
+    ld1:
+      type: int
+      attr: in, required
+      doc: Leading dimension of evc array.
+    ld2:
+      type: int
+      attr: in, required
+      doc: Second dimension of evc array.
+@api end
+*/
+void sirius_register_wave_functions(void*          const* ks_handler__,
+                                    int            const* ik__,
+                                    int            const* ispn__,
+                                    int            const* npw__,
+                                    int*                  gvec_k__,
+                                    std::complex<double>* evc__,
+                                    int            const* ld1__,
+                                    int            const* ld2__)
+{
+    auto& ks = get_ks(ks_handler__);
+
+    if (*ik__ < 1 || *ik__ > ks.num_kpoints()) {
+        TERMINATE("wrong k-point index");
+    }
+    /* both spinor components are fetched at once in the non-collinear case */
+    if (*ispn__ < 1 || *ispn__ > ks.ctx().num_spin_dims()) {
+        TERMINATE("wrong spin index");
+    }
+    if (*npw__ < 0 || *npw__ > *ld1__) {
+        TERMINATE("number of G+k vectors exceeds the leading dimension of the host buffer");
+    }
+    if (*ld2__ < ((ks.ctx().num_mag_dims() == 3) ? 2 : 1)) {
+        TERMINATE("second dimension ld2 of the host buffer is too small");
+    }
+
+    std::unique_ptr<host_wf_buffer> buf(new host_wf_buffer);
+    buf->ik     = *ik__ - 1;
+    buf->ispn   = *ispn__ - 1;
+    buf->npw    = *npw__;
+    buf->gvec_k = std::vector<int>(gvec_k__, gvec_k__ + 3 * (*npw__));
+    buf->evc    = evc__;
+    buf->ld1    = *ld1__;
+    buf->ld2    = *ld2__;
+
+    auto& bufs = host_wf_buffers[*ks_handler__];
+    /* new buffer of the same k-point and spin replaces the old one */
+    auto it = std::find_if(bufs.begin(), bufs.end(), [&buf](std::unique_ptr<host_wf_buffer> const& b) {
+        return b->ik == buf->ik && b->ispn == buf->ispn;
+    });
+    if (it != bufs.end()) {
+        *it = std::move(buf);
+    } else {
+        bufs.push_back(std::move(buf));
+    }
+}
+
+/*
+@api begin
+sirius_clear_wave_functions:
+  doc: Remove all registered host code buffers of wave-functions.
+  arguments:
+    ks_handler:
+      type: void*
+      attr: in, required
+      doc: K-point set handler.
+@api end
+*/
+void sirius_clear_wave_functions(void* const* ks_handler__)
+{
+    host_wf_buffers.erase(*ks_handler__);
+}
+
+/// Build the exchange plan between the ranks of the band communicator for the registered buffer.
+/** Each rank of the band communicator stores a slice of G+k vectors; the plan tells which local coefficients are
+ *  sent to which rank and where the received coefficients go in the host code array. */
+static void init_host_wf_buffer(sirius::K_point_set& kset__, host_wf_buffer& buf__)
+{
+    auto& comm  = kset__.ctx().comm_band();
+    auto& gkvec = *buf__.gkvec;
+
+    auto igmap = host_gvec_mapping(kset__, gkvec, buf__.npw, buf__.gvec_k.data());
+
+    /* offsets of G+k vector slices */
+    std::vector<int> gvec_offset(comm.size());
+    for (int r = 0; r < comm.size(); r++) {
+        gvec_offset[r] = gkvec.gvec_offset(r);
+    }
+    auto rank_of_gvec = [&](int ig) {
+        return static_cast<int>(std::upper_bound(gvec_offset.begin(), gvec_offset.end(), ig) - gvec_offset.begin()) - 1;
+    };
+
+    auto& rlv = kset__.ctx().unit_cell().reciprocal_lattice_vectors();
+
+    buf__.recv_gvec = block_data_descriptor(comm.size());
+    int num_gvec_cutoff{0};
+    for (int ig = 0; ig < buf__.npw; ig++) {
+        vector3d<double> G(buf__.gvec_k[3 * ig], buf__.gvec_k[3 * ig + 1], buf__.gvec_k[3 * ig + 2]);
+        if ((rlv * (G + gkvec.vk())).length() <= kset__.ctx().gk_cutoff()) {
+            num_gvec_cutoff++;
+        }
+        if (igmap[ig] != std::numeric_limits<int>::max()) {
+            buf__.recv_gvec.counts[rank_of_gvec(std::abs(igmap[ig]))]++;
+        }
+    }
+    buf__.recv_gvec.calc_offsets();
+    /* every host G+k vector inside the cutoff must be found among the G+k vectors of SIRIUS */
+    if (buf__.recv_gvec.size() != num_gvec_cutoff) {
+        std::stringstream s;
+        s << "G+k vectors of k-point " << buf__.ik + 1 << " do not match the registered host buffer" << std::endl
+          << "  number of registered G+k vectors: " << buf__.npw << std::endl
+          << "  number of registered G+k vectors inside the cutoff: " << num_gvec_cutoff << std::endl
+          << "  number of mapped G+k vectors: " << buf__.recv_gvec.size();
+        TERMINATE(s);
+    }
+
+    /* global indices of requested G-vectors, grouped by the rank that stores them */
+    std::vector<int> req_gvec(buf__.recv_gvec.size());
+    buf__.recv_idx = std::vector<int>(buf__.recv_gvec.size());
+    std::vector<int> pos(buf__.recv_gvec.offsets);
+    for (int ig = 0; ig < buf__.npw; ig++) {
+        int ig1 = igmap[ig];
+        if (ig1 != std::numeric_limits<int>::max()) {
+            int r = rank_of_gvec(std::abs(ig1));
+            req_gvec[pos[r]] = std::abs(ig1);
+            /* host index is shifted by one to keep the sign of G=0 */
+            buf__.recv_idx[pos[r]] = (ig1 < 0) ? -(ig + 1) : ig + 1;
+            pos[r]++;
+        }
+    }
+
+    buf__.send_gvec = block_data_descriptor(comm.size());
+    comm.alltoall(buf__.recv_gvec.counts.data(), 1, buf__.send_gvec.counts.data(), 1);
+    buf__.send_gvec.calc_offsets();
+
+    buf__.send_idx = std::vector<int>(buf__.send_gvec.size());
+    comm.alltoall(req_gvec.data(), buf__.recv_gvec.counts.data(), buf__.recv_gvec.offsets.data(),
+                  buf__.send_idx.data(), buf__.send_gvec.counts.data(), buf__.send_gvec.offsets.data());
+    for (auto& ig : buf__.send_idx) {
+        ig -= gkvec.offset();
+        if (ig < 0 || ig >= gkvec.count()) {
+            TERMINATE("requested G+k vector is not stored by this rank");
+        }
+    }
+}
+
+/*
+@api begin
+sirius_fetch_wave_functions:
+  doc: Copy wave-functions of all registered k-points to the host code buffers.
+  full_doc: ['This is a collective operation. Each rank fills the buffers it has registered with',
+    'sirius_register_wave_functions(); ranks of the same band communicator must register the same k-points in the',
+    'same order.']
+  arguments:
+    ks_handler:
+      type: void*
+      attr: in, required
+      doc: K-point set handler.
+@api end
+*/
+void sirius_fetch_wave_functions(void* const* ks_handler__)
+{
+    PROFILE("sirius_api::sirius_fetch_wave_functions");
+
+    auto& kset    = get_ks(ks_handler__);
+    auto& sim_ctx = kset.ctx();
+    auto& comm_k  = kset.comm();
+    auto& comm_b  = sim_ctx.comm_band();
+    int num_bands = sim_ctx.num_bands();
+    int my_rank   = comm_k.rank();
+
+    auto& bufs = host_wf_buffers[*ks_handler__];
+
+    /* number of rounds; in each round every rank receives one k-point */
+    int num_rounds = static_cast<int>(bufs.size());
+    sim_ctx.comm().allreduce<int, mpi_op_t::max>(&num_rounds, 1);
+
+    for (int iround = 0; iround < num_rounds; iround++) {
+        host_wf_buffer* buf = (iround < static_cast<int>(bufs.size())) ? bufs[iround].get() : nullptr;
+
+        int jk   = buf ? buf->ik : -1;
+        int jspn = buf ? buf->ispn : -1;
+        /* G+k vectors are sent only once */
+        int need_gkvec = (buf && !buf->gkvec) ? 1 : 0;
+        comm_b.allreduce<int, mpi_op_t::max>(&need_gkvec, 1);
+
+        std::vector<int> jk_of_rank(comm_k.size());
+        comm_k.allgather(&jk, jk_of_rank.data(), my_rank, 1);
+        std::vector<int> jspn_of_rank(comm_k.size());
+        comm_k.allgather(&jspn, jspn_of_rank.data(), my_rank, 1);
+        std::vector<int> need_gkvec_of_rank(comm_k.size());
+        comm_k.allgather(&need_gkvec, need_gkvec_of_rank.data(), my_rank, 1);
+
+        for (int r = 0; r < comm_k.size(); r++) {
+            int this_jk = jk_of_rank[r];
+            if (this_jk < 0) {
+                continue;
+            }
+            int rank_with_jk = kset.spl_num_kpoints().local_rank(this_jk);
+
+            if (need_gkvec_of_rank[r]) {
+                auto gkvec = kset.send_recv_gkvec(this_jk, r);
+                if (my_rank == r) {
+                    buf->gkvec = std::unique_ptr<Gvec>(new Gvec(std::move(gkvec)));
+                    init_host_wf_buffer(kset, *buf);
+                }
+            }
+
+            if (!(my_rank == r || my_rank == rank_with_jk)) {
+                continue;
+            }
+
+            mdarray<double_complex, 3> evc;
+            if (my_rank == r) {
+                /* [npwx, npol, nbnd] array dimensions */
+                evc = mdarray<double_complex, 3>(buf->evc, buf->ld1, buf->ld2, num_bands);
+                evc.zero();
+            }
+
+            int ispn0{0};
+            int ispn1{1};
+            /* fetch two components in non-collinear case, otherwise fetch only one component */
+            if (sim_ctx.num_mag_dims() != 3) {
+                ispn0 = ispn1 = jspn_of_rank[r];
+            }
+            for (int s = ispn0; s <= ispn1; s++) {
+                int tag = Communicator::get_tag(r, rank_with_jk) + s;
+                Request req;
+                if (my_rank == rank_with_jk) {
+                    auto kp = kset[this_jk];
+                    req = comm_k.isend(&kp->spinor_wave_functions().pw_coeffs(s).prime(0, 0),
+                                       kp->gkvec().count() * num_bands, r, tag);
+                }
+                if (my_rank == r) {
+                    int gkvec_count = buf->gkvec->count();
+                    mdarray<double_complex, 2> wf(gkvec_count, num_bands);
+                    comm_k.recv(&wf(0, 0), gkvec_count * num_bands, rank_with_jk, tag);
+
+                    /* pack coefficients requested by the ranks of the band communicator */
+                    mdarray<double_complex, 2> sbuf(num_bands, buf->send_gvec.size());
+                    for (int i = 0; i < buf->send_gvec.size(); i++) {
+                        for (int j = 0; j < num_bands; j++) {
+                            sbuf(j, i) = wf(buf->send_idx[i], j);
+                        }
+                    }
+                    mdarray<double_complex, 2> rbuf(num_bands, buf->recv_gvec.size());
+
+                    block_data_descriptor sd(comm_b.size());
+                    block_data_descriptor rd(comm_b.size());
+                    for (int i = 0; i < comm_b.size(); i++) {
+                        sd.counts[i] = buf->send_gvec.counts[i] * num_bands;
+                        rd.counts[i] = buf->recv_gvec.counts[i] * num_bands;
+                    }
+                    sd.calc_offsets();
+                    rd.calc_offsets();
+                    comm_b.alltoall(sbuf.at(memory_t::host), sd.counts.data(), sd.offsets.data(),
+                                    rbuf.at(memory_t::host), rd.counts.data(), rd.offsets.data());
+
+                    int ispn = (sim_ctx.num_mag_dims() == 1) ? 0 : s;
+                    for (int i = 0; i < buf->recv_gvec.size(); i++) {
+                        int ig = std::abs(buf->recv_idx[i]) - 1;
+                        if (buf->recv_idx[i] < 0) {
+                            for (int j = 0; j < num_bands; j++) {
+                                evc(ig, ispn, j) = std::conj(rbuf(j, i));
+                            }
+                        } else {
+                            for (int j = 0; j < num_bands; j++) {
+                                evc(ig, ispn, j) = rbuf(j, i);
+                            }
+                        }
+                    }
+                }
+                if (my_rank == rank_with_jk) {
+                    req.wait();
+                }
+            }
+        }
+    }
+}
+
+/*
+@api begin
+sirius_get_band_energies_all:
+  doc: Get band energies of all k-points and spins.
+  arguments:
+    ks_handler:
+      type: void*
+      attr: in, required
+      doc: K-point set handler.
+    band_energies:
+      type: double
+      attr: out, required
+      doc: Array of band energies of [ld, num_spin_dims, num_kpoints] dimensions.
+    ld:
+      type: int
+      attr: in, required
+      doc: Leading dimension of band_energies array.
+@api end
+*/
+void sirius_get_band_energies_all(void*  const* ks_handler__,
+                                  double*       band_energies__,
+                                  int    const* ld__)
+{
+    auto& ks = get_ks(ks_handler__);
+    int num_spins = ks.ctx().num_spin_dims();
+    mdarray<double, 3> band_energies(band_energies__, *ld__, num_spins, ks.num_kpoints());
+    for (int ik = 0; ik < ks.num_kpoints(); ik++) {
+        for (int ispn = 0; ispn < num_spins; ispn++) {
+            for (int i = 0; i < ks.ctx().num_bands(); i++) {
+                band_energies(i, ispn, ik) = ks[ik]->band_energy(i, ispn);
+            }
+        }
+    }
+}
+
 //==/*
 //==@apibegin
 //==sirius_get_radial_integral:
@@ -49,6 +49,34 @@ Band::set_subspace_mtrx(int N__, int n__, int num_locked, Wave_functions& phi__,
 {
     PROFILE("sirius::Band::set_subspace_mtrx");
 
+    utils::thread_guard tg(ctx_.thread_policy(), utils::thread_stage_t::blas);
+
+    auto req = set_subspace_mtrx_begin(N__, n__, num_locked, phi__, op_phi__, mtrx__, mtrx_old__);
+    set_subspace_mtrx_end(N__, n__, num_locked, req, mtrx__, mtrx_old__);
+}
+
+template <typename T>
+void
+Band::set_subspace_mtrx(int N__, int n__, int num_locked, Wave_functions& phi__, Wave_functions& hphi__,
+                        Wave_functions& ophi__, dmatrix<T>& hmlt__, dmatrix<T>& ovlp__, dmatrix<T>* hmlt_old__,
+                        dmatrix<T>* ovlp_old__) const
+{
+    PROFILE("sirius::Band::set_subspace_mtrx");
+
+    utils::thread_guard tg(ctx_.thread_policy(), utils::thread_stage_t::blas);
+
+    /* reduction of the Hamiltonian matrix is overlapped with the local part of the overlap matrix */
+    auto req_h = set_subspace_mtrx_begin(N__, n__, num_locked, phi__, hphi__, hmlt__, hmlt_old__);
+    auto req_o = set_subspace_mtrx_begin(N__, n__, num_locked, phi__, ophi__, ovlp__, ovlp_old__);
+    set_subspace_mtrx_end(N__, n__, num_locked, req_h, hmlt__, hmlt_old__);
+    set_subspace_mtrx_end(N__, n__, num_locked, req_o, ovlp__, ovlp_old__);
+}
+
+template <typename T>
+Inner_request<T>
+Band::set_subspace_mtrx_begin(int N__, int n__, int num_locked, Wave_functions& phi__, Wave_functions& op_phi__,
+                              dmatrix<T>& mtrx__, dmatrix<T>* mtrx_old__) const
+{
     assert(n__ != 0);
     if (mtrx_old__ && mtrx_old__->size()) {
         assert(&mtrx__.blacs_grid() == &mtrx_old__->blacs_grid());
@@ -83,8 +111,16 @@ Band::set_subspace_mtrx(int N__, int n__, int num_locked, Wave_functions& phi__,
     }
 
     /* <{phi,phi_new}|Op|phi_new> */
-    inner(ctx_.spla_context(), (ctx_.num_mag_dims() == 3) ? 2 : 0, phi__, num_locked, N__ + n__ - num_locked, op_phi__,
-          N__, n__, mtrx__, 0, N__ - num_locked);
+    return inner_begin(ctx_.spla_context(), (ctx_.num_mag_dims() == 3) ? 2 : 0, phi__, num_locked,
+                       N__ + n__ - num_locked, op_phi__, N__, n__, mtrx__, 0, N__ - num_locked);
+}
+
+template <typename T>
+void
+Band::set_subspace_mtrx_end(int N__, int n__, int num_locked, Inner_request<T>& req__, dmatrix<T>& mtrx__,
+                            dmatrix<T>* mtrx_old__) const
+{
+    req__.wait();
 
     /* restore lower part */
     if (N__ > 0) {
@@ -340,8 +376,7 @@ void Band::initialize_subspace(Hamiltonian_k& Hk__, int num_ao__) const
         }
 
         /* setup eigen-value problem */
-        set_subspace_mtrx<T>(0, num_phi_tot, 0, phi, hphi, hmlt);
-        set_subspace_mtrx<T>(0, num_phi_tot, 0, phi, ophi, ovlp);
+        set_subspace_mtrx<T>(0, num_phi_tot, 0, phi, hphi, ophi, hmlt, ovlp);
 
         if (ctx_.control().verification_ >= 2 && ctx_.control().verbosity_ >= 2) {
             hmlt.serialize("hmlt", num_phi_tot);
@@ -550,4 +585,25 @@ void
 Band::set_subspace_mtrx<double_complex>(int N__, int n__, int num_locked, Wave_functions& phi__, Wave_functions& op_phi__,
                                         dmatrix<double_complex>& mtrx__, dmatrix<double_complex>* mtrx_old__) const;
 
+template
+void
+Band::set_subspace_mtrx<double>(int N__, int n__, int num_locked, Wave_functions& phi__, Wave_functions& hphi__,
+                                Wave_functions& ophi__, dmatrix<double>& hmlt__, dmatrix<double>& ovlp__,
+                                dmatrix<double>* hmlt_old__, dmatrix<double>* ovlp_old__) const;
+
+template
+void
+Band::set_subspace_mtrx<double_complex>(int N__, int n__, int num_locked, Wave_functions& phi__, Wave_functions& hphi__,
+                                        Wave_functions& ophi__, dmatrix<double_complex>& hmlt__,
+                                        dmatrix<double_complex>& ovlp__, dmatrix<double_complex>* hmlt_old__,
+                                        dmatrix<double_complex>* ovlp_old__) const;
+
+template
+void
+Band::initialize_subspace<double>(Hamiltonian_k& Hk__, int num_ao__) const;
+
+template
+void
+Band::initialize_subspace<double_complex>(Hamiltonian_k& Hk__, int num_ao__) const;
+
 }
@@ -27,6 +27,8 @@
 
 #include "SDDK/memory.hpp"
 #include "hamiltonian/hamiltonian.hpp"
+#include "SDDK/wf_inner.hpp"
+#include <functional>
 
 namespace sddk {
 /* forward declaration */
@@ -84,6 +86,19 @@ class Band // TODO: Band class is lightweight and in principle can be converted
     //template <typename T>
     //void diag_pseudo_potential_rmm_diis(K_point* kp__, int ispn__, Hamiltonian& H__) const;
 
+    /// Copy the old subspace matrix and start the inner product for the new part of it.
+    /** The reduction is left pending only if the subspace matrix is not distributed; for a distributed matrix the
+     *  inner product is completed before the function returns (see sddk::inner_begin()). */
+    template <typename T>
+    sddk::Inner_request<T> set_subspace_mtrx_begin(int N__, int n__, int num_locked, sddk::Wave_functions& phi__,
+                                                   sddk::Wave_functions& op_phi__, sddk::dmatrix<T>& mtrx__,
+                                                   sddk::dmatrix<T>* mtrx_old__) const;
+
+    /// Complete the inner product, restore the lower part of the subspace matrix and save it.
+    template <typename T>
+    void set_subspace_mtrx_end(int N__, int n__, int num_locked, sddk::Inner_request<T>& req__,
+                               sddk::dmatrix<T>& mtrx__, sddk::dmatrix<T>* mtrx_old__) const;
+
   public:
     /// Constructor
     Band(Simulation_context& ctx__);
@@ -95,6 +110,18 @@ class Band // TODO: Band class is lightweight and in principle can be converted
     void set_subspace_mtrx(int N__, int n__, int num_locked, sddk::Wave_functions& phi__, sddk::Wave_functions& op_phi__,
                            sddk::dmatrix<T>& mtrx__, sddk::dmatrix<T>* mtrx_old__ = nullptr) const;
 
+    /// Compute the Hamiltonian and overlap matrices for the subspace spanned by the wave-functions.
+    /** The two inner products are started one after another and completed at the end, so that the reduction of
+     *  the Hamiltonian matrix overlaps with the local computation of the overlap matrix. This happens only when
+     *  inner_begin() takes the split path: the subspace matrices are not distributed (BLACS grid of size 1) and
+     *  the wave-functions are plane-wave only and stored in the host memory. Otherwise both products are computed
+     *  one after another by SPLA and nothing is overlapped. */
+    template <typename T>
+    void set_subspace_mtrx(int N__, int n__, int num_locked, sddk::Wave_functions& phi__,
+                           sddk::Wave_functions& hphi__, sddk::Wave_functions& ophi__, sddk::dmatrix<T>& hmlt__,
+                           sddk::dmatrix<T>& ovlp__, sddk::dmatrix<T>* hmlt_old__ = nullptr,
+                           sddk::dmatrix<T>* ovlp_old__ = nullptr) const;
+
     /// Solve the band eigen-problem for pseudopotential case.
     template <typename T>
     int solve_pseudo_potential(Hamiltonian_k& Hk__) const;
@@ -116,6 +143,15 @@ class Band // TODO: Band class is lightweight and in principle can be converted
     /// Initialize the subspace for the entire k-point set.
     void initialize_subspace(K_point_set& kset__, Hamiltonian0& H0__) const;
 
+    /// Solve the band problem in a fixed potential for the k-points of a band-structure path.
+    /** The k-points are processed in the order of the path. Only the first local k-point of each rank is started
+     *  from the initial subspace; every next k-point is started from the converged wave-functions of its local
+     *  predecessor on the path. The callback is invoked with the global index of a k-point as soon as its band
+     *  energies are available. It fires only on the ranks that hold this k-point, i.e. on the ranks of its band
+     *  communicator; the other ranks are not notified. This allows to stream the result to the output. */
+    void solve_band_structure(K_point_set& kset__, Hamiltonian0& H0__,
+                              std::function<void(int)> on_kpoint__ = nullptr) const;
+
     /// Initialize the wave-functions subspace at a given k-point.
     /** If the number of atomic orbitals is smaller than the number of bands, the rest of the initial wave-functions
      *  are created from the random numbers. */
@@ -151,7 +151,7 @@ davidson(Hamiltonian_k& Hk__, Wave_functions& psi__, int num_mag_dims__, int sub
     /* get diagonal elements for preconditioning */
     auto h_o_diag = Hk__.get_h_o_diag_pw<T, 3>();
 
-    auto& std_solver = ctx.std_evp_solver();
+    auto& std_solver = ctx.subspace_evp_solver();
     auto& gen_solver = ctx.gen_evp_solver();
 
     int niter{0};
@@ -194,10 +194,12 @@ davidson(Hamiltonian_k& Hk__, Wave_functions& psi__, int num_mag_dims__, int sub
         }
 
         /* setup eigen-value problem */
-        Band(ctx).set_subspace_mtrx<T>(0, num_bands, 0, phi, hphi, hmlt, &hmlt_old);
-        if (!keep_phi_orthogonal__) {
-            /* setup overlap matrix */
-            Band(ctx).set_subspace_mtrx<T>(0, num_bands, 0, phi, sphi, ovlp, &ovlp_old);
+        if (keep_phi_orthogonal__) {
+            Band(ctx).set_subspace_mtrx<T>(0, num_bands, 0, phi, hphi, hmlt, &hmlt_old);
+        } else {
+            /* setup Hamiltonian and overlap matrices; reductions of the two matrices are overlapped if the
+               subspace matrices are not distributed */
+            Band(ctx).set_subspace_mtrx<T>(0, num_bands, 0, phi, hphi, sphi, hmlt, ovlp, &hmlt_old, &ovlp_old);
         }
 
         /* current subspace size */
@@ -218,6 +220,7 @@ davidson(Hamiltonian_k& Hk__, Wave_functions& psi__, int num_mag_dims__, int sub
             }
         } else {
             PROFILE("sirius::davidson|evp");
+            utils::thread_guard tg(ctx.thread_policy(), utils::thread_stage_t::blas);
             /* solve generalized eigen-value problem with the size N and get lowest num_bands eigen-vectors */
             if (keep_phi_orthogonal__) {
                 if (std_solver.solve(N, num_bands, hmlt, eval.at(memory_t::host), evec)) {
@@ -318,29 +321,12 @@ davidson(Hamiltonian_k& Hk__, Wave_functions& psi__, int num_mag_dims__, int sub
             /* setup eigen-value problem
              * N is the number of previous basis functions
              * n is the number of new basis functions */
-            Band(ctx).set_subspace_mtrx<T>(N, n, 0, phi, hphi, hmlt, &hmlt_old);
-
-            //if (ctx_.control().verification_ >= 1) {
-            //    double max_diff = check_hermitian(hmlt, N + n);
-            //    if (max_diff > 1e-12) {
-            //        std::stringstream s;
-            //        s << "H matrix is not hermitian, max_err = " << max_diff;
-            //        WARNING(s);
-            //    }
-            //}
-
-            if (!keep_phi_orthogonal__) {
-                /* setup overlap matrix */
-                Band(ctx).set_subspace_mtrx<T>(N, n, 0, phi, sphi, ovlp, &ovlp_old);
-
-                //if (ctx_.control().verification_ >= 1) {
-                //    double max_diff = check_hermitian(ovlp, N + n);
-                //    if (max_diff > 1e-12) {
-                //        std::stringstream s;
-                //        s << "S matrix is not hermitian, max_err = " << max_diff;
-                //        WARNING(s);
-                //    }
-                //}
+            if (keep_phi_orthogonal__) {
+                Band(ctx).set_subspace_mtrx<T>(N, n, 0, phi, hphi, hmlt, &hmlt_old);
+            } else {
+                /* setup Hamiltonian and overlap matrices; reductions of the two matrices are overlapped if the
+                   subspace matrices are not distributed */
+                Band(ctx).set_subspace_mtrx<T>(N, n, 0, phi, hphi, sphi, hmlt, ovlp, &hmlt_old, &ovlp_old);
             }
 
             /* increase size of the variation space */
@@ -349,19 +335,22 @@ davidson(Hamiltonian_k& Hk__, Wave_functions& psi__, int num_mag_dims__, int sub
             eval >> eval_old;
 
             PROFILE_START("sirius::davidson|evp");
-            if (keep_phi_orthogonal__) {
-                /* solve standard eigen-value problem with the size N */
-                if (std_solver.solve(N, num_bands, hmlt, eval.at(memory_t::host), evec)) {
-                    std::stringstream s;
-                    s << "error in diagonalziation";
-                    TERMINATE(s);
-                }
-            } else {
-                /* solve generalized eigen-value problem with the size N */
-                if (gen_solver.solve(N, num_bands, hmlt, ovlp, eval.at(memory_t::host), evec)) {
-                    std::stringstream s;
-                    s << "error in diagonalziation";
-                    TERMINATE(s);
+            {
+                utils::thread_guard tg(ctx.thread_policy(), utils::thread_stage_t::blas);
+                if (keep_phi_orthogonal__) {
+                    /* solve standard eigen-value problem with the size N */
+                    if (std_solver.solve(N, num_bands, hmlt, eval.at(memory_t::host), evec)) {
+                        std::stringstream s;
+                        s << "error in diagonalziation";
+                        TERMINATE(s);
+                    }
+                } else {
+                    /* solve generalized eigen-value problem with the size N */
+                    if (gen_solver.solve(N, num_bands, hmlt, ovlp, eval.at(memory_t::host), evec)) {
+                        std::stringstream s;
+                        s << "error in diagonalziation";
+                        TERMINATE(s);
+                    }
                 }
             }
             PROFILE_STOP("sirius::davidson|evp");
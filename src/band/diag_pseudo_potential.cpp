@@ -370,7 +370,7 @@ Band::diag_pseudo_potential_davidson(Hamiltonian_k& Hk__) const
         }
     }
 
-    auto& std_solver = ctx_.std_evp_solver();
+    auto& std_solver = ctx_.subspace_evp_solver();
 
     if (ctx_.control().print_checksum_) {
         for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
@@ -398,7 +398,7 @@ Band::diag_pseudo_potential_davidson(Hamiltonian_k& Hk__) const
         /* check if band energy is converged */
         auto is_converged = [&](int j__, int ispn__) -> bool
         {
-            double tol = ctx_.iterative_solver_tolerance();
+            double tol = kp.iterative_solver_tolerance();
             double empy_tol = std::max(tol * ctx_.settings().itsol_tol_ratio_, itso.empty_states_tolerance_);
             /* if band is empty, decrease the tolerance */
             // note: j__ indexes the unconverged eigenpairs -- excluding locked ones.
@@ -489,10 +489,11 @@ Band::diag_pseudo_potential_davidson(Hamiltonian_k& Hk__) const
         double current_frobenius_norm{0};
 
         /* second phase: start iterative diagonalization */
-        for (int k = 0; k < itso.num_steps_; k++) {
+        int num_steps = kp.iterative_solver_num_steps();
+        for (int k = 0; k < num_steps; k++) {
             int num_lockable = 0;
 
-            bool last_iteration = k == (itso.num_steps_ - 1);
+            bool last_iteration = k == (num_steps - 1);
 
             int num_ritz = num_bands - num_locked;
 
@@ -553,7 +554,7 @@ Band::diag_pseudo_potential_davidson(Hamiltonian_k& Hk__) const
                 if (last_iteration && !converged) {
                     kp.message(2, __function_name__, "Warning: maximum number of iterations reached, but %i "
                                "residual(s) did not converge for k-point %f %f %f, eigen-solver tolerance: %18.12f\n",
-                               num_unconverged, kp.vk()[0], kp.vk()[1], kp.vk()[2], ctx_.iterative_solver_tolerance());
+                               num_unconverged, kp.vk()[0], kp.vk()[1], kp.vk()[2], kp.iterative_solver_tolerance());
                 }
 
                 /* exit the loop if the eigen-vectors are converged or this is a last iteration */
@@ -820,7 +821,7 @@ Band::diag_S_davidson(Hamiltonian_k& Hk__) const
         o_diag1.allocate(memory_t::device).copy_to(memory_t::device);
     }
 
-    auto& std_solver = ctx_.std_evp_solver();
+    auto& std_solver = ctx_.subspace_evp_solver();
 
     for (int ispn = 0; ispn < num_sc; ispn++) {
         /* trial basis functions */
@@ -26,6 +26,44 @@
 
 namespace sirius {
 
+/// Copy the plane-wave part of the wave-functions from one k-point to another using the G-vector Miller indices.
+/** Both k-points are assumed to share the same communicator and hence the same G-vector distribution scheme.
+ *  Coefficients of the G-vectors which are absent or stored on another rank are set to zero. */
+static void
+copy_pw_wave_functions(K_point& src__, K_point& dst__, int num_bands__)
+{
+    auto& src_gkvec = src__.gkvec();
+    auto& dst_gkvec = dst__.gkvec();
+
+    int src_offset = src_gkvec.offset();
+    int src_count  = src_gkvec.count();
+
+    /* local index of the source coefficient for each local destination coefficient */
+    std::vector<int> idx(dst__.num_gkvec_loc());
+    #pragma omp parallel for schedule(static)
+    for (int igloc = 0; igloc < dst__.num_gkvec_loc(); igloc++) {
+        int ig = src_gkvec.index_by_gvec(dst_gkvec.gvec(dst__.idxgk(igloc)));
+        if (ig >= src_offset && ig < src_offset + src_count) {
+            idx[igloc] = ig - src_offset;
+        } else {
+            idx[igloc] = -1;
+        }
+    }
+
+    auto& psi_src = src__.spinor_wave_functions();
+    auto& psi_dst = dst__.spinor_wave_functions();
+
+    for (int ispn = 0; ispn < psi_dst.num_sc(); ispn++) {
+        #pragma omp parallel for schedule(static)
+        for (int i = 0; i < num_bands__; i++) {
+            for (int igloc = 0; igloc < dst__.num_gkvec_loc(); igloc++) {
+                psi_dst.pw_coeffs(ispn).prime(igloc, i) =
+                    (idx[igloc] >= 0) ? psi_src.pw_coeffs(ispn).prime(idx[igloc], i) : double_complex(0, 0);
+            }
+        }
+    }
+}
+
 void
 Band::solve_full_potential(Hamiltonian_k& Hk__) const
 {
@@ -163,4 +201,74 @@ Band::solve(K_point_set& kset__, Hamiltonian0& H0__, bool precompute__) const
     }
 }
 
+void
+Band::solve_band_structure(K_point_set& kset__, Hamiltonian0& H0__, std::function<void(int)> on_kpoint__) const
+{
+    PROFILE("sirius::Band::solve_band_structure");
+
+    if (ctx_.full_potential()) {
+        H0__.potential().generate_pw_coefs();
+        H0__.potential().update_atomic_potential();
+        unit_cell_.generate_radial_functions();
+        unit_cell_.generate_radial_integrals();
+    }
+
+    int N{0};
+    if (ctx_.iterative_solver_input().init_subspace_ == "lcao") {
+        /* get the total number of atomic-centered orbitals */
+        N = unit_cell_.num_ps_atomic_wf();
+    }
+
+    bool gamma = ctx_.gamma_point() && (ctx_.so_correction() == false);
+
+    int num_dav_iter{0};
+    /* previous k-point on the path stored by this rank */
+    K_point* kp_prev{nullptr};
+    for (int ikloc = 0; ikloc < kset__.spl_num_kpoints().local_size(); ikloc++) {
+        int ik  = kset__.spl_num_kpoints(ikloc);
+        auto kp = kset__[ik];
+
+        auto Hk = H0__(*kp);
+        if (ctx_.full_potential()) {
+            solve_full_potential(Hk);
+        } else {
+            if (kp_prev) {
+                /* start from the converged subspace of the neighbouring k-point */
+                copy_pw_wave_functions(*kp_prev, *kp, ctx_.num_bands());
+            } else {
+                if (gamma) {
+                    initialize_subspace<double>(Hk, N);
+                } else {
+                    initialize_subspace<double_complex>(Hk, N);
+                }
+            }
+            /* reset the energies for the iterative solver to do at least two steps */
+            for (int ispn = 0; ispn < ctx_.num_spin_dims(); ispn++) {
+                for (int i = 0; i < ctx_.num_bands(); i++) {
+                    kp->band_energy(i, ispn, 0);
+                    kp->band_occupancy(i, ispn, ctx_.max_occupancy());
+                }
+            }
+            if (gamma) {
+                num_dav_iter += solve_pseudo_potential<double>(Hk);
+            } else {
+                num_dav_iter += solve_pseudo_potential<double_complex>(Hk);
+            }
+        }
+        if (on_kpoint__) {
+            on_kpoint__(ik);
+        }
+        kp_prev = kp;
+    }
+    kset__.comm().allreduce(&num_dav_iter, 1);
+    ctx_.num_itsol_steps(num_dav_iter);
+    if (!ctx_.full_potential()) {
+        ctx_.message(1, __function_name__, "average number of iterations: %12.6f\n",
+                     static_cast<double>(num_dav_iter) / kset__.num_kpoints());
+    }
+
+    /* synchronize eigen-values */
+    kset__.sync_band_energies();
+}
+
 } // namespace
@@ -25,6 +25,7 @@
 #ifndef __BETA_PROJECTORS_HPP__
 #define __BETA_PROJECTORS_HPP__
 
+#include <list>
 #include "beta_projectors_base.hpp"
 
 namespace sirius {
@@ -34,7 +35,78 @@ class Beta_projectors : public Beta_projectors_base
 {
   protected:
     bool prepared_{false};
+    /// Beta-projectors for all atoms.
+    /** On CPU the array is kept in the host memory unless memory_usage is "low". On GPU the array is allocated in
+     *  the device memory only if beta_cache_device is set and only between prepare() and dismiss(); chunks are
+     *  generated on the first request and reused until the beta-projectors are dismissed. */
     matrix<double_complex> beta_pw_all_atoms_;
+    /// True if the chunk of beta_pw_all_atoms_ is already generated.
+    std::vector<bool> chunk_ready_;
+    /// Buffers of the least-recently-used cache of chunks (CPU, memory_usage is "low").
+    std::vector<matrix<double_complex>> lru_buf_;
+    /// Index of the chunk stored in each LRU buffer or -1 if the buffer is empty.
+    std::vector<int> lru_chunk_;
+    /// Order of LRU buffers; the first element is the most recently used one.
+    std::list<int> lru_order_;
+
+    /// Storage policy of the beta-projectors.
+    inline bool store_all_atoms() const
+    {
+        switch (ctx_.processing_unit()) {
+            case device_t::CPU: {
+                return ctx_.control().memory_usage_ != "low";
+            }
+            case device_t::GPU: {
+                return ctx_.control().beta_cache_device_;
+            }
+        }
+        return false;
+    }
+
+    /// Get chunk of beta-projectors from the LRU cache, generating it on a miss.
+    inline void generate_lru(int chunk__)
+    {
+        int slot{-1};
+        for (int s : lru_order_) {
+            if (lru_chunk_[s] == chunk__) {
+                slot = s;
+                break;
+            }
+        }
+        bool hit = (slot >= 0);
+        if (!hit) {
+            /* evict the least recently used chunk */
+            slot = lru_order_.back();
+        }
+        lru_order_.remove(slot);
+        lru_order_.push_front(slot);
+
+        pw_coeffs_a_ = matrix<double_complex>(lru_buf_[slot].at(memory_t::host), num_gkvec_loc(),
+                                              chunk(chunk__).num_beta_);
+        if (!hit) {
+            Beta_projectors_base::generate(chunk__, 0);
+            lru_chunk_[slot] = chunk__;
+        }
+    }
+
+    /// Wrap the chunk of beta_pw_all_atoms_ into pw_coeffs_a_.
+    inline void wrap_all_atoms(int chunk__)
+    {
+        int ofs = chunk(chunk__).offset_;
+        switch (ctx_.processing_unit()) {
+            case device_t::CPU: {
+                pw_coeffs_a_ = matrix<double_complex>(beta_pw_all_atoms_.at(memory_t::host, 0, ofs),
+                                                      num_gkvec_loc(), chunk(chunk__).num_beta_);
+                break;
+            }
+            case device_t::GPU: {
+                pw_coeffs_a_ = matrix<double_complex>(nullptr, beta_pw_all_atoms_.at(memory_t::device, 0, ofs),
+                                                      num_gkvec_loc(), chunk(chunk__).num_beta_);
+                break;
+            }
+        }
+    }
+
     /// Generate plane-wave coefficients for beta-projectors of atom types.
     void generate_pw_coefs_t(std::vector<int>& igk__)
     {
@@ -92,22 +164,40 @@ class Beta_projectors : public Beta_projectors_base
         PROFILE("sirius::Beta_projectors");
         /* generate phase-factor independent projectors for atom types */
         generate_pw_coefs_t(igk__);
+        if (!num_beta_t()) {
+            return;
+        }
         /* special treatment for beta-projectors as they are mostly often used */
         switch (ctx_.processing_unit()) {
             /* beta projectors for atom types will be stored on GPU for the entire run */
             case device_t::GPU: {
                 reallocate_pw_coeffs_t_on_gpu_ = false;
                 pw_coeffs_t_.allocate(memory_t::device).copy_to(memory_t::device);
+                if (store_all_atoms()) {
+                    /* chunks are generated on demand */
+                    beta_pw_all_atoms_ = matrix<double_complex>(num_gkvec_loc(), ctx_.unit_cell().mt_lo_basis_size(),
+                                                                memory_t::none, "beta_pw_all_atoms_");
+                    chunk_ready_ = std::vector<bool>(num_chunks(), false);
+                }
                 break;
             }
-            /* generate beta projectors for all atoms */
             case device_t::CPU: {
-                beta_pw_all_atoms_ = matrix<double_complex>(num_gkvec_loc(), ctx_.unit_cell().mt_lo_basis_size());
-                for (int ichunk = 0; ichunk < num_chunks(); ichunk++) {
-                    /* wrap the the pointer in the big array beta_pw_all_atoms */
-                    pw_coeffs_a_ = matrix<double_complex>(&beta_pw_all_atoms_(0, chunk(ichunk).offset_),
-                                                          num_gkvec_loc(), chunk(ichunk).num_beta_);
-                    Beta_projectors_base::generate(ichunk, 0);
+                if (store_all_atoms()) {
+                    /* generate beta projectors for all atoms */
+                    beta_pw_all_atoms_ = matrix<double_complex>(num_gkvec_loc(), ctx_.unit_cell().mt_lo_basis_size());
+                    for (int ichunk = 0; ichunk < num_chunks(); ichunk++) {
+                        /* wrap the the pointer in the big array beta_pw_all_atoms */
+                        wrap_all_atoms(ichunk);
+                        Beta_projectors_base::generate(ichunk, 0);
+                    }
+                } else {
+                    /* keep only a few most recently used chunks */
+                    int n = std::max(1, std::min(num_chunks(), ctx_.control().beta_chunk_cache_size_));
+                    for (int i = 0; i < n; i++) {
+                        lru_buf_.push_back(matrix<double_complex>(num_gkvec_loc(), max_num_beta()));
+                        lru_chunk_.push_back(-1);
+                        lru_order_.push_back(i);
+                    }
                 }
                 break;
             }
@@ -121,7 +211,16 @@ class Beta_projectors : public Beta_projectors_base
         }
         switch (ctx_.processing_unit()) {
             case device_t::GPU: {
-                Beta_projectors_base::prepare();
+                if (store_all_atoms()) {
+                    if (!beta_pw_all_atoms_.on_device()) {
+                        beta_pw_all_atoms_.allocate(memory_t::device);
+                    }
+                    pw_coeffs_a_g0_ = mdarray<double_complex, 1>(max_num_beta(), ctx_.mem_pool(memory_t::host),
+                        "pw_coeffs_a_g0_");
+                    pw_coeffs_a_g0_.allocate(ctx_.mem_pool(memory_t::device));
+                } else {
+                    Beta_projectors_base::prepare();
+                }
                 break;
             }
             case device_t::CPU: break;
@@ -136,6 +235,12 @@ class Beta_projectors : public Beta_projectors_base
         }
         switch (ctx_.processing_unit()) {
             case device_t::GPU: {
+                if (store_all_atoms()) {
+                    /* release the device copy of all beta-projectors; it is regenerated after the next prepare() */
+                    beta_pw_all_atoms_.deallocate(memory_t::device);
+                    std::fill(chunk_ready_.begin(), chunk_ready_.end(), false);
+                    pw_coeffs_a_g0_.deallocate(memory_t::device);
+                }
                 Beta_projectors_base::dismiss();
                 break;
             }
@@ -148,12 +253,25 @@ class Beta_projectors : public Beta_projectors_base
     {
         switch (ctx_.processing_unit()) {
             case device_t::CPU: {
-                pw_coeffs_a_ = matrix<double_complex>(&beta_pw_all_atoms_(0, chunk(chunk__).offset_),
-                                                      num_gkvec_loc(), chunk(chunk__).num_beta_);
+                if (store_all_atoms()) {
+                    wrap_all_atoms(chunk__);
+                } else {
+                    generate_lru(chunk__);
+                }
                 break;
             }
             case device_t::GPU: {
-                Beta_projectors_base::generate(chunk__, 0);
+                if (store_all_atoms()) {
+                    wrap_all_atoms(chunk__);
+                    if (chunk_ready_[chunk__]) {
+                        generate_g0(chunk__, 0);
+                    } else {
+                        Beta_projectors_base::generate(chunk__, 0);
+                        chunk_ready_[chunk__] = true;
+                    }
+                } else {
+                    Beta_projectors_base::generate(chunk__, 0);
+                }
                 break;
             }
         }
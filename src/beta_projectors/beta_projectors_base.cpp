@@ -223,22 +223,27 @@ void Beta_projectors_base::generate(int ichunk__, int j__)
                                chunk(ichunk__).atom_pos_.at(memory_t::device),
                                pw_coeffs_a().at(memory_t::device));
 #endif
-            /* wave-functions are on CPU but the beta-projectors are on GPU */
-            if (gkvec_.comm().rank() == 0 && is_host_memory(ctx_.preferred_memory_t())) {
-                /* make beta-projectors for G=0 on the CPU */
-                #pragma omp parallel for schedule(static)
-                for (int i = 0; i < chunk(ichunk__).num_atoms_; i++) {
-                    for (int xi = 0; xi < chunk(ichunk__).desc_(static_cast<int>(beta_desc_idx::nbf), i); xi++) {
-                        pw_coeffs_a_g0_(chunk(ichunk__).desc_(static_cast<int>(beta_desc_idx::offset), i) + xi) =
-                            pw_coeffs_t_(0, chunk(ichunk__).desc_(static_cast<int>(beta_desc_idx::offset_t), i) + xi, j__);
-                    }
-                }
-            }
+            generate_g0(ichunk__, j__);
             break;
         }
     }
 }
 
+void Beta_projectors_base::generate_g0(int ichunk__, int j__)
+{
+    /* wave-functions are on CPU but the beta-projectors are on GPU */
+    if (gkvec_.comm().rank() == 0 && is_host_memory(ctx_.preferred_memory_t())) {
+        /* make beta-projectors for G=0 on the CPU */
+        #pragma omp parallel for schedule(static)
+        for (int i = 0; i < chunk(ichunk__).num_atoms_; i++) {
+            for (int xi = 0; xi < chunk(ichunk__).desc_(static_cast<int>(beta_desc_idx::nbf), i); xi++) {
+                pw_coeffs_a_g0_(chunk(ichunk__).desc_(static_cast<int>(beta_desc_idx::offset), i) + xi) =
+                    pw_coeffs_t_(0, chunk(ichunk__).desc_(static_cast<int>(beta_desc_idx::offset_t), i) + xi, j__);
+            }
+        }
+    }
+}
+
 void Beta_projectors_base::prepare()
 {
     PROFILE("sirius::Beta_projectors_base::prepare");
@@ -0,0 +1,240 @@
+// Copyright (c) 2013-2020 Anton Kozhevnikov, Thomas Schulthess
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+// the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+//    following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+//    and the following disclaimer in the documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** \file beta_projectors_rs.hpp
+ *
+ *  \brief Contains declaration and implementation of sirius::Beta_projectors_rs class.
+ */
+
+#ifndef __BETA_PROJECTORS_RS_HPP__
+#define __BETA_PROJECTORS_RS_HPP__
+
+#include "simulation_context.hpp"
+#include "hamiltonian/non_local_operator.hpp"
+#include "utils/profiler.hpp"
+
+namespace sirius {
+
+/// Beta-projectors tabulated on the points of the coarse FFT grid inside the spheres around atoms.
+/** The Bloch sum of the beta-projectors
+ *  \f[
+ *    \beta_{\xi}^{\alpha}({\bf r}) = \sum_{\bf T} e^{i{\bf k T}} \tilde \beta_{\ell_{\xi}}(|{\bf r} - {\bf r}_{\alpha}
+ *      - {\bf T}|) R_{\ell m}(\widehat{{\bf r} - {\bf r}_{\alpha} - {\bf T}})
+ *  \f]
+ *  is stored only at the grid points inside the sphere of radius \f$ R_0 \f$ around each atom. Since the
+ *  wave-functions are transformed to real space as \f$ u({\bf r}) = \sum_{\bf G} \psi({\bf G+k}) e^{i{\bf G r}} \f$,
+ *  the projections are
+ *  \f[
+ *    \langle \beta_{\xi}^{\alpha} | \psi \rangle = \frac{\sqrt{\Omega}}{N} \sum_{{\bf r} \in R_0}
+ *      \tilde \beta_{\xi}({\bf r} - {\bf r}_{\alpha} - {\bf T}) e^{i{\bf k}({\bf r} - {\bf T})} u({\bf r})
+ *  \f]
+ *  where \f$ N \f$ is the total number of coarse grid points. This makes the cost of the non-local operator linear
+ *  in the number of atoms. The Fourier-filtered radial functions \f$ \tilde \beta_{\ell}(r) \f$ and the radii
+ *  \f$ R_0 \f$ are shared by all k-points and are taken from Simulation_context::beta_rs_rf().
+ */
+class Beta_projectors_rs
+{
+  private:
+    Simulation_context const& ctx_;
+
+    /// Indices of the coarse grid points inside the sphere around each atom.
+    std::vector<std::vector<int>> idx_;
+
+    /// Values of the beta-projectors at the points of each atom (point index is the fastest).
+    std::vector<mdarray<double, 2>> beta_rg_;
+
+    /// Bloch phase factors at the points of each atom.
+    std::vector<mdarray<double_complex, 1>> phase_;
+
+    /// Temporary buffers for the contribution of each atom.
+    std::vector<mdarray<double_complex, 1>> buf_;
+
+    inline static void accumulate(double& x__, double_complex z__)
+    {
+        x__ += z__.real();
+    }
+
+    inline static void accumulate(double_complex& x__, double_complex z__)
+    {
+        x__ += z__;
+    }
+
+  public:
+    /// Constructor.
+    /** \param [in] ctx Simulation context.
+     *  \param [in] vk  Fractional coordinates of the k-point.
+     */
+    Beta_projectors_rs(Simulation_context const& ctx__, vector3d<double> vk__)
+        : ctx_(ctx__)
+    {
+        PROFILE("sirius::Beta_projectors_rs");
+
+        auto& uc = ctx_.unit_cell();
+
+        auto& rf_rs = ctx_.beta_rs_rf();
+
+        auto atoms_to_grid = ctx_.find_atoms_to_grid([&](int ia) { return rf_rs.R0(uc.atom(ia).type_id()); }, true);
+
+        auto vk = uc.reciprocal_lattice_vectors() * vk__;
+
+        idx_     = std::vector<std::vector<int>>(uc.num_atoms());
+        beta_rg_ = std::vector<mdarray<double, 2>>(uc.num_atoms());
+        phase_   = std::vector<mdarray<double_complex, 1>>(uc.num_atoms());
+        buf_     = std::vector<mdarray<double_complex, 1>>(uc.num_atoms());
+
+        #pragma omp parallel for schedule(dynamic)
+        for (int ia = 0; ia < uc.num_atoms(); ia++) {
+            auto& atom_type = uc.atom(ia).type();
+            int iat         = atom_type.id();
+            int nbf         = atom_type.mt_basis_size();
+            if (!nbf) {
+                continue;
+            }
+            int lmax  = atom_type.indexr().lmax();
+            int npt   = static_cast<int>(atoms_to_grid[ia].size());
+            auto pos  = uc.get_cartesian_coordinates(uc.atom(ia).position());
+
+            idx_[ia]     = std::vector<int>(npt);
+            beta_rg_[ia] = mdarray<double, 2>(npt, nbf);
+            phase_[ia]   = mdarray<double_complex, 1>(npt);
+            buf_[ia]     = mdarray<double_complex, 1>(npt);
+
+            std::vector<double> rlm(utils::lmmax(lmax));
+            std::vector<double> rf(atom_type.mt_radial_basis_size());
+            for (int ipt = 0; ipt < npt; ipt++) {
+                auto& e = atoms_to_grid[ia][ipt];
+                idx_[ia][ipt] = e.first;
+                /* e^{ik(r - T)}; r - T = (r - r_a - T) + r_a */
+                phase_[ia][ipt] = std::exp(double_complex(0, dot(vk, e.second + pos)));
+
+                auto rtp = SHT::spherical_coordinates(e.second);
+                sf::spherical_harmonics(lmax, rtp[1], rtp[2], &rlm[0]);
+                for (int idxrf = 0; idxrf < atom_type.mt_radial_basis_size(); idxrf++) {
+                    rf[idxrf] = rf_rs.value(idxrf, iat).at_point(rtp[0]);
+                }
+                for (int xi = 0; xi < nbf; xi++) {
+                    beta_rg_[ia](ipt, xi) = rf[atom_type.indexb(xi).idxrf] * rlm[atom_type.indexb(xi).lm];
+                }
+            }
+        }
+    }
+
+    /// Compute <beta|psi> of a block of wave-functions for all atoms.
+    /** \param [in]  n        Number of wave-functions.
+     *  \param [in]  psi_r    Local parts of the wave-functions in real space (real in case of Gamma-point).
+     *  \param [in]  ld       Leading dimension of psi_r.
+     *  \param [out] beta_psi Projections in the order of Atom::offset_lo() for each of the wave-functions.
+     *
+     *  The projections of the whole block are summed over the slabs of the coarse FFT grid with a single
+     *  reduction, so the wave-functions should be passed in blocks when the coarse FFT grid is distributed.
+     */
+    template <typename T>
+    void inner(int n__, T const* psi_r__, int ld__, mdarray<double_complex, 2>& beta_psi__)
+    {
+        PROFILE("sirius::Beta_projectors_rs::inner");
+
+        auto& uc = ctx_.unit_cell();
+
+        double norm = std::sqrt(uc.omega()) / ctx_.fft_coarse_grid().num_points();
+
+        #pragma omp parallel for schedule(dynamic)
+        for (int ia = 0; ia < uc.num_atoms(); ia++) {
+            int nbf = uc.atom(ia).mt_basis_size();
+            int npt = static_cast<int>(idx_[ia].size());
+            int ofs = uc.atom(ia).offset_lo();
+            if (!nbf) {
+                continue;
+            }
+            for (int j = 0; j < n__; j++) {
+                auto psi_r = psi_r__ + static_cast<size_t>(ld__) * j;
+                for (int ipt = 0; ipt < npt; ipt++) {
+                    buf_[ia][ipt] = phase_[ia][ipt] * psi_r[idx_[ia][ipt]];
+                }
+                for (int xi = 0; xi < nbf; xi++) {
+                    double_complex z(0, 0);
+                    for (int ipt = 0; ipt < npt; ipt++) {
+                        z += beta_rg_[ia](ipt, xi) * buf_[ia][ipt];
+                    }
+                    beta_psi__(ofs + xi, j) = z * norm;
+                }
+            }
+        }
+        /* sum over the slabs of the coarse FFT grid */
+        if (ctx_.comm_fft_coarse().size() > 1) {
+            ctx_.comm_fft_coarse().allreduce(beta_psi__.at(memory_t::host), uc.mt_lo_basis_size() * n__);
+        }
+    }
+
+    /// Multiply projections by the D-operator matrix in place.
+    void mul_by_d(int ispn__, D_operator& d_op__, mdarray<double_complex, 1>& beta_psi__) const
+    {
+        auto& uc = ctx_.unit_cell();
+
+        #pragma omp parallel for schedule(dynamic)
+        for (int ia = 0; ia < uc.num_atoms(); ia++) {
+            int nbf = uc.atom(ia).mt_basis_size();
+            int ofs = uc.atom(ia).offset_lo();
+            std::vector<double_complex> z(nbf, 0);
+            for (int xi2 = 0; xi2 < nbf; xi2++) {
+                for (int xi1 = 0; xi1 < nbf; xi1++) {
+                    z[xi1] += d_op__.value<double>(xi1, xi2, ispn__, ia) * beta_psi__[ofs + xi2];
+                }
+            }
+            std::copy(z.begin(), z.end(), &beta_psi__[ofs]);
+        }
+    }
+
+    /// Add \f$ \sum_{\xi} | \beta_{\xi} \rangle c_{\xi} \f$ to the real-space wave-function.
+    template <typename T>
+    void add(mdarray<double_complex, 1> const& c__, T* psi_r__)
+    {
+        PROFILE("sirius::Beta_projectors_rs::add");
+
+        auto& uc = ctx_.unit_cell();
+
+        double norm = std::sqrt(uc.omega());
+
+        #pragma omp parallel for schedule(dynamic)
+        for (int ia = 0; ia < uc.num_atoms(); ia++) {
+            int nbf = uc.atom(ia).mt_basis_size();
+            int npt = static_cast<int>(idx_[ia].size());
+            int ofs = uc.atom(ia).offset_lo();
+            if (!nbf) {
+                continue;
+            }
+            buf_[ia].zero();
+            for (int xi = 0; xi < nbf; xi++) {
+                auto z = c__[ofs + xi] * norm;
+                for (int ipt = 0; ipt < npt; ipt++) {
+                    buf_[ia][ipt] += beta_rg_[ia](ipt, xi) * z;
+                }
+            }
+        }
+        /* spheres of different atoms overlap; accumulate serially */
+        for (int ia = 0; ia < uc.num_atoms(); ia++) {
+            for (int ipt = 0; ipt < static_cast<int>(idx_[ia].size()); ipt++) {
+                accumulate(psi_r__[idx_[ia][ipt]], std::conj(phase_[ia][ipt]) * buf_[ia][ipt]);
+            }
+        }
+    }
+};
+
+} // namespace sirius
+
+#endif
@@ -0,0 +1,149 @@
+// Copyright (c) 2013-2020 Anton Kozhevnikov, Thomas Schulthess
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+// the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+//    following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+//    and the following disclaimer in the documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** \file beta_radial_functions_rs.hpp
+ *
+ *  \brief Contains declaration and implementation of sirius::Beta_radial_functions_rs class.
+ */
+
+#ifndef __BETA_RADIAL_FUNCTIONS_RS_HPP__
+#define __BETA_RADIAL_FUNCTIONS_RS_HPP__
+
+#include "unit_cell/unit_cell.hpp"
+#include "specfunc/sbessel.hpp"
+#include "utils/profiler.hpp"
+
+namespace sirius {
+
+/// Fourier-filtered radial functions of beta-projectors for the application of the non-local operator in real space.
+/** The radial functions are filtered following the mask function method of King-Smith, Payne and Lin
+ *  (PRB 44, 13063 (1991)): \f$ \beta(r) / m(r) \f$ is transformed to reciprocal space, truncated at the G+k cutoff
+ *  of the wave-functions and transformed back; the result is multiplied by the mask function \f$ m(r) \f$.
+ *  A Gaussian mask \f$ m(r) = e^{-\alpha (r/R_0)^2} \f$ is used here. The functions depend only on the atom types
+ *  and on the cutoff, so they are computed once and shared by all k-points.
+ */
+class Beta_radial_functions_rs
+{
+  private:
+    /// Ratio between the radius of the mask function and the cutoff radius of beta-projectors.
+    static constexpr double mask_radius_factor_{2.0};
+
+    /// Exponent of the Gaussian mask function; the mask is 10^{-3} at its radius.
+    static constexpr double mask_alpha_{6.907755};
+
+    /// Radius of the projector sphere for each atom type.
+    std::vector<double> R0_;
+
+    /// Fourier-filtered radial functions of beta-projectors for each atom type.
+    mdarray<Spline<double>, 2> values_;
+
+    /// Generate Fourier-filtered radial functions of beta-projectors.
+    void generate(Unit_cell const& uc__, double qcut__)
+    {
+        PROFILE("sirius::Beta_radial_functions_rs::generate");
+
+        values_ = mdarray<Spline<double>, 2>(uc__.max_mt_radial_basis_size(), uc__.num_atom_types());
+        R0_     = std::vector<double>(uc__.num_atom_types(), 0);
+
+        Radial_grid_lin<double> qgrid(static_cast<int>(qcut__ / 0.02) + 2, 0, qcut__);
+
+        auto mask = [](double x) { return std::exp(-mask_alpha_ * x * x); };
+
+        for (int iat = 0; iat < uc__.num_atom_types(); iat++) {
+            auto& atom_type = uc__.atom_type(iat);
+            int nbrf        = atom_type.num_beta_radial_functions();
+            if (!nbrf) {
+                continue;
+            }
+            auto& rgrid = atom_type.radial_grid();
+
+            /* cutoff radius of beta-projectors */
+            int ir_max{0};
+            for (int idxrf = 0; idxrf < nbrf; idxrf++) {
+                auto& beta = atom_type.beta_radial_function(idxrf);
+                for (int ir = beta.num_points() - 1; ir > ir_max; ir--) {
+                    if (std::abs(beta(ir)) > 1e-10) {
+                        ir_max = ir;
+                        break;
+                    }
+                }
+            }
+            ir_max    = std::min(ir_max + 1, atom_type.num_mt_points() - 1);
+            R0_[iat]  = mask_radius_factor_ * rgrid[ir_max];
+            double R0 = R0_[iat];
+
+            Radial_grid_lin<double> rgrid_rs(static_cast<int>(R0 / 0.01) + 2, 0, R0);
+
+            for (int idxrf = 0; idxrf < nbrf; idxrf++) {
+                int l = atom_type.indexr(idxrf).l;
+
+                /* beta(r) / m(r); remember that beta(r) are defined as multiplied by r */
+                Spline<double> f(rgrid);
+                for (int ir = 0; ir <= ir_max; ir++) {
+                    f(ir) = atom_type.beta_radial_function(idxrf)(ir) / mask(rgrid[ir] / R0);
+                }
+                f.interpolate();
+
+                /* \int j_l(q r) beta(r) / m(r) r^2 dr */
+                Spline<double> fq(qgrid);
+                #pragma omp parallel for schedule(static)
+                for (int iq = 0; iq < qgrid.num_points(); iq++) {
+                    Spherical_Bessel_functions jl(l, rgrid, qgrid[iq]);
+                    fq(iq) = sirius::inner(jl[l], f, 1);
+                }
+                fq.interpolate();
+
+                /* filtered radial function: m(r) 2/pi \int_0^{q_{cut}} j_l(q r) f(q) q^2 dq */
+                values_(idxrf, iat) = Spline<double>(rgrid_rs);
+                #pragma omp parallel for schedule(static)
+                for (int ir = 0; ir < rgrid_rs.num_points(); ir++) {
+                    Spherical_Bessel_functions jl(l, qgrid, rgrid_rs[ir]);
+                    values_(idxrf, iat)(ir) = mask(rgrid_rs[ir] / R0) * sirius::inner(jl[l], fq, 2) * 2 / pi;
+                }
+                values_(idxrf, iat).interpolate();
+            }
+        }
+    }
+
+  public:
+    /// Constructor.
+    /** \param [in] uc   Unit cell.
+     *  \param [in] qcut Cutoff of the Fourier filter (G+k cutoff of the wave-functions).
+     */
+    Beta_radial_functions_rs(Unit_cell const& uc__, double qcut__)
+    {
+        generate(uc__, qcut__);
+    }
+
+    /// Radius of the projector sphere for a given atom type.
+    inline double R0(int iat__) const
+    {
+        return R0_[iat__];
+    }
+
+    /// Filtered radial function of a given atom type.
+    inline Spline<double> const& value(int idxrf__, int iat__) const
+    {
+        return values_(idxrf__, iat__);
+    }
+};
+
+} // namespace sirius
+
+#endif
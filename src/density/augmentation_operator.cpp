@@ -43,6 +43,46 @@ extern "C" void aug_op_pw_coeffs_deriv_gpu(int ngvec__, int const* gvec_shell__,
 extern "C" void spherical_harmonics_rlm_gpu(int lmax__, int ntp__, double const* tp__, double* rlm__, int ld__);
 #endif
 
+void Augmentation_operator::generate_pw_coeffs_block(int g_begin__, int g_end__, double* q_pw__, int ld__) const
+{
+    PROFILE("sirius::Augmentation_operator::generate_pw_coeffs_block");
+
+    double fourpi_omega = fourpi / gvec_.omega();
+
+    /* maximum l of beta-projectors */
+    int lmax_beta = atom_type_.indexr().lmax();
+    int lmmax     = utils::lmmax(2 * lmax_beta);
+
+    auto l_by_lm = utils::l_by_lm(2 * lmax_beta);
+
+    /* number of beta-projectors */
+    int nbf = atom_type_.mt_basis_size();
+
+    #pragma omp parallel
+    {
+        std::vector<double> gvec_rlm(lmmax);
+        std::vector<double_complex> v(lmmax);
+
+        #pragma omp for schedule(static)
+        for (int igloc = g_begin__; igloc < g_end__; igloc++) {
+            sf::spherical_harmonics(2 * lmax_beta, (*tp_)(igloc, 0), (*tp_)(igloc, 1), &gvec_rlm[0]);
+            int igsh = gvec_.gvec_shell_idx_local(igloc);
+            double* q_pw = q_pw__ + 2 * static_cast<size_t>(igloc - g_begin__) * ld__;
+            for (int idx12 = 0; idx12 < nbf * (nbf + 1) / 2; idx12++) {
+                int lm1     = idx_(0, idx12);
+                int lm2     = idx_(1, idx12);
+                int idxrf12 = idx_(2, idx12);
+                for (int lm3 = 0; lm3 < lmmax; lm3++) {
+                    v[lm3] = std::conj(zilm_[lm3]) * gvec_rlm[lm3] * ri_values_(idxrf12, l_by_lm[lm3], igsh);
+                }
+                double_complex z = fourpi_omega * gaunt_coefs_->sum_L3_gaunt(lm2, lm1, &v[0]);
+                q_pw[idx12]       = z.real();
+                q_pw[idx12 + ld__] = z.imag();
+            }
+        }
+    }
+}
+
 void Augmentation_operator::generate_pw_coeffs(Radial_integrals_aug<false> const& radial_integrals__,
     sddk::mdarray<double, 2> const& tp__, memory_pool& mp__, memory_pool* mpd__)
 {
@@ -51,6 +91,8 @@ void Augmentation_operator::generate_pw_coeffs(Radial_integrals_aug<false> const
     }
     PROFILE("sirius::Augmentation_operator::generate_pw_coeffs");
 
+    tp_ = &tp__;
+
     double fourpi_omega = fourpi / gvec_.omega();
 
     /* maximum l of beta-projectors */
@@ -59,50 +101,31 @@ void Augmentation_operator::generate_pw_coeffs(Radial_integrals_aug<false> const
 
     auto l_by_lm = utils::l_by_lm(2 * lmax_beta);
 
-    sddk::mdarray<double_complex, 1> zilm(lmmax);
+    zilm_ = sddk::mdarray<double_complex, 1>(lmmax);
     for (int l = 0, lm = 0; l <= 2 * lmax_beta; l++) {
         for (int m = -l; m <= l; m++, lm++) {
-            zilm[lm] = std::pow(double_complex(0, 1), l);
+            zilm_[lm] = std::pow(double_complex(0, 1), l);
         }
     }
 
     /* Gaunt coefficients of three real spherical harmonics */
-    Gaunt_coefficients<double> gaunt_coefs(lmax_beta, 2 * lmax_beta, lmax_beta, SHT::gaunt_rrr);
+    gaunt_coefs_ = std::unique_ptr<Gaunt_coefficients<double>>(
+        new Gaunt_coefficients<double>(lmax_beta, 2 * lmax_beta, lmax_beta, SHT::gaunt_rrr));
 
     /* split G-vectors between ranks */
     int gvec_count  = gvec_.count();
 
-    /* array of real spherical harmonics for each G-vector */
-    sddk::mdarray<double, 2> gvec_rlm;
-    switch (atom_type_.parameters().processing_unit()) {
-        case device_t::CPU: {
-            gvec_rlm = sddk::mdarray<double, 2>(lmmax, gvec_count, mp__);
-            #pragma omp parallel for schedule(static)
-            for (int igloc = 0; igloc < gvec_count; igloc++) {
-                sf::spherical_harmonics(2 * lmax_beta, tp__(igloc, 0), tp__(igloc, 1), &gvec_rlm(0, igloc));
-            }
-            break;
-        }
-        case device_t::GPU: {
-            gvec_rlm = sddk::mdarray<double, 2>(lmmax, gvec_count, *mpd__);
-#if defined(__GPU)
-            spherical_harmonics_rlm_gpu(2 * lmax_beta, gvec_count, tp__.at(memory_t::device),
-                gvec_rlm.at(memory_t::device), gvec_rlm.ld());
-#endif
-            break;
-        }
-    }
-
     /* number of beta- radial functions */
     int nbrf = atom_type_.mt_radial_basis_size();
 
-    sddk::mdarray<double, 3> ri_values(nbrf * (nbrf + 1) / 2, 2 * lmax_beta + 1, gvec_.num_gvec_shells_local(), mp__);
+    /* radial integrals are kept for the on-the-fly generation; their size is proportional to the number of shells */
+    ri_values_ = sddk::mdarray<double, 3>(nbrf * (nbrf + 1) / 2, 2 * lmax_beta + 1, gvec_.num_gvec_shells_local());
     #pragma omp parallel for
     for (int j = 0; j < gvec_.num_gvec_shells_local(); j++) {
         auto ri = radial_integrals__.values(atom_type_.id(), gvec_.gvec_shell_len_local(j));
         for (int l = 0; l <= 2 * lmax_beta; l++) {
             for (int i = 0; i < nbrf * (nbrf + 1) / 2; i++) {
-                ri_values(i, l, j) = ri(i, l);
+                ri_values_(i, l, j) = ri(i, l);
             }
         }
     }
@@ -113,7 +136,7 @@ void Augmentation_operator::generate_pw_coeffs(Radial_integrals_aug<false> const
     int idxmax = nbf * (nbf + 1) / 2;
 
     /* flatten the indices */
-    sddk::mdarray<int, 2> idx(3, idxmax, mp__);
+    idx_ = sddk::mdarray<int, 2>(3, idxmax);
     for (int xi2 = 0; xi2 < nbf; xi2++) {
         int lm2    = atom_type_.indexb(xi2).lm;
         int idxrf2 = atom_type_.indexb(xi2).idxrf;
@@ -127,68 +150,65 @@ void Augmentation_operator::generate_pw_coeffs(Radial_integrals_aug<false> const
             /* packed radial-function index */
             int idxrf12 = utils::packed_index(idxrf1, idxrf2);
 
-            idx(0, idx12) = lm1;
-            idx(1, idx12) = lm2;
-            idx(2, idx12) = idxrf12;
+            idx_(0, idx12) = lm1;
+            idx_(1, idx12) = lm2;
+            idx_(2, idx12) = idxrf12;
         }
     }
 
-    /* array of plane-wave coefficients */
-    q_pw_ = mdarray<double, 2>(nbf * (nbf + 1) / 2, 2 * gvec_count, mp__, "q_pw_");
+    if (store_pw_coeffs_) {
+        /* array of plane-wave coefficients */
+        q_pw_ = mdarray<double, 2>(nbf * (nbf + 1) / 2, 2 * gvec_count, mp__, "q_pw_");
 
-    switch (atom_type_.parameters().processing_unit()) {
-        case device_t::CPU: {
-            #pragma omp parallel for schedule(static)
-            for (int igloc = 0; igloc < gvec_count; igloc++) {
-                std::vector<double_complex> v(lmmax);
-                for (int idx12 = 0; idx12 < nbf * (nbf + 1) / 2; idx12++) {
-                    int lm1     = idx(0, idx12);
-                    int lm2     = idx(1, idx12);
-                    int idxrf12 = idx(2, idx12);
-                    for (int lm3 = 0; lm3 < lmmax; lm3++) {
-                        v[lm3] = std::conj(zilm[lm3]) * gvec_rlm(lm3, igloc) *
-                            ri_values(idxrf12, l_by_lm[lm3], gvec_.gvec_shell_idx_local(igloc));
-                    }
-                    double_complex z = fourpi_omega * gaunt_coefs.sum_L3_gaunt(lm2, lm1, &v[0]);
-                    q_pw_(idx12, 2 * igloc)     = z.real();
-                    q_pw_(idx12, 2 * igloc + 1) = z.imag();
-                }
+        switch (atom_type_.parameters().processing_unit()) {
+            case device_t::CPU: {
+                generate_pw_coeffs_block(0, gvec_count, q_pw_.at(memory_t::host), static_cast<int>(q_pw_.ld()));
+                break;
             }
-            break;
-        }
-        case device_t::GPU: {
-            sddk::mdarray<int, 1> gvec_shell(gvec_count, mp__);
-            for (int igloc = 0; igloc < gvec_count; igloc++) {
-                gvec_shell(igloc) = gvec_.gvec_shell_idx_local(igloc);
-            }
-            gvec_shell.allocate(*mpd__).copy_to(memory_t::device);
+            case device_t::GPU: {
+                /* array of real spherical harmonics for each G-vector */
+                sddk::mdarray<double, 2> gvec_rlm(lmmax, gvec_count, *mpd__);
+#if defined(__GPU)
+                spherical_harmonics_rlm_gpu(2 * lmax_beta, gvec_count, tp__.at(memory_t::device),
+                    gvec_rlm.at(memory_t::device), gvec_rlm.ld());
+#endif
+                sddk::mdarray<int, 1> gvec_shell(gvec_count, mp__);
+                for (int igloc = 0; igloc < gvec_count; igloc++) {
+                    gvec_shell(igloc) = gvec_.gvec_shell_idx_local(igloc);
+                }
+                gvec_shell.allocate(*mpd__).copy_to(memory_t::device);
 
-            idx.allocate(*mpd__).copy_to(memory_t::device);
+                sddk::mdarray<int, 2> idx(&idx_(0, 0), 3, idxmax);
+                idx.allocate(*mpd__).copy_to(memory_t::device);
 
-            zilm.allocate(*mpd__).copy_to(memory_t::device);
+                sddk::mdarray<double_complex, 1> zilm(&zilm_[0], lmmax);
+                zilm.allocate(*mpd__).copy_to(memory_t::device);
 
-            sddk::mdarray<int, 1> l_by_lm_d(&l_by_lm[0], lmmax);
-            l_by_lm_d.allocate(*mpd__).copy_to(memory_t::device);
+                sddk::mdarray<int, 1> l_by_lm_d(&l_by_lm[0], lmmax);
+                l_by_lm_d.allocate(*mpd__).copy_to(memory_t::device);
 
-            auto gc = gaunt_coefs.get_full_set_L3();
-            gc.allocate(*mpd__).copy_to(memory_t::device);
+                auto gc = gaunt_coefs_->get_full_set_L3();
+                gc.allocate(*mpd__).copy_to(memory_t::device);
 
-            ri_values.allocate(*mpd__).copy_to(memory_t::device);
+                sddk::mdarray<double, 3> ri_values(&ri_values_(0, 0, 0), nbrf * (nbrf + 1) / 2, 2 * lmax_beta + 1,
+                                                   gvec_.num_gvec_shells_local());
+                ri_values.allocate(*mpd__).copy_to(memory_t::device);
 
-            q_pw_.allocate(*mpd__);
+                q_pw_.allocate(*mpd__);
 
 #if defined(__GPU)
-            int ld0 = static_cast<int>(gc.size(0));
-            int ld1 = static_cast<int>(gc.size(1));
-            aug_op_pw_coeffs_gpu(gvec_count, gvec_shell.at(memory_t::device), idx.at(memory_t::device),
-                idxmax, zilm.at(memory_t::device), l_by_lm_d.at(memory_t::device), lmmax,
-                gc.at(memory_t::device), ld0, ld1, gvec_rlm.at(memory_t::device), lmmax,
-                ri_values.at(memory_t::device), static_cast<int>(ri_values.size(0)), static_cast<int>(ri_values.size(1)),
-                q_pw_.at(memory_t::device), static_cast<int>(q_pw_.size(0)), fourpi_omega);
+                int ld0 = static_cast<int>(gc.size(0));
+                int ld1 = static_cast<int>(gc.size(1));
+                aug_op_pw_coeffs_gpu(gvec_count, gvec_shell.at(memory_t::device), idx.at(memory_t::device),
+                    idxmax, zilm.at(memory_t::device), l_by_lm_d.at(memory_t::device), lmmax,
+                    gc.at(memory_t::device), ld0, ld1, gvec_rlm.at(memory_t::device), lmmax,
+                    ri_values.at(memory_t::device), static_cast<int>(ri_values.size(0)), static_cast<int>(ri_values.size(1)),
+                    q_pw_.at(memory_t::device), static_cast<int>(q_pw_.size(0)), fourpi_omega);
 #endif
-            q_pw_.copy_to(memory_t::host);
+                q_pw_.copy_to(memory_t::host);
 
-            q_pw_.deallocate(memory_t::device);
+                q_pw_.deallocate(memory_t::device);
+            }
         }
     }
 
@@ -205,11 +225,13 @@ void Augmentation_operator::generate_pw_coeffs(Radial_integrals_aug<false> const
     q_mtrx_.zero();
 
     if (gvec_.comm().rank() == 0) {
+        /* Q(G=0) is the first local G-vector of rank#0 */
+        auto q_pw0 = q_pw_block(0, 1, mp__);
         for (int xi2 = 0; xi2 < nbf; xi2++) {
             for (int xi1 = 0; xi1 <= xi2; xi1++) {
                 /* packed orbital index */
                 int idx12         = utils::packed_index(xi1, xi2);
-                q_mtrx_(xi1, xi2) = q_mtrx_(xi2, xi1) = gvec_.omega() * q_pw_(idx12, 0);
+                q_mtrx_(xi1, xi2) = q_mtrx_(xi2, xi1) = gvec_.omega() * q_pw0(idx12, 0);
             }
         }
     }
@@ -217,11 +239,15 @@ void Augmentation_operator::generate_pw_coeffs(Radial_integrals_aug<false> const
     gvec_.comm().bcast(&q_mtrx_(0, 0), nbf * nbf, 0);
 
     if (atom_type_.parameters().control().print_checksum_) {
-        auto cs = q_pw_.checksum();
         auto cs1 = q_mtrx_.checksum();
-        gvec_.comm().allreduce(&cs, 1);
+        if (store_pw_coeffs_) {
+            auto cs = q_pw_.checksum();
+            gvec_.comm().allreduce(&cs, 1);
+            if (gvec_.comm().rank() == 0) {
+                utils::print_checksum("q_pw", cs);
+            }
+        }
         if (gvec_.comm().rank() == 0) {
-            utils::print_checksum("q_pw", cs);
             utils::print_checksum("q_mtrx", cs1);
         }
     }
@@ -32,7 +32,8 @@ namespace sirius {
 
 /// Augmentation charge operator Q(r) of the ultrasoft pseudopotential formalism.
 /** This class generates and stores the plane-wave coefficients of the augmentation charge operator for
-    a given atom type. */
+    a given atom type. If the coefficients are not stored, they are generated on demand for the requested
+    blocks of G-vectors from the radial integrals and Gaunt coefficients; see q_pw_block(). */
 class Augmentation_operator
 {
   private:
@@ -40,22 +41,66 @@ class Augmentation_operator
 
     Gvec const& gvec_;
 
+    /// True if plane-wave coefficients are stored for all local G-vectors.
+    bool store_pw_coeffs_{true};
+
     sddk::mdarray<double, 2> q_mtrx_;
 
     mutable sddk::mdarray<double, 2> q_pw_;
 
     mutable sddk::mdarray<double, 1> sym_weight_;
 
+    /// Spherical coordinates (theta, phi) of the local G-vectors.
+    sddk::mdarray<double, 2> const* tp_{nullptr};
+
+    /// Values of the radial integrals for each local G-vector shell.
+    sddk::mdarray<double, 3> ri_values_;
+
+    /// Flattened index of {lm1, lm2, idxrf12} for each packed {xi, xi'} index.
+    sddk::mdarray<int, 2> idx_;
+
+    /// Phase factors i^l.
+    sddk::mdarray<double_complex, 1> zilm_;
+
+    /// Gaunt coefficients of three real spherical harmonics.
+    std::unique_ptr<Gaunt_coefficients<double>> gaunt_coefs_;
+
+    /// Generate plane-wave coefficients for the local G-vectors in the range [g_begin, g_end) on the CPU.
+    void generate_pw_coeffs_block(int g_begin__, int g_end__, double* q_pw__, int ld__) const;
+
   public:
-    Augmentation_operator(Atom_type const& atom_type__, Gvec const& gvec__)
+    Augmentation_operator(Atom_type const& atom_type__, Gvec const& gvec__, bool store_pw_coeffs__ = true)
         : atom_type_(atom_type__)
         , gvec_(gvec__)
+        , store_pw_coeffs_(store_pw_coeffs__)
     {
     }
 
     void generate_pw_coeffs(Radial_integrals_aug<false> const& radial_integrals__, sddk::mdarray<double, 2> const& tp__,
         memory_pool& mp__, memory_pool* mpd__);
 
+    /// Return true if the plane-wave coefficients are stored for all local G-vectors.
+    inline bool store_pw_coeffs() const
+    {
+        return store_pw_coeffs_;
+    }
+
+    /// Plane-wave coefficients of Q for a block of local G-vectors [g_begin, g_end).
+    /** Returns an array of size nbf(nbf+1)/2 x 2(g_end - g_begin) with the real and imaginary parts of the
+        coefficients. If the coefficients are stored, the returned array is a wrapper around the stored data;
+        otherwise they are generated on the fly using the memory pool for the storage. */
+    sddk::mdarray<double, 2> q_pw_block(int g_begin__, int g_end__, memory_pool& mp__) const
+    {
+        int nbf = atom_type_.mt_basis_size();
+        if (store_pw_coeffs_) {
+            return sddk::mdarray<double, 2>(const_cast<double*>(q_pw_.at(memory_t::host, 0, 2 * g_begin__)),
+                                            nbf * (nbf + 1) / 2, 2 * (g_end__ - g_begin__));
+        }
+        sddk::mdarray<double, 2> q_pw(nbf * (nbf + 1) / 2, 2 * (g_end__ - g_begin__), mp__);
+        generate_pw_coeffs_block(g_begin__, g_end__, q_pw.at(memory_t::host), static_cast<int>(q_pw.ld()));
+        return q_pw;
+    }
+
     void prepare(stream_id sid, sddk::memory_pool* mp__) const
     {
         if (atom_type_.parameters().processing_unit() == device_t::GPU && atom_type_.augment()) {
@@ -79,6 +124,7 @@ class Augmentation_operator
         }
     }
 
+    /// Stored plane-wave coefficients; only available if store_pw_coeffs() is true.
     mdarray<double, 2> const& q_pw() const
     {
         return q_pw_;
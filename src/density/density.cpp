@@ -29,6 +29,7 @@
 #include "mixer/mixer_factory.hpp"
 #include "utils/profiler.hpp"
 #include "SDDK/wf_inner.hpp"
+#include "SDDK/omp.hpp"
 
 namespace sirius {
 
@@ -549,10 +550,118 @@ void Density::generate_paw_loc_density()
     }
 }
 
+void Density::add_k_point_contribution_rg_teams(K_point* kp__, mdarray<double, 2>& density_rg__, int num_teams__)
+{
+    PROFILE("sirius::Density::add_k_point_contribution_rg_teams");
+
+    double omega = unit_cell_.omega();
+
+    int nr  = static_cast<int>(density_rg__.size(0));
+    int ndm = static_cast<int>(density_rg__.size(1));
+
+    auto& psi = kp__->spinor_wave_functions();
+
+    /* independent copies of the FFT transform; created outside of the parallel region because the copy may call
+       MPI and released at the end of the call, so that only one k-point at a time holds the copies */
+    std::vector<spfft::Transform> transforms;
+    for (int t = 0; t < num_teams__; t++) {
+        transforms.push_back(kp__->spfft_transform().clone());
+    }
+
+    /* private density grids */
+    mdarray<double, 3> density_rg_t(nr, ndm, num_teams__, ctx_.mem_pool(memory_t::host), "density_rg_t");
+    density_rg_t.zero();
+
+    /* buffers for the up- component of spinor wave-functions */
+    mdarray<double_complex, 2> psi_r_up;
+    if (ctx_.num_mag_dims() == 3) {
+        psi_r_up = mdarray<double_complex, 2>(nr, num_teams__, ctx_.mem_pool(memory_t::host), "psi_r_up");
+    }
+
+    #pragma omp parallel num_threads(num_teams__)
+    {
+        int t = omp_get_thread_num();
+        /* the runtime may provide less threads than requested */
+        int nt = omp_get_num_threads();
+
+        auto& transform = transforms[t];
+        auto data_ptr   = transform.space_domain_data(SPFFT_PU_HOST);
+
+        if (ctx_.num_mag_dims() != 3) {
+            for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
+                int ncols = psi.pw_coeffs(ispn).spl_num_col().local_size();
+                for (int i = t; i < ncols; i += nt) {
+                    /* global index of the band */
+                    int j    = psi.pw_coeffs(ispn).spl_num_col()[i];
+                    double w = kp__->band_occupancy(j, ispn) * kp__->weight() / omega;
+
+                    auto inp_wf = psi.pw_coeffs(ispn).extra().at(memory_t::host, 0, i);
+                    /* transform to real space */
+                    transform.backward(reinterpret_cast<const double*>(inp_wf), SPFFT_PU_HOST);
+
+                    if (ctx_.gamma_point()) {
+                        for (int ir = 0; ir < nr; ir++) {
+                            density_rg_t(ir, ispn, t) += w * std::pow(data_ptr[ir], 2);
+                        }
+                    } else {
+                        auto data = reinterpret_cast<double_complex*>(data_ptr);
+                        for (int ir = 0; ir < nr; ir++) {
+                            auto z = data[ir];
+                            density_rg_t(ir, ispn, t) += w * (std::pow(z.real(), 2) + std::pow(z.imag(), 2));
+                        }
+                    }
+                }
+            }
+        } else { /* non-collinear case */
+            int ncols = psi.pw_coeffs(0).spl_num_col().local_size();
+            for (int i = t; i < ncols; i += nt) {
+                int j    = psi.pw_coeffs(0).spl_num_col()[i];
+                double w = kp__->band_occupancy(j, 0) * kp__->weight() / omega;
+
+                /* transform up- component of spinor function to real space */
+                auto inp_wf_up = psi.pw_coeffs(0).extra().at(memory_t::host, 0, i);
+                transform.backward(reinterpret_cast<const double*>(inp_wf_up), SPFFT_PU_HOST);
+                auto inp = reinterpret_cast<double_complex*>(data_ptr);
+                std::copy(inp, inp + nr, psi_r_up.at(memory_t::host, 0, t));
+
+                /* transform dn- component of spinor wave function */
+                auto inp_wf_dn = psi.pw_coeffs(1).extra().at(memory_t::host, 0, i);
+                transform.backward(reinterpret_cast<const double*>(inp_wf_dn), SPFFT_PU_HOST);
+                auto psi_r_dn = reinterpret_cast<double_complex*>(data_ptr);
+
+                for (int ir = 0; ir < nr; ir++) {
+                    auto up = psi_r_up(ir, t);
+                    auto r0 = (std::pow(up.real(), 2) + std::pow(up.imag(), 2)) * w;
+                    auto r1 = (std::pow(psi_r_dn[ir].real(), 2) + std::pow(psi_r_dn[ir].imag(), 2)) * w;
+
+                    auto z2 = up * std::conj(psi_r_dn[ir]) * w;
+
+                    density_rg_t(ir, 0, t) += r0;
+                    density_rg_t(ir, 1, t) += r1;
+                    density_rg_t(ir, 2, t) += 2.0 * std::real(z2);
+                    density_rg_t(ir, 3, t) -= 2.0 * std::imag(z2);
+                }
+            }
+        }
+    }
+
+    /* reduce private density grids */
+    #pragma omp parallel for schedule(static)
+    for (int ir = 0; ir < nr; ir++) {
+        for (int j = 0; j < ndm; j++) {
+            for (int t = 0; t < num_teams__; t++) {
+                density_rg__(ir, j) += density_rg_t(ir, j, t);
+            }
+        }
+    }
+}
+
 void Density::add_k_point_contribution_rg(K_point* kp__)
 {
     PROFILE("sirius::Density::add_k_point_contribution_rg");
 
+    utils::thread_guard tg(ctx_.thread_policy(), utils::thread_stage_t::fft);
+
     double omega = unit_cell_.omega();
 
     auto& fft = ctx_.spfft_coarse();
@@ -571,8 +680,16 @@ void Density::add_k_point_contribution_rg(K_point* kp__)
     /* location of the real-space wave-functions psi(r) */
     auto data_ptr = kp__->spfft_transform().space_domain_data(kp__->spfft_transform().processing_unit());
 
-    /* non-magnetic or collinear case */
-    if (ctx_.num_mag_dims() != 3) {
+    /* number of bands transformed concurrently */
+    int num_teams = ctx_.control().density_num_fft_teams_;
+    if (num_teams < 0) {
+        num_teams = omp_get_max_threads();
+    }
+    num_teams = std::min(num_teams, kp__->spinor_wave_functions().pw_coeffs(0).spl_num_col().local_size());
+
+    if (num_teams > 1 && fft.processing_unit() == SPFFT_PU_HOST && ctx_.comm_fft_coarse().size() == 1) {
+        add_k_point_contribution_rg_teams(kp__, density_rg, num_teams);
+    } else if (ctx_.num_mag_dims() != 3) { /* non-magnetic or collinear case */
         /* loop over pure spinor components */
         for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
             /* trivial case */
@@ -1302,6 +1419,10 @@ mdarray<double_complex, 2> Density::generate_rho_aug()
 {
     PROFILE("sirius::Density::generate_rho_aug");
 
+    if (ctx_.control().aug_real_space_) {
+        return generate_rho_aug_rg();
+    }
+
     auto spl_ngv_loc = ctx_.split_gvec_local();
 
     sddk::mdarray<double_complex, 2> rho_aug(ctx_.gvec().count(), ctx_.num_mag_dims() + 1, ctx_.mem_pool(memory_t::host));
@@ -1385,6 +1506,8 @@ mdarray<double_complex, 2> Density::generate_rho_aug()
                             phase_factors(i, 2 * (igloc - g_begin) + 1) = z.imag();
                         }
                     }
+                    /* plane-wave coefficients of Q for this block of G-vectors */
+                    auto q_pw = ctx_.augmentation_op(iat)->q_pw_block(g_begin, g_end, ctx_.mem_pool(memory_t::host));
                     for (int iv = 0; iv < ctx_.num_mag_dims() + 1; iv++) {
                         PROFILE_START("sirius::Density::generate_rho_aug|gemm");
                         linalg(linalg_t::blas).gemm('N', 'N', nbf * (nbf + 1) / 2, 2 * spl_ngv_loc.local_size(ib),
@@ -1398,8 +1521,8 @@ mdarray<double_complex, 2> Density::generate_rho_aug()
                             double_complex zsum(0, 0);
                             /* get contribution from non-diagonal terms */
                             for (int i = 0; i < nbf * (nbf + 1) / 2; i++) {
-                                double_complex z1 = double_complex(ctx_.augmentation_op(iat)->q_pw(i, 2 * igloc),
-                                                                   ctx_.augmentation_op(iat)->q_pw(i, 2 * igloc + 1));
+                                double_complex z1 = double_complex(q_pw(i, 2 * (igloc - g_begin)),
+                                                                   q_pw(i, 2 * (igloc - g_begin) + 1));
                                 double_complex z2(dm_pw(i, 2 * (igloc - g_begin)), dm_pw(i, 2 * (igloc - g_begin) + 1));
 
                                 zsum += z1 * z2 * ctx_.augmentation_op(iat)->sym_weight(i);
@@ -1751,6 +1874,135 @@ Density::get_magnetisation() const
     return std::make_tuple(total_mag, it_mag, mt_mag);
 }
 
+mdarray<double_complex, 2> Density::generate_rho_aug_rg()
+{
+    PROFILE("sirius::Density::generate_rho_aug_rg");
+
+    /* augmentation charge and magnetization on the fine real-space grid */
+    std::vector<Smooth_periodic_function<double>> rho_aug_rg;
+    rho_aug_rg.reserve(ctx_.num_mag_dims() + 1);
+    for (int iv = 0; iv < ctx_.num_mag_dims() + 1; iv++) {
+        rho_aug_rg.emplace_back(ctx_.spfft(), ctx_.gvec_partition(), &ctx_.mem_pool(memory_t::host));
+        rho_aug_rg.back().zero();
+    }
+
+    for (int iat = 0; iat < unit_cell_.num_atom_types(); iat++) {
+        auto& atom_type = unit_cell_.atom_type(iat);
+
+        if (!atom_type.augment() || atom_type.num_atoms() == 0) {
+            continue;
+        }
+
+        int nbf       = atom_type.mt_basis_size();
+        int nbrf      = atom_type.mt_radial_basis_size();
+        int lmax_beta = atom_type.indexr().lmax();
+        int lmmax     = utils::lmmax(2 * lmax_beta);
+        auto l_by_lm  = utils::l_by_lm(2 * lmax_beta);
+        auto& rgrid   = atom_type.radial_grid();
+
+        /* Gaunt coefficients of three real spherical harmonics */
+        Gaunt_coefficients<double> gaunt_coefs(lmax_beta, 2 * lmax_beta, lmax_beta, SHT::gaunt_rrr);
+
+        /* convert to real matrix */
+        auto dm = density_matrix_aux(iat);
+
+        for (int i = 0; i < atom_type.num_atoms(); i++) {
+            int ia = atom_type.atom_id(i);
+
+            auto& atom_to_grid_map = ctx_.atoms_to_grid_aug_map(ia);
+            int npt = static_cast<int>(atom_to_grid_map.size());
+
+            /* value of the augmentation charge at each point of the sphere */
+            mdarray<double, 2> rho_aug_atom(npt, ctx_.num_mag_dims() + 1, ctx_.mem_pool(memory_t::host));
+
+            #pragma omp parallel
+            {
+                std::vector<double> rlm(lmmax);
+                std::vector<double> v(lmmax);
+                mdarray<double, 2> qrf(nbrf * (nbrf + 1) / 2, 2 * lmax_beta + 1);
+
+                #pragma omp for schedule(static)
+                for (int ipt = 0; ipt < npt; ipt++) {
+                    auto rtp = SHT::spherical_coordinates(atom_to_grid_map[ipt].second);
+                    /* Q-radial functions are regular at the origin; take the value at the first grid point */
+                    double r = std::max(rtp[0], rgrid.first());
+                    int j    = std::min(rgrid.index_of(r), rgrid.num_points() - 2);
+                    double dx = r - rgrid[j];
+                    double r2_inv = 1.0 / (r * r);
+
+                    sf::spherical_harmonics(2 * lmax_beta, rtp[1], rtp[2], &rlm[0]);
+
+                    /* Q-radial functions are stored multiplied by r^2 */
+                    for (int l = 0; l <= 2 * lmax_beta; l++) {
+                        for (int idxrf2 = 0; idxrf2 < nbrf; idxrf2++) {
+                            for (int idxrf1 = 0; idxrf1 <= idxrf2; idxrf1++) {
+                                qrf(utils::packed_index(idxrf1, idxrf2), l) =
+                                    atom_type.q_radial_function(idxrf1, idxrf2, l)(j, dx) * r2_inv;
+                            }
+                        }
+                    }
+
+                    for (int iv = 0; iv < ctx_.num_mag_dims() + 1; iv++) {
+                        rho_aug_atom(ipt, iv) = 0;
+                    }
+
+                    for (int xi2 = 0; xi2 < nbf; xi2++) {
+                        int lm2    = atom_type.indexb(xi2).lm;
+                        int idxrf2 = atom_type.indexb(xi2).idxrf;
+
+                        for (int xi1 = 0; xi1 <= xi2; xi1++) {
+                            int lm1    = atom_type.indexb(xi1).lm;
+                            int idxrf1 = atom_type.indexb(xi1).idxrf;
+
+                            /* packed orbital index */
+                            int idx12 = utils::packed_index(xi1, xi2);
+                            /* packed radial-function index */
+                            int idxrf12 = utils::packed_index(idxrf1, idxrf2);
+
+                            for (int lm3 = 0; lm3 < lmmax; lm3++) {
+                                v[lm3] = rlm[lm3] * qrf(idxrf12, l_by_lm[lm3]);
+                            }
+                            /* Q_{xi1, xi2}(r); off-diagonal terms are counted twice */
+                            double q = gaunt_coefs.sum_L3_gaunt(lm2, lm1, &v[0]) * ((xi1 == xi2) ? 1 : 2);
+
+                            for (int iv = 0; iv < ctx_.num_mag_dims() + 1; iv++) {
+                                rho_aug_atom(ipt, iv) += dm(idx12, i, iv) * q;
+                            }
+                        }
+                    }
+                }
+            }
+
+            /* periodic images of the atom can contribute to the same point; accumulate serially */
+            for (int iv = 0; iv < ctx_.num_mag_dims() + 1; iv++) {
+                for (int ipt = 0; ipt < npt; ipt++) {
+                    rho_aug_rg[iv].f_rg(atom_to_grid_map[ipt].first) += rho_aug_atom(ipt, iv);
+                }
+            }
+        }
+    }
+
+    sddk::mdarray<double_complex, 2> rho_aug(ctx_.gvec().count(), ctx_.num_mag_dims() + 1,
+                                             ctx_.mem_pool(memory_t::host));
+    for (int iv = 0; iv < ctx_.num_mag_dims() + 1; iv++) {
+        rho_aug_rg[iv].fft_transform(-1);
+        #pragma omp parallel for schedule(static)
+        for (int igloc = 0; igloc < ctx_.gvec().count(); igloc++) {
+            rho_aug(igloc, iv) = rho_aug_rg[iv].f_pw_local(igloc);
+        }
+    }
+
+    if (ctx_.control().print_checksum_) {
+        auto cs = rho_aug.checksum();
+        ctx_.comm().allreduce(&cs, 1);
+        if (ctx_.comm().rank() == 0) {
+            utils::print_checksum("rho_aug", cs);
+        }
+    }
+
+    return rho_aug;
+}
+
 mdarray<double, 3> Density::density_matrix_aux(int iat__)
 {
     auto& atom_type = unit_cell_.atom_type(iat__);
@@ -1799,7 +2051,7 @@ void Density::mixer_init(Mixer_input mixer_cfg__)
     this->mixer_ = mixer::Mixer_factory<Periodic_function<double>, Periodic_function<double>,
                                         Periodic_function<double>, Periodic_function<double>,
                                         mdarray<double_complex, 4>, paw_density,
-                                        mdarray<double_complex, 4>>(mixer_cfg__);
+                                        mdarray<double_complex, 4>>(mixer_cfg__, ctx_.comm());
 
     const bool init_mt = ctx_.full_potential();
 
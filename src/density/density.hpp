@@ -270,6 +270,12 @@ class Density : public Field4D
     /// Add k-point contribution to the density and magnetization defined on the regular FFT grid.
     void add_k_point_contribution_rg(K_point* kp__);
 
+    /// Band-parallel version of add_k_point_contribution_rg() for the CPU and a serial coarse FFT.
+    /** Bands are split between num_teams__ threads; each thread transforms its bands with a private copy of the
+     *  FFT transform and accumulates into a private density grid. The grids are summed into density_rg__ at the
+     *  end. */
+    void add_k_point_contribution_rg_teams(K_point* kp__, sddk::mdarray<double, 2>& density_rg__, int num_teams__);
+
     /// Generate valence density in the muffin-tins
     void generate_valence_mt();
 
@@ -278,15 +284,12 @@ class Density : public Field4D
     {
         PROFILE("sirius::Density::generate_core_charge_density");
 
-        for (int icloc = 0; icloc < unit_cell_.spl_num_atom_symmetry_classes().local_size(); icloc++) {
-            int ic = unit_cell_.spl_num_atom_symmetry_classes(icloc);
+        for (int ic : unit_cell_.local_atom_symmetry_classes()) {
             unit_cell_.atom_symmetry_class(ic).generate_core_charge_density(ctx_.core_relativity());
         }
 
-        for (int ic = 0; ic < unit_cell_.num_atom_symmetry_classes(); ic++) {
-            int rank = unit_cell_.spl_num_atom_symmetry_classes().local_rank(ic);
-            unit_cell_.atom_symmetry_class(ic).sync_core_charge_density(ctx_.comm(), rank);
-        }
+        unit_cell_.sync_atom_symmetry_classes(
+            [this](int ic) { return unit_cell_.atom_symmetry_class(ic).core_charge_density_data(); });
     }
 
     void generate_pseudo_core_charge_density()
@@ -379,6 +382,17 @@ class Density : public Field4D
     /// Generate augmentation charge density.
     mdarray<double_complex, 2> generate_rho_aug();
 
+    /// Generate augmentation charge density in real space and transform it to plane waves.
+    /** Augmentation charge is accumulated directly on the fine real-space grid:
+        \f[
+            \rho^{aug}({\bf r}) = \sum_{\alpha} \sum_{\xi \xi'} d_{\xi \xi'}^{\alpha}
+              Q_{\xi \xi'}({\bf r} - \tau_{\alpha})
+        \f]
+        where the sum over \f$ {\bf r} \f$ is restricted to the points inside the augmentation sphere of
+        each atom. The cost of this method scales linearly with the number of atoms.
+     */
+    mdarray<double_complex, 2> generate_rho_aug_rg();
+
     /// Check density at MT boundary
     void check_density_continuity_at_mt()
     {
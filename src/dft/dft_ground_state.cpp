@@ -59,18 +59,13 @@ double DFT_ground_state::energy_kin_sum_pw() const
         int ik = kset_.spl_num_kpoints(ikloc);
         auto kp = kset_[ik];
 
+        auto psi2 = kp->band_weighted_pw_sumsqr();
+
         #pragma omp parallel for schedule(static) reduction(+:ekin)
         for (int igloc = 0; igloc < kp->num_gkvec_loc(); igloc++) {
             auto Gk = kp->gkvec().gkvec_cart<index_domain_t::local>(igloc);
 
-            double d{0};
-            for (int ispin = 0; ispin < ctx_.num_spins(); ispin++) {
-                for (int i = 0; i < kp->num_occupied_bands(ispin); i++) {
-                    double f = kp->band_occupancy(i, ispin);
-                    auto z = kp->spinor_wave_functions().pw_coeffs(ispin).prime(igloc, i);
-                    d += f * (std::pow(z.real(), 2) + std::pow(z.imag(), 2));
-                }
-            }
+            double d = psi2[igloc];
             if (kp->gkvec().reduced()) {
                 d *= 2;
             }
@@ -180,6 +175,90 @@ json DFT_ground_state::check_scf_density()
     return dict;
 }
 
+json DFT_ground_state::adapt_iterative_solver_tolerance(double tol_max__)
+{
+    double tol     = ctx_.iterative_solver_tolerance();
+    double tol_min = ctx_.settings().itsol_tol_min_;
+    double tol_max = std::max(tol_max__, tol);
+    int num_steps  = ctx_.iterative_solver_input().num_steps_;
+
+    int nk = kset_.spl_num_kpoints().local_size();
+
+    /* band energies of the previous iteration are not available at the first call */
+    bool has_old = band_energies_old_.size() != 0;
+    if (!has_old) {
+        band_energies_old_ = mdarray<double, 3>(ctx_.num_bands(), ctx_.num_spin_dims(), nk);
+    }
+
+    double tol_k_min  = std::numeric_limits<double>::max();
+    double tol_k_max  = 0;
+    int num_steps_min = std::numeric_limits<int>::max();
+    int num_steps_max = 0;
+
+    for (int ikloc = 0; ikloc < nk; ikloc++) {
+        auto kp = kset_[kset_.spl_num_kpoints(ikloc)];
+
+        /* maximum change of occupied band energies */
+        double de{0};
+        for (int ispn = 0; ispn < ctx_.num_spin_dims(); ispn++) {
+            for (int j = 0; j < ctx_.num_bands(); j++) {
+                double e = kp->band_energy(j, ispn);
+                if (std::abs(kp->band_occupancy(j, ispn)) >= ctx_.min_occupancy() * ctx_.max_occupancy()) {
+                    de = std::max(de, std::abs(e - band_energies_old_(j, ispn, ikloc)));
+                }
+                band_energies_old_(j, ispn, ikloc) = e;
+            }
+        }
+
+        double tol_k = tol;
+        if (has_old) {
+            tol_k = std::min(std::max(tol, 0.1 * de), std::min(10 * tol, tol_max));
+        }
+        tol_k = std::max(tol_min, tol_k);
+
+        /* 0 close to the minimum tolerance, 1 for the loose tolerance */
+        double r{0};
+        if (tol_max > tol_min) {
+            r = std::log(tol_k / tol_min) / std::log(tol_max / tol_min);
+            r = std::min(1.0, std::max(0.0, r));
+        }
+        int ns = std::max(2, static_cast<int>(std::round(num_steps * (1.5 - r))));
+
+        kp->iterative_solver_tolerance(tol_k);
+        kp->iterative_solver_num_steps(ns);
+
+        tol_k_min     = std::min(tol_k_min, tol_k);
+        tol_k_max     = std::max(tol_k_max, tol_k);
+        num_steps_min = std::min(num_steps_min, ns);
+        num_steps_max = std::max(num_steps_max, ns);
+    }
+
+    Communicator const& comm = kset_.comm();
+    comm.allreduce<double, mpi_op_t::min>(&tol_k_min, 1);
+    comm.allreduce<double, mpi_op_t::max>(&tol_k_max, 1);
+    comm.allreduce<int, mpi_op_t::min>(&num_steps_min, 1);
+    comm.allreduce<int, mpi_op_t::max>(&num_steps_max, 1);
+
+    ctx_.message(2, __function_name__, "k-point tolerance: [%12.6E, %12.6E], number of steps: [%i, %i]\n",
+                 tol_k_min, tol_k_max, num_steps_min, num_steps_max);
+
+    json dict;
+    dict["tolerance"]   = tol;
+    dict["tolerance_k"] = {tol_k_min, tol_k_max};
+    dict["num_steps_k"] = {num_steps_min, num_steps_max};
+    return dict;
+}
+
+void DFT_ground_state::reset_iterative_solver_tolerance()
+{
+    for (int ikloc = 0; ikloc < kset_.spl_num_kpoints().local_size(); ikloc++) {
+        auto kp = kset_[kset_.spl_num_kpoints(ikloc)];
+        kp->iterative_solver_tolerance(-1);
+        kp->iterative_solver_num_steps(-1);
+    }
+    band_energies_old_ = mdarray<double, 3>();
+}
+
 json DFT_ground_state::find(double rms_tol, double energy_tol, double initial_tolerance, int num_dft_iter, bool write_state)
 {
     PROFILE("sirius::DFT_ground_state::scf_loop");
@@ -193,8 +272,11 @@ json DFT_ground_state::find(double rms_tol, double energy_tol, double initial_to
     int num_iter{-1};
     std::vector<double> rms_hist;
     std::vector<double> etot_hist;
+    std::vector<json> itsol_hist;
 
     ctx_.iterative_solver_tolerance(initial_tolerance);
+    /* k-point tolerances of a previous run must not override the initial tolerance */
+    reset_iterative_solver_tolerance();
 
     for (int iter = 0; iter < num_dft_iter; iter++) {
         PROFILE("sirius::DFT_ground_state::scf_loop|iteration");
@@ -222,6 +304,9 @@ json DFT_ground_state::find(double rms_tol, double energy_tol, double initial_to
         tol = std::max(ctx_.settings().itsol_tol_min_, tol);
         /* set new tolerance of iterative solver */
         ctx_.iterative_solver_tolerance(tol);
+        if (ctx_.iterative_solver_input().adaptive_tolerance_) {
+            itsol_hist.push_back(adapt_iterative_solver_tolerance(initial_tolerance));
+        }
 
         /* check number of elctrons */
         density_.check_num_electrons();
@@ -263,6 +348,9 @@ json DFT_ground_state::find(double rms_tol, double energy_tol, double initial_to
         eold = etot;
     }
 
+    /* the following calculations use the global tolerance again */
+    reset_iterative_solver_tolerance();
+
     if (write_state) {
         ctx_.create_storage_file();
         if (ctx_.full_potential()) { // TODO: why this is necessary?
@@ -281,6 +369,10 @@ json DFT_ground_state::find(double rms_tol, double energy_tol, double initial_to
     json dict = serialize();
     dict["scf_time"] = std::chrono::duration_cast<std::chrono::duration<double>>(tstop - tstart).count();
     dict["etot_history"] = etot_hist;
+    dict["num_loc_op_applied"] = ctx_.num_loc_op_applied();
+    if (ctx_.iterative_solver_input().adaptive_tolerance_) {
+        dict["itsol_history"] = itsol_hist;
+    }
     if (num_iter >= 0) {
         dict["converged"]          = true;
         dict["num_scf_iterations"] = num_iter;
@@ -69,6 +69,9 @@ class DFT_ground_state
     /// Store Ewald energy which is computed once and which doesn't change during the run.
     double ewald_energy_{0};
 
+    /// Band energies of the local k-points from the previous SCF iteration.
+    mdarray<double, 3> band_energies_old_;
+
   public:
     /// Constructor.
     DFT_ground_state(K_point_set& kset__)
@@ -136,6 +139,17 @@ class DFT_ground_state
     /// Update the parameters after the change of lattice vectors or atomic positions.
     void update();
 
+    /// Set the tolerance and the number of steps of the iterative solver for each local k-point.
+    /** The tolerance of a k-point is relaxed up to ten times the global tolerance if its occupied band energies
+     *  still change by more than the global tolerance between the SCF iterations. The number of steps is scaled
+     *  from a half of the default value for the loose tolerance to 1.5 times the default value close to the
+     *  minimum tolerance. Returns the summary of the decisions. */
+    json adapt_iterative_solver_tolerance(double tol_max__);
+
+    /// Remove the k-point specific tolerances and numbers of steps of the iterative solver.
+    /** The global values of the simulation context are used again afterwards. */
+    void reset_iterative_solver_tolerance();
+
     /// Run the SCF ground state calculation and find a total energy minimum.
     json find(double density_tol, double energy_tol, double initial_tolerance, int num_dft_iter, bool write_state);
 
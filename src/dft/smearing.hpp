@@ -62,6 +62,14 @@ inline double cold(double e)
     return 0.5 * (1 - std::erf(e)) - 1 - 0.25 * std::exp(-e * e) * (a + 2 * e - 2 * a * e * e) / std::sqrt(pi);
 }
 
+/// Derivative of Gaussian occupancy with the opposite sign: -d gaussian(e, delta) / de.
+inline double gaussian_delta(double e, double delta)
+{
+    const double sqrt_pi = 1.7724538509055160273;
+    double x = e / delta;
+    return std::exp(-x * x) / delta / sqrt_pi;
+}
+
 }
 
 #endif
@@ -293,6 +293,54 @@ inline Spheric_function<function_domain_t::spatial, double> operator*(Spheric_ve
     return result;
 }
 
+/// Evaluate a pointwise expression of spheric functions in a single pass over the (angular, radial) points.
+/** The expression is passed as a callable which takes a linear point index and returns the new value of the
+    result at this point. All functions referenced by the expression must have the same angular domain and radial
+    grid as the result. No temporary functions are allocated, which makes this the preferred way to evaluate
+    arithmetic formulas like \f$ V_{xc} \leftarrow V_{xc} - 2 v_{\sigma} \Delta \rho \f$:
+    \code{.cpp}
+    pointwise(vxc_tp, [&](size_t i) { return vxc_tp[i] - 2.0 * vsigma_tp[i] * lapl_rho_tp[i]; });
+    \endcode
+    The expression is allowed to read the result itself at the same point.
+ */
+template <function_domain_t domain_t, typename T, typename F>
+inline void pointwise(Spheric_function<domain_t, T>& res__, F&& expr__)
+{
+    T* ptr_res = res__.at(memory_t::host);
+    size_t n = res__.size();
+
+    #pragma omp parallel for simd schedule(static)
+    for (size_t i = 0; i < n; i++) {
+        ptr_res[i] = expr__(i);
+    }
+}
+
+/// Dot product of two gradients of real functions in spatial domain stored in the existing function.
+/** All three Cartesian components are accumulated in a single pass. */
+inline void dot(Spheric_vector_function<function_domain_t::spatial, double> const& f__,
+                Spheric_vector_function<function_domain_t::spatial, double> const& g__,
+                Spheric_function<function_domain_t::spatial, double>& res__)
+{
+    if (f__.radial_grid().hash() != g__.radial_grid().hash() ||
+        f__.radial_grid().hash() != res__.radial_grid().hash()) {
+        TERMINATE("wrong radial grids");
+    }
+    for (int x: {0, 1, 2}) {
+        if (f__[x].size() != res__.size() || g__[x].size() != res__.size()) {
+            TERMINATE("wrong number of angular points");
+        }
+    }
+
+    double const* f0 = f__[0].at(memory_t::host);
+    double const* f1 = f__[1].at(memory_t::host);
+    double const* f2 = f__[2].at(memory_t::host);
+    double const* g0 = g__[0].at(memory_t::host);
+    double const* g1 = g__[1].at(memory_t::host);
+    double const* g2 = g__[2].at(memory_t::host);
+
+    pointwise(res__, [=](size_t i) { return f0[i] * g0[i] + f1[i] * g1[i] + f2[i] * g2[i]; });
+}
+
 /// Summation of two functions.
 template <function_domain_t domain_t, typename T>
 Spheric_function<domain_t, T> operator+(Spheric_function<domain_t, T> const& a__, Spheric_function<domain_t, T> const& b__)
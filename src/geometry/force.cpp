@@ -136,26 +136,43 @@ mdarray<double, 2> const& Force::calc_forces_total()
             }
         }
     } else {
-        calc_forces_vloc();
-        calc_forces_us();
         calc_forces_nonloc();
-        calc_forces_core();
-        calc_forces_ewald();
-        calc_forces_scf_corr();
-        calc_forces_hubbard();
+        calc_forces_total_pp();
+    }
+    return forces_total_;
+}
 
-        forces_total_ = mdarray<double, 2>(3, ctx_.unit_cell().num_atoms());
-        for (int ia = 0; ia < ctx_.unit_cell().num_atoms(); ia++) {
-            for (int x : {0, 1, 2}) {
-                forces_total_(x, ia) = forces_vloc_(x, ia) + forces_us_(x, ia) + forces_nonloc_(x, ia) +
-                                       forces_core_(x, ia) + forces_ewald_(x, ia) + forces_scf_corr_(x, ia) +
-                                       forces_hubbard_(x, ia);
-            }
-        }
+mdarray<double, 2> const& Force::calc_forces_total(mdarray<double, 2>& forces_nonloc__)
+{
+    if (ctx_.full_potential()) {
+        TERMINATE("not implemented for the full-potential case");
     }
+    forces_nonloc_ = std::move(forces_nonloc__);
+    finalize_forces_nonloc();
+    calc_forces_total_pp();
+
     return forces_total_;
 }
 
+void Force::calc_forces_total_pp()
+{
+    calc_forces_vloc();
+    calc_forces_us();
+    calc_forces_core();
+    calc_forces_ewald();
+    calc_forces_scf_corr();
+    calc_forces_hubbard();
+
+    forces_total_ = mdarray<double, 2>(3, ctx_.unit_cell().num_atoms());
+    for (int ia = 0; ia < ctx_.unit_cell().num_atoms(); ia++) {
+        for (int x : {0, 1, 2}) {
+            forces_total_(x, ia) = forces_vloc_(x, ia) + forces_us_(x, ia) + forces_nonloc_(x, ia) +
+                                   forces_core_(x, ia) + forces_ewald_(x, ia) + forces_scf_corr_(x, ia) +
+                                   forces_hubbard_(x, ia);
+        }
+    }
+}
+
 mdarray<double, 2> const& Force::calc_forces_ibs()
 {
     forces_ibs_ = mdarray<double, 2>(3, ctx_.unit_cell().num_atoms());
@@ -170,11 +187,19 @@ mdarray<double, 2> const& Force::calc_forces_ibs()
         }
     }
 
+    /* shell index of all G-vectors; G-G' differences of the k-point loop are not local to this rank */
+    auto& gv = ctx_.gvec();
+    std::vector<int> gvec_shell(gv.num_gvec());
+    for (int igloc = 0; igloc < gv.count(); igloc++) {
+        gvec_shell[gv.offset() + igloc] = gv.shell(gv.offset() + igloc);
+    }
+    gv.comm().allgather(gvec_shell.data(), gv.offset(), gv.count());
+
     Hamiltonian0 H0(potential_);
     for (int ikloc = 0; ikloc < kset_.spl_num_kpoints().local_size(); ikloc++) {
         int ik = kset_.spl_num_kpoints(ikloc);
         auto hk = H0(*kset_[ik]);
-        add_ibs_force(kset_[ik], hk, ffac, forces_ibs_);
+        add_ibs_force(kset_[ik], hk, ffac, gvec_shell, forces_ibs_);
     }
     ctx_.comm().allreduce(&forces_ibs_(0, 0), (int)forces_ibs_.size());
     symmetrize(forces_ibs_);
@@ -394,43 +419,63 @@ mdarray<double, 2> const& Force::calc_forces_us()
         /* get auxiliary density matrix */
         auto dm = density_.density_matrix_aux(iat);
 
-        mdarray<double, 2> v_tmp(atom_type.num_atoms(), ctx_.gvec().count() * 2, *mp);
-        mdarray<double, 2> tmp(nbf * (nbf + 1) / 2, atom_type.num_atoms(), *mp);
-
-        /* over spin components, can be from 1 to 4*/
-        for (int ispin = 0; ispin < ctx_.num_mag_dims() + 1; ispin++) {
-            /* over 3 components of the force/G - vectors */
-            for (int ivec = 0; ivec < 3; ivec++) {
-                /* over local rank G vectors */
-                #pragma omp parallel for schedule(static)
-                for (int igloc = 0; igloc < ctx_.gvec().count(); igloc++) {
-                    int ig   = ctx_.gvec().offset() + igloc;
-                    auto gvc = ctx_.gvec().gvec_cart<index_domain_t::local>(igloc);
-                    for (int ia = 0; ia < atom_type.num_atoms(); ia++) {
-                        /* here we write in v_tmp  -i * G * exp[ iGRn] Veff(G)
-                         * but in formula we have   i * G * exp[-iGRn] Veff*(G)
-                         * the differences because we unfold complex array in the real one
-                         * and need negative imagine part due to a multiplication law of complex numbers */
-                        auto z = double_complex(0, -gvc[ivec]) * ctx_.gvec_phase_factor(ig, atom_type.atom_id(ia)) *
-                                 potential_.component(ispin).f_pw_local(igloc);
-                        v_tmp(ia, 2 * igloc)     = z.real();
-                        v_tmp(ia, 2 * igloc + 1) = z.imag();
+        auto spl_ngv_loc = ctx_.split_gvec_local();
+
+        int nspin = ctx_.num_mag_dims() + 1;
+
+        mdarray<double, 2> v_tmp(atom_type.num_atoms(), spl_ngv_loc.local_size() * 2, *mp);
+        /* results for each spin component and each component of the force */
+        mdarray<double, 3> tmp(nbf * (nbf + 1) / 2, atom_type.num_atoms(), 3 * nspin, *mp);
+        tmp.zero();
+
+        /* split a large loop over G-vectors into blocks */
+        for (int ib = 0; ib < spl_ngv_loc.num_ranks(); ib++) {
+            int g_begin = spl_ngv_loc.global_index(0, ib);
+            int g_end   = g_begin + spl_ngv_loc.local_size(ib);
+
+            /* plane-wave coefficients of Q for this block of G-vectors are shared by all spin and force components */
+            auto q_pw = aug_op->q_pw_block(g_begin, g_end, ctx_.mem_pool(memory_t::host));
+
+            /* over spin components, can be from 1 to 4*/
+            for (int ispin = 0; ispin < nspin; ispin++) {
+                /* over 3 components of the force/G - vectors */
+                for (int ivec = 0; ivec < 3; ivec++) {
+                    /* over local rank G vectors */
+                    #pragma omp parallel for schedule(static)
+                    for (int igloc = g_begin; igloc < g_end; igloc++) {
+                        int ig   = ctx_.gvec().offset() + igloc;
+                        auto gvc = ctx_.gvec().gvec_cart<index_domain_t::local>(igloc);
+                        for (int ia = 0; ia < atom_type.num_atoms(); ia++) {
+                            /* here we write in v_tmp  -i * G * exp[ iGRn] Veff(G)
+                             * but in formula we have   i * G * exp[-iGRn] Veff*(G)
+                             * the differences because we unfold complex array in the real one
+                             * and need negative imagine part due to a multiplication law of complex numbers */
+                            auto z = double_complex(0, -gvc[ivec]) * ctx_.gvec_phase_factor(ig, atom_type.atom_id(ia)) *
+                                     potential_.component(ispin).f_pw_local(igloc);
+                            v_tmp(ia, 2 * (igloc - g_begin))     = z.real();
+                            v_tmp(ia, 2 * (igloc - g_begin) + 1) = z.imag();
+                        }
                     }
-                }
 
-                /* multiply tmp matrices, or sum over G */
-                linalg(la).gemm('N', 'T', nbf * (nbf + 1) / 2, atom_type.num_atoms(), 2 * ctx_.gvec().count(),
-                    &linalg_const<double>::one(),
-                    aug_op->q_pw().at(memory_t::host), aug_op->q_pw().ld(),
-                    v_tmp.at(memory_t::host), v_tmp.ld(),
-                    &linalg_const<double>::zero(),
-                    tmp.at(memory_t::host), tmp.ld());
+                    /* multiply tmp matrices, or sum over G */
+                    linalg(la).gemm('N', 'T', nbf * (nbf + 1) / 2, atom_type.num_atoms(), 2 * (g_end - g_begin),
+                        &linalg_const<double>::one(),
+                        q_pw.at(memory_t::host), q_pw.ld(),
+                        v_tmp.at(memory_t::host), v_tmp.ld(),
+                        &linalg_const<double>::one(),
+                        tmp.at(memory_t::host, 0, 0, 3 * ispin + ivec), tmp.ld());
+                }
+            }
+        }
 
+        for (int ispin = 0; ispin < nspin; ispin++) {
+            for (int ivec = 0; ivec < 3; ivec++) {
                 #pragma omp parallel for
                 for (int ia = 0; ia < atom_type.num_atoms(); ia++) {
                     for (int i = 0; i < nbf * (nbf + 1) / 2; i++) {
                         forces_us_(ivec, atom_type.atom_id(ia)) += ctx_.unit_cell().omega() * reduce_g_fact *
-                                                                   dm(i, ia, ispin) * aug_op->sym_weight(i) * tmp(i, ia);
+                                                                   dm(i, ia, ispin) * aug_op->sym_weight(i) *
+                                                                   tmp(i, ia, 3 * ispin + ivec);
                     }
                 }
             }
@@ -644,7 +689,8 @@ mdarray<double, 2> const& Force::calc_forces_usnl()
     return forces_usnl_;
 }
 
-void Force::add_ibs_force(K_point* kp__, Hamiltonian_k& Hk__, mdarray<double, 2>& ffac__, mdarray<double, 2>& forcek__) const
+void Force::add_ibs_force(K_point* kp__, Hamiltonian_k& Hk__, mdarray<double, 2>& ffac__,
+                          std::vector<int> const& gvec_shell__, mdarray<double, 2>& forcek__) const
 {
     PROFILE("sirius::Force::ibs_force");
 
@@ -678,6 +724,16 @@ void Force::add_ibs_force(K_point* kp__, Hamiltonian_k& Hk__, mdarray<double, 2>
     mdarray<double_complex, 2> alm_col(kp__->num_gkvec_col(), uc.max_mt_aw_basis_size());
     mdarray<double_complex, 2> halm_col(kp__->num_gkvec_col(), uc.max_mt_aw_basis_size());
 
+    /* index of G-G' for the local block of the matrix; it is the same for all atoms */
+    mdarray<int, 2> ig12(kp__->num_gkvec_row(), kp__->num_gkvec_col());
+    for (int igk_col = 0; igk_col < kp__->num_gkvec_col(); igk_col++) {
+        auto gvec_col = kp__->gkvec().gvec(kp__->igk_col(igk_col));
+        for (int igk_row = 0; igk_row < kp__->num_gkvec_row(); igk_row++) {
+            auto gvec_row = kp__->gkvec().gvec(kp__->igk_row(igk_row));
+            ig12(igk_row, igk_col) = ctx_.gvec().index_g12(gvec_row, gvec_col);
+        }
+    }
+
     for (int ia = 0; ia < uc.num_atoms(); ia++) {
         h.zero();
         o.zero();
@@ -709,17 +765,15 @@ void Force::add_ibs_force(K_point* kp__, Hamiltonian_k& Hk__, mdarray<double, 2>
         int iat = type.id();
 
         for (int igk_col = 0; igk_col < kp__->num_gkvec_col(); igk_col++) { // loop over columns
-            auto gvec_col       = kp__->gkvec().gvec(kp__->igk_col(igk_col));
             auto gkvec_col_cart = kp__->gkvec().gkvec_cart<index_domain_t::global>(kp__->igk_col(igk_col));
             for (int igk_row = 0; igk_row < kp__->num_gkvec_row(); igk_row++) { // for each column loop over rows
-                auto gvec_row       = kp__->gkvec().gvec(kp__->igk_row(igk_row));
                 auto gkvec_row_cart = kp__->gkvec().gkvec_cart<index_domain_t::global>(kp__->igk_row(igk_row));
 
-                int ig12 = ctx_.gvec().index_g12(gvec_row, gvec_col);
+                int ig = ig12(igk_row, igk_col);
 
-                int igs = ctx_.gvec().shell(ig12);
+                int igs = gvec_shell__[ig];
 
-                auto zt = std::conj(ctx_.gvec_phase_factor(ig12, ia)) * ffac__(iat, igs) * fourpi / uc.omega();
+                auto zt = std::conj(ctx_.gvec_phase_factor(ig, ia)) * ffac__(iat, igs) * fourpi / uc.omega();
 
                 double t1 = 0.5 * dot(gkvec_row_cart, gkvec_col_cart);
 
@@ -730,13 +784,9 @@ void Force::add_ibs_force(K_point* kp__, Hamiltonian_k& Hk__, mdarray<double, 2>
 
         for (int x = 0; x < 3; x++) {
             for (int igk_col = 0; igk_col < kp__->num_gkvec_col(); igk_col++) { // loop over columns
-                auto gvec_col = kp__->gkvec().gvec(kp__->igk_col(igk_col));
                 for (int igk_row = 0; igk_row < kp__->num_gkvec_row(); igk_row++) { // loop over rows
-                    auto gvec_row = kp__->gkvec().gvec(kp__->igk_row(igk_row));
-                    /* compute index of G-G' */
-                    int ig12 = ctx_.gvec().index_g12(gvec_row, gvec_col);
                     /* get G-G' */
-                    auto vg = ctx_.gvec().gvec_cart<index_domain_t::global>(ig12);
+                    auto vg = ctx_.gvec().gvec_cart<index_domain_t::global>(ig12(igk_row, igk_col));
                     /* multiply by i(G-G') */
                     h1(igk_row, igk_col) = double_complex(0.0, vg[x]) * h(igk_row, igk_col);
                     /* multiply by i(G-G') */
@@ -852,11 +902,16 @@ mdarray<double, 2> const& Force::calc_forces_nonloc()
         }
     }
 
+    finalize_forces_nonloc();
+
+    return forces_nonloc_;
+}
+
+void Force::finalize_forces_nonloc()
+{
     ctx_.comm().allreduce(&forces_nonloc_(0, 0), 3 * ctx_.unit_cell().num_atoms());
 
     symmetrize(forces_nonloc_);
-
-    return forces_nonloc_;
 }
 
 void Force::print_info()
@@ -77,6 +77,12 @@ class Force
 
     void symmetrize(sddk::mdarray<double, 2>& forces__) const;
 
+    /// Reduce the non-local forces summed over the local k-points and symmetrize them.
+    void finalize_forces_nonloc();
+
+    /// Compute all remaining pseudopotential contributions and sum them with the non-local forces.
+    void calc_forces_total_pp();
+
     /** In the second-variational approach we need to compute the following expression for the k-dependent
      *  contribution to the forces:
      *  \f[
@@ -98,7 +104,10 @@ class Force
      */
     void hubbard_force_add_k_contribution_colinear(K_point& kp__, Q_operator& q_op__, sddk::mdarray<double, 2>& forceh_);
 
-    void add_ibs_force(K_point* kp__, Hamiltonian_k& Hk__, sddk::mdarray<double, 2>& ffac__, sddk::mdarray<double, 2>& forcek__) const;
+    /// Add k-point contribution to the IBS force.
+    /** \param [in] gvec_shell Shell index of all G-vectors; it is looked up for the G-G' differences. */
+    void add_ibs_force(K_point* kp__, Hamiltonian_k& Hk__, sddk::mdarray<double, 2>& ffac__,
+                       std::vector<int> const& gvec_shell__, sddk::mdarray<double, 2>& forcek__) const;
 
   public:
     Force(Simulation_context& ctx__, Density& density__, Potential& potential__, K_point_set& kset__);
@@ -177,6 +186,11 @@ class Force
 
     sddk::mdarray<double, 2> const& calc_forces_total();
 
+    /// Compute total forces with the non-local contribution already summed over the local k-points.
+    /** This is used when the non-local forces are computed together with the stress tensor
+     *  (see Stress::calc_stress_and_forces_total()). The array is moved into the object. */
+    sddk::mdarray<double, 2> const& calc_forces_total(sddk::mdarray<double, 2>& forces_nonloc__);
+
     inline sddk::mdarray<double, 2> const& forces_total() const
     {
         return forces_total_;
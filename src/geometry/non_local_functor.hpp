@@ -37,17 +37,31 @@ class Non_local_functor
 {
   private:
     Simulation_context& ctx_;
-    Beta_projectors_base& bp_base_;
+    /// Derivatives of beta-projectors (gradient or strain derivative) processed in a single pass.
+    std::vector<Beta_projectors_base*> bp_base_;
   public:
 
     Non_local_functor(Simulation_context& ctx__, Beta_projectors_base& bp_base__)
+        : ctx_(ctx__)
+        , bp_base_({&bp_base__})
+    {
+    }
+
+    /// Constructor for several sets of beta-projector derivatives sharing the <beta|psi> products.
+    Non_local_functor(Simulation_context& ctx__, std::vector<Beta_projectors_base*> bp_base__)
         : ctx_(ctx__)
         , bp_base_(bp_base__)
     {
     }
 
     /// Collect summation result in an array
-    void add_k_point_contribution(K_point& kpoint__, sddk::mdarray<double, 2>& collect_res__);
+    void add_k_point_contribution(K_point& kpoint__, sddk::mdarray<double, 2>& collect_res__)
+    {
+        add_k_point_contribution(kpoint__, std::vector<sddk::mdarray<double, 2>*>({&collect_res__}));
+    }
+
+    /// Collect summation result for each set of beta-projector derivatives in its own array.
+    void add_k_point_contribution(K_point& kpoint__, std::vector<sddk::mdarray<double, 2>*> collect_res__);
 };
 }
 
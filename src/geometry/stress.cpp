@@ -25,7 +25,9 @@
 #include "SDDK/geometry3d.hpp"
 #include "k_point/k_point.hpp"
 #include "stress.hpp"
+#include "force.hpp"
 #include "non_local_functor.hpp"
+#include "beta_projectors/beta_projectors_gradient.hpp"
 #include "utils/profiler.hpp"
 
 namespace sirius {
@@ -74,6 +76,13 @@ void Stress::calc_stress_nonloc_aux()
         }
     }
 
+    finalize_stress_nonloc(collect_result);
+}
+
+void Stress::finalize_stress_nonloc(mdarray<double, 2> const& collect_result__)
+{
+    stress_nonloc_.zero();
+
     #pragma omp parallel
     {
         matrix3d<double> tmp_stress; // TODO: test pragma omp parallel for reduction(+:stress)
@@ -82,7 +91,7 @@ void Stress::calc_stress_nonloc_aux()
         for (int ia = 0; ia < ctx_.unit_cell().num_atoms(); ia++) {
             for (int i = 0; i < 3; i++) {
                 for (int j = 0; j < 3; j++) {
-                    tmp_stress(i, j) -= collect_result(j * 3 + i, ia);
+                    tmp_stress(i, j) -= collect_result__(j * 3 + i, ia);
                 }
             }
         }
@@ -98,20 +107,99 @@ void Stress::calc_stress_nonloc_aux()
     symmetrize(stress_nonloc_);
 }
 
+template <typename T>
+void Stress::calc_stress_forces_nonloc_aux(mdarray<double, 2>& forces_nonloc__)
+{
+    PROFILE("sirius::Stress|nonloc_forces");
+
+    mdarray<double, 2> collect_result(9, ctx_.unit_cell().num_atoms());
+    collect_result.zero();
+
+    stress_kin_.zero();
+
+    for (int ikloc = 0; ikloc < kset_.spl_num_kpoints().local_size(); ikloc++) {
+        int ik  = kset_.spl_num_kpoints(ikloc);
+        auto kp = kset_[ik];
+
+        add_k_point_contribution_kin(*kp, stress_kin_);
+
+        /* if there are no beta projectors then there is nothing else to do */
+        if (ctx_.unit_cell().mt_lo_basis_size() == 0) {
+            continue;
+        }
+
+        if (is_device_memory(ctx_.preferred_memory_t())) {
+            int nbnd = ctx_.num_bands();
+            for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
+                /* allocate GPU memory */
+                kp->spinor_wave_functions().pw_coeffs(ispn).allocate(ctx_.mem_pool(memory_t::device));
+                kp->spinor_wave_functions().pw_coeffs(ispn).copy_to(memory_t::device, 0, nbnd);
+            }
+        }
+        Beta_projectors_gradient bp_grad(ctx_, kp->gkvec(), kp->igk_loc(), kp->beta_projectors());
+        Beta_projectors_strain_deriv bp_strain_deriv(ctx_, kp->gkvec(), kp->igk_loc());
+
+        Non_local_functor<T> nlf(ctx_, {&bp_grad, &bp_strain_deriv});
+
+        nlf.add_k_point_contribution(*kp, {&forces_nonloc__, &collect_result});
+
+        if (is_device_memory(ctx_.preferred_memory_t())) {
+            for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
+                /* deallocate GPU memory */
+                kp->spinor_wave_functions().pw_coeffs(ispn).deallocate(memory_t::device);
+            }
+        }
+    }
+
+    finalize_stress_kin();
+
+    finalize_stress_nonloc(collect_result);
+}
+
 template void Stress::calc_stress_nonloc_aux<double>();
 
 template void Stress::calc_stress_nonloc_aux<double_complex>();
 
+template void Stress::calc_stress_forces_nonloc_aux<double>(mdarray<double, 2>& forces_nonloc__);
+
+template void Stress::calc_stress_forces_nonloc_aux<double_complex>(mdarray<double, 2>& forces_nonloc__);
+
 matrix3d<double> Stress::calc_stress_total()
 {
     calc_stress_kin();
+    calc_stress_nonloc();
+    calc_stress_total_rest();
+
+    return stress_total_;
+}
+
+matrix3d<double> Stress::calc_stress_and_forces_total(Force& forces__)
+{
+    PROFILE("sirius::Stress::calc_stress_and_forces_total");
+
+    mdarray<double, 2> forces_nonloc(3, ctx_.unit_cell().num_atoms());
+    forces_nonloc.zero();
+
+    if (ctx_.gamma_point()) {
+        calc_stress_forces_nonloc_aux<double>(forces_nonloc);
+    } else {
+        calc_stress_forces_nonloc_aux<double_complex>(forces_nonloc);
+    }
+    calc_stress_total_rest();
+
+    forces__.calc_forces_total(forces_nonloc);
+
+    return stress_total_;
+}
+
+void Stress::calc_stress_total_rest()
+{
     calc_stress_har();
     calc_stress_ewald();
     calc_stress_vloc();
     calc_stress_core();
     calc_stress_xc();
     calc_stress_us();
-    calc_stress_nonloc();
     stress_hubbard_.zero();
     if (ctx_.hubbard_correction()) {
         calc_stress_hubbard();
@@ -125,7 +213,6 @@ matrix3d<double> Stress::calc_stress_total()
                                     stress_us_(mu, nu) + stress_nonloc_(mu, nu) + stress_hubbard_(mu, nu);
         }
     }
-    return stress_total_;
 }
 
 matrix3d<double> Stress::calc_stress_hubbard()
@@ -602,43 +689,47 @@ matrix3d<double> Stress::calc_stress_kin()
         int ik  = kset_.spl_num_kpoints(ikloc);
         auto kp = kset_[ik];
 
-        #pragma omp parallel
-        {
-            matrix3d<double> tmp;
-            #pragma omp for schedule(static)
-            for (int igloc = 0; igloc < kp->num_gkvec_loc(); igloc++) {
-                auto Gk = kp->gkvec().gkvec_cart<index_domain_t::local>(igloc);
-
-                double d{0};
-                for (int ispin = 0; ispin < ctx_.num_spins(); ispin++) {
-                    for (int i = 0; i < kp->num_occupied_bands(ispin); i++) {
-                        double f = kp->band_occupancy(i, ispin);
-                        auto z   = kp->spinor_wave_functions().pw_coeffs(ispin).prime(igloc, i);
-                        d += f * (std::pow(z.real(), 2) + std::pow(z.imag(), 2));
-                    }
-                }
-                d *= kp->weight();
-                if (kp->gkvec().reduced()) {
-                    d *= 2;
-                }
-                for (int mu : {0, 1, 2}) {
-                    for (int nu : {0, 1, 2}) {
-                        tmp(mu, nu) += Gk[mu] * Gk[nu] * d;
-                    }
-                }
-            } // igloc
-            #pragma omp critical
-            stress_kin_ += tmp;
-        }
+        add_k_point_contribution_kin(*kp, stress_kin_);
     } // ikloc
 
+    finalize_stress_kin();
+
+    return stress_kin_;
+}
+
+void Stress::add_k_point_contribution_kin(K_point& kp__, matrix3d<double>& stress__) const
+{
+    auto psi2 = kp__.band_weighted_pw_sumsqr();
+
+    #pragma omp parallel
+    {
+        matrix3d<double> tmp;
+        #pragma omp for schedule(static)
+        for (int igloc = 0; igloc < kp__.num_gkvec_loc(); igloc++) {
+            auto Gk = kp__.gkvec().gkvec_cart<index_domain_t::local>(igloc);
+
+            double d = psi2[igloc] * kp__.weight();
+            if (kp__.gkvec().reduced()) {
+                d *= 2;
+            }
+            for (int mu : {0, 1, 2}) {
+                for (int nu : {0, 1, 2}) {
+                    tmp(mu, nu) += Gk[mu] * Gk[nu] * d;
+                }
+            }
+        } // igloc
+        #pragma omp critical
+        stress__ += tmp;
+    }
+}
+
+void Stress::finalize_stress_kin()
+{
     ctx_.comm().allreduce(&stress_kin_(0, 0), 9);
 
     stress_kin_ *= (-1.0 / ctx_.unit_cell().omega());
 
     symmetrize(stress_kin_);
-
-    return stress_kin_;
 }
 
 void Stress::symmetrize(matrix3d<double>& mtrx__) const
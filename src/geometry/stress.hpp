@@ -29,6 +29,9 @@
 
 namespace sirius {
 
+/* forward declaration */
+class Force;
+
 /// Stress tensor.
 /** The following referenceces were particularly useful in the derivation of the stress tensor components:
  *    - Hutter, D. M. A. J. (2012). Ab Initio Molecular Dynamics (pp. 1–580).
@@ -216,6 +219,22 @@ class Stress
     template <typename T>
     void calc_stress_nonloc_aux();
 
+    /// Sum of the non-local contributions and of the non-local forces over local k-points in a single pass.
+    template <typename T>
+    void calc_stress_forces_nonloc_aux(sddk::mdarray<double, 2>& forces_nonloc__);
+
+    /// Add contribution of a k-point to the kinetic stress (before the reduction and normalization).
+    void add_k_point_contribution_kin(K_point& kp__, matrix3d<double>& stress__) const;
+
+    /// Reduce, normalize and symmetrize the kinetic contribution.
+    void finalize_stress_kin();
+
+    /// Convert the per-atom strain derivatives to the non-local stress; reduce, normalize and symmetrize it.
+    void finalize_stress_nonloc(sddk::mdarray<double, 2> const& collect_result__);
+
+    /// Compute the k-point independent contributions and sum all terms.
+    void calc_stress_total_rest();
+
     void symmetrize(matrix3d<double>& mtrx__) const;
 
   public:
@@ -477,6 +496,13 @@ class Stress
 
     matrix3d<double> calc_stress_total();
 
+    /// Compute total stress tensor and total atomic forces in a single pass over the k-points.
+    /** The kinetic and non-local contributions to the stress tensor and the non-local contribution to the
+     *  forces are accumulated in one loop over the local k-points. The <beta|psi> inner products and their
+     *  contraction with the D and Q matrices are computed once per chunk of atoms and shared between the
+     *  gradient and the strain derivatives of the beta-projectors. */
+    matrix3d<double> calc_stress_and_forces_total(Force& forces__);
+
     void print_info() const;
 };
 
@@ -130,15 +130,10 @@ Hamiltonian_k::get_h_o_diag_pw() const
                     &sddk::linalg_const<double_complex>::one(), &beta_gk_t(0, offs), beta_gk_t.ld(),
                     &d_sum(0, 0), d_sum.ld(), &sddk::linalg_const<double_complex>::zero(),
                     &beta_gk_tmp(0, 0), beta_gk_tmp.ld());
-                #pragma omp parallel
-                for (int xi = 0; xi < nbf; xi++) {
-                    #pragma omp for schedule(static) nowait
-                    for (int ig_loc = 0; ig_loc < kp_.num_gkvec_loc(); ig_loc++) {
-                        /* compute <G+k|beta_xi1> D_{xi1, xi2} <beta_xi2|G+k> contribution from all atoms */
-                        h_diag(ig_loc, ispn) +=
-                            std::real(beta_gk_tmp(ig_loc, xi) * std::conj(beta_gk_t(ig_loc, offs + xi)));
-                    }
-                }
+                /* compute <G+k|beta_xi1> D_{xi1, xi2} <beta_xi2|G+k> contribution from all atoms */
+                add_weighted_row_products(kp_.num_gkvec_loc(), nbf, beta_gk_tmp.at(memory_t::host), beta_gk_tmp.ld(),
+                                          beta_gk_t.at(memory_t::host, 0, offs), beta_gk_t.ld(), nullptr,
+                                          h_diag.at(memory_t::host, 0, ispn));
             }
 
             if (what & 2) {
@@ -146,15 +141,10 @@ Hamiltonian_k::get_h_o_diag_pw() const
                     &sddk::linalg_const<double_complex>::one(), &beta_gk_t(0, offs), beta_gk_t.ld(),
                     &q_sum(0, 0), q_sum.ld(), &sddk::linalg_const<double_complex>::zero(),
                     &beta_gk_tmp(0, 0), beta_gk_tmp.ld());
-                #pragma omp parallel
-                for (int xi = 0; xi < nbf; xi++) {
-                    #pragma omp for schedule(static) nowait
-                    for (int ig_loc = 0; ig_loc < kp_.num_gkvec_loc(); ig_loc++) {
-                        /* compute <G+k|beta_xi1> Q_{xi1, xi2} <beta_xi2|G+k> contribution from all atoms */
-                        o_diag(ig_loc, ispn) +=
-                            std::real(beta_gk_tmp(ig_loc, xi) * std::conj(beta_gk_t(ig_loc, offs + xi)));
-                    }
-                }
+                /* compute <G+k|beta_xi1> Q_{xi1, xi2} <beta_xi2|G+k> contribution from all atoms */
+                add_weighted_row_products(kp_.num_gkvec_loc(), nbf, beta_gk_tmp.at(memory_t::host), beta_gk_tmp.ld(),
+                                          beta_gk_t.at(memory_t::host, 0, offs), beta_gk_t.ld(), nullptr,
+                                          o_diag.at(memory_t::host, 0, ispn));
             }
             PROFILE_STOP("sirius::Hamiltonian_k::get_h_o_diag|3");
         }
@@ -295,7 +285,7 @@ Hamiltonian_k::set_fv_h_o(sddk::dmatrix<double_complex>& h__, sddk::dmatrix<doub
     /* alias to k-point */
     auto& kp = this->kp();
     /* split atoms in blocks */
-    int num_atoms_in_block = 2 * omp_get_max_threads();
+    int num_atoms_in_block = 2 * H0_.ctx().thread_policy().num_threads(utils::thread_stage_t::loops);
     int nblk = uc.num_atoms() / num_atoms_in_block + std::min(1, uc.num_atoms() % num_atoms_in_block);
     /* maximum number of apw coefficients in the block of atoms */
     int max_mt_aw = num_atoms_in_block * uc.max_mt_aw_basis_size();
@@ -766,9 +756,14 @@ void Hamiltonian_k::apply_h_s(spin_range spins__, int N__, int n__, Wave_functio
 
     double t1 = -omp_get_wtime();
 
+    /* D-operator is applied in real space together with the local part of Hamiltonian; the real-space
+     * projectors exist only if Simulation_context::beta_real_space() is true */
+    auto beta_rs = kp().beta_projectors_rs();
+
     if (hphi__ != nullptr) {
         /* apply local part of Hamiltonian */
-        H0().local_op().apply_h(kp().spfft_transform(), kp().gkvec_partition(), spins__, phi__, *hphi__, N__, n__);
+        H0().local_op().apply_h(kp().spfft_transform(), kp().gkvec_partition(), spins__, phi__, *hphi__, N__, n__,
+                                beta_rs, &H0().D());
     }
 
     t1 += omp_get_wtime();
@@ -801,7 +796,14 @@ void Hamiltonian_k::apply_h_s(spin_range spins__, int N__, int n__, Wave_functio
 
     /* return if there are no beta-projectors */
     if (H0().ctx().unit_cell().mt_lo_basis_size()) {
-        apply_non_local_d_q<T>(spins__, N__, n__, kp().beta_projectors(), phi__, &H0().D(), hphi__, &H0().Q(), sphi__);
+        if (beta_rs == nullptr) {
+            apply_non_local_d_q<T>(spins__, N__, n__, kp().beta_projectors(), phi__, &H0().D(), hphi__, &H0().Q(),
+                                   sphi__);
+        } else if (sphi__ != nullptr && H0().ctx().unit_cell().augment()) {
+            /* only the Q-operator is left */
+            apply_non_local_d_q<T>(spins__, N__, n__, kp().beta_projectors(), phi__, nullptr, nullptr, &H0().Q(),
+                                   sphi__);
+        }
     }
 
     /* apply the hubbard potential if relevant */
@@ -916,7 +918,7 @@ void Hamiltonian_k::apply_fv_h_o(bool apw_only__, bool phi_is_lo__, int N__, int
     int ngv = kp().num_gkvec_loc();
 
     /* split atoms in blocks */
-    int num_atoms_in_block = 2 * omp_get_max_threads();
+    int num_atoms_in_block = 2 * ctx.thread_policy().num_threads(utils::thread_stage_t::loops);
 
     /* number of blocks of atoms */
     int nblk = utils::num_blocks(ctx.unit_cell().num_atoms(), num_atoms_in_block);
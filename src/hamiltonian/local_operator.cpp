@@ -25,6 +25,7 @@
 #include "local_operator.hpp"
 #include "potential/potential.hpp"
 #include "function3d/smooth_periodic_function.hpp"
+#include "beta_projectors/beta_projectors_rs.hpp"
 #include "utils/profiler.hpp"
 
 using namespace sddk;
@@ -276,10 +277,17 @@ static inline void mul_by_veff(spfft::Transform& spfftk__, double* buff__,
 }
 
 void Local_operator::apply_h(spfft::Transform& spfftk__, Gvec_partition const& gkvec_p__, spin_range spins__,
-                             Wave_functions& phi__, Wave_functions& hphi__, int idx0__, int n__)
+                             Wave_functions& phi__, Wave_functions& hphi__, int idx0__, int n__,
+                             Beta_projectors_rs* beta_rs__, D_operator* d_op__)
 {
     PROFILE("sirius::Local_operator::apply_h");
 
+    utils::thread_guard tg(ctx_.thread_policy(), utils::thread_stage_t::fft);
+
+    if (beta_rs__ && (spins__() == 2 || spfftk__.processing_unit() != SPFFT_PU_HOST)) {
+        TERMINATE("real-space beta-projectors are implemented only for collinear case on CPU");
+    }
+
     if ((spfftk__.dim_x() != fft_coarse_.dim_x()) ||
         (spfftk__.dim_y() != fft_coarse_.dim_y()) ||
         (spfftk__.dim_z() != fft_coarse_.dim_z())) {
@@ -475,6 +483,54 @@ void Local_operator::apply_h(spfft::Transform& spfftk__, Gvec_partition const& g
     /* local number of wave-functions in extra-storage distribution */
     int num_wf_loc = phi__.pw_coeffs(0).spl_num_col().local_size();
 
+    /* number of double values in the local part of FFT buffer */
+    int nr_d = (spfftk__.type() == SPFFT_TRANS_R2C) ? nr : 2 * nr;
+
+    /* With the distributed coarse FFT grid <beta|phi> has to be summed over the slabs; the real-space wave-functions
+       of the whole block are then stored, so that the projections of the block are reduced at once. */
+    bool beta_rs_block = beta_rs__ && ctx_.comm_fft_coarse().size() > 1;
+
+    /* <beta|phi> in case of real-space beta-projectors */
+    mdarray<double_complex, 2> beta_phi;
+    /* real-space wave-functions of the block */
+    mdarray<double, 2> phi_r;
+    if (beta_rs__) {
+        beta_phi = mdarray<double_complex, 2>(ctx_.unit_cell().mt_lo_basis_size(),
+                                              beta_rs_block ? std::max(1, num_wf_loc) : 1, mp);
+    }
+
+    /* compute <beta|phi> from n real-space wave-functions with the leading dimension ld */
+    auto beta_phi_rg = [&](int n, double const* psi_r, int ld) {
+        if (spfftk__.type() == SPFFT_TRANS_R2C) {
+            beta_rs__->inner(n, psi_r, ld, beta_phi);
+        } else {
+            beta_rs__->inner(n, reinterpret_cast<double_complex const*>(psi_r), ld / 2, beta_phi);
+        }
+    };
+
+    /* add |beta>D<beta|phi> to V(r)phi(r) stored in the FFT buffer */
+    auto add_beta_d_rg = [&](int ispn, int j) {
+        mdarray<double_complex, 1> beta_phi1(beta_phi.at(memory_t::host, 0, j), beta_phi.size(0));
+        beta_rs__->mul_by_d(ispn, *d_op__, beta_phi1);
+        if (spfftk__.type() == SPFFT_TRANS_R2C) {
+            beta_rs__->add(beta_phi1, spfft_buf);
+        } else {
+            beta_rs__->add(beta_phi1, reinterpret_cast<double_complex*>(spfft_buf));
+        }
+    };
+
+    /* all ranks of the coarse FFT communicator store the same wave-functions */
+    if (beta_rs_block && num_wf_loc) {
+        phi_r = mdarray<double, 2>(nr_d, num_wf_loc, mp);
+        for (int i = 0; i < num_wf_loc; i++) {
+            prepare_phi_hphi(i);
+            /* phi(G) -> phi(r) */
+            phi_to_r(spins__());
+            std::copy(spfft_buf, spfft_buf + nr_d, phi_r.at(memory_t::host, 0, i));
+        }
+        beta_phi_rg(num_wf_loc, phi_r.at(memory_t::host), nr_d);
+    }
+
     /* if we don't have G-vector reductions, first = 0 and we start a normal loop */
     for (int i = 0; i < num_wf_loc; i++) {
 
@@ -588,10 +644,21 @@ void Local_operator::apply_h(spfft::Transform& spfftk__, Gvec_partition const& g
             store_hphi(i);
         } else { /* spin-collinear or non-magnetic case */
             prepare_phi_hphi(i);
-            /* phi(G) -> phi(r) */
-            phi_to_r(spins__());
+            if (beta_rs_block) {
+                /* phi(r) is already computed */
+                std::copy(phi_r.at(memory_t::host, 0, i), phi_r.at(memory_t::host, 0, i) + nr_d, spfft_buf);
+            } else {
+                /* phi(G) -> phi(r) */
+                phi_to_r(spins__());
+                if (beta_rs__) {
+                    beta_phi_rg(1, spfft_buf, nr_d);
+                }
+            }
             /* multiply by effective potential */
             mul_by_veff(spfftk__, spfft_buf, veff_vec_, spins__());
+            if (beta_rs__) {
+                add_beta_d_rg(spins__(), beta_rs_block ? i : 0);
+            }
             /* V(r)phi(r) -> [V*phi](G) */
             vphi_to_G();
             /* add kinetic energy */
@@ -616,6 +683,8 @@ void Local_operator::apply_h_o(spfft::Transform& spfftk__, Gvec_partition const&
 {
     PROFILE("sirius::Local_operator::apply_h_o");
 
+    utils::thread_guard tg(ctx_.thread_policy(), utils::thread_stage_t::fft);
+
     ctx_.num_loc_op_applied(n__);
 
     mdarray<double_complex, 1> buf_pw(gkvec_p__.gvec_count_fft(), ctx_.mem_pool(memory_t::host));
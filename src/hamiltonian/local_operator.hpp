@@ -33,6 +33,8 @@
 namespace sirius {
 class Potential;
 class Simulation_context;
+class Beta_projectors_rs;
+class D_operator;
 template <typename T>
 class Smooth_periodic_function;
 }
@@ -136,16 +138,22 @@ class Local_operator
      *  \param [out] hphi    Local hamiltonian applied to wave-function.
      *  \param [in]  idx0    Starting index of wave-functions.
      *  \param [in]  n       Number of wave-functions to which H is applied.
+     *  \param [in]  beta_rs Optional real-space beta-projectors.
+     *  \param [in]  d_op    Optional D-operator which is applied together with real-space beta-projectors.
      *
      *  Spin range can take the following values:
      *    - [0, 0]: apply H_{uu} to the up- component of wave-functions
      *    - [1, 1]: apply H_{dd} to the dn- component of wave-functions
      *    - [0, 1]: apply full Hamiltonian to the spinor wave-functions
      *
-     *  Local Hamiltonian includes kinetic term and local part of potential.
+     *  Local Hamiltonian includes kinetic term and local part of potential. If real-space beta-projectors and
+     *  D-operator are provided, the non-local term \f$ \sum_{\xi \xi'} |\beta_{\xi} \rangle D_{\xi \xi'}
+     *  \langle \beta_{\xi'} | \psi \rangle \f$ is added to \f$ V({\bf r}) \psi({\bf r}) \f$ before the forward
+     *  transformation (spin-collinear case only).
      */
     void apply_h(spfft::Transform& spfftk__, sddk::Gvec_partition const& gkvec_p__, sddk::spin_range spins__,
-                 sddk::Wave_functions& phi__, sddk::Wave_functions& hphi__, int idx0__, int n__);
+                 sddk::Wave_functions& phi__, sddk::Wave_functions& hphi__, int idx0__, int n__,
+                 Beta_projectors_rs* beta_rs__ = nullptr, D_operator* d_op__ = nullptr);
 
     /// Apply local part of LAPW Hamiltonian and overlap operators.
     /** \param [in]  spfftk  SpFFT transform object for G+k vectors.
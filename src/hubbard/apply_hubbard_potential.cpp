@@ -32,13 +32,14 @@ namespace sirius {
 void Hubbard::apply_hubbard_potential(Wave_functions& hub_wf, const int ispn__, const int idx__, const int n__,
                                       Wave_functions& phi, Wave_functions& hphi)
 {
-    //auto& hub_wf = kp__.hubbard_wave_functions();
+    PROFILE("sirius::Hubbard::apply_hubbard_potential");
 
-    dmatrix<double_complex> dm(this->number_of_hubbard_orbitals(), n__);
-    dm.zero();
+    auto& mp = ctx_.mem_pool(memory_t::host);
+
+    dmatrix<double_complex> dm(this->number_of_hubbard_orbitals(), n__, mp, "dm");
 
     if (ctx_.processing_unit() == device_t::GPU) {
-        dm.allocate(memory_t::device);
+        dm.allocate(ctx_.mem_pool(memory_t::device));
     }
 
     /* First calculate the local part of the projections
@@ -55,55 +56,34 @@ void Hubbard::apply_hubbard_potential(Wave_functions& hub_wf, const int ispn__,
           0,
           0);
 
-    // this should be taken care by inner() itself
-    //if (ctx_.processing_unit() == GPU) {
-    //    dm.copy_to(memory_t::host);
-    //}
-
-    dmatrix<double_complex> Up(this->number_of_hubbard_orbitals(), n__);
+    dmatrix<double_complex> Up(this->number_of_hubbard_orbitals(), n__, mp, "Up");
     Up.zero();
 
+    if (!hubbard_potential_blocks_.size()) {
+        generate_potential_blocks();
+    }
+
+    /* U operator is block-diagonal in the basis of hubbard orbitals; in the non-collinear case a single block
+       couples both spins of an atom (for the SO case we rely on QE for the formula) */
+    int isb = (ctx_.num_mag_dims() == 3) ? 0 : ispn__;
+    int ns  = (ctx_.num_mag_dims() == 3) ? 2 : 1;
+
     #pragma omp parallel for schedule(static)
     for (int ia = 0; ia < ctx_.unit_cell().num_atoms(); ++ia) {
         const auto& atom = ctx_.unit_cell().atom(ia);
         if (atom.type().hubbard_correction()) {
-            const int lmax_at = 2 * atom.type().hubbard_orbital(0).l + 1;
-            // we apply the hubbard correction. For now I have no papers
-            // giving me the formula for the SO case so I rely on QE for it
-            // but I do not like it at all
-            if (ctx_.num_mag_dims() == 3) {
-                for (int s1 = 0; s1 < ctx_.num_spins(); s1++) {
-                    for (int s2 = 0; s2 < ctx_.num_spins(); s2++) {
-                        const int ind = (s1 == s2) * s1 + (1 + 2 * s2 + s1) * (s1 != s2);
-
-                        // !!! Replace this with matrix matrix multiplication
-
-                        for (int nbd = 0; nbd < n__; nbd++) {
-                            for (int m1 = 0; m1 < lmax_at; m1++) {
-                                for (int m2 = 0; m2 < lmax_at; m2++) {
-                                    Up(this->offset_[ia] + s1 * lmax_at + m1, nbd) += this->hubbard_potential_(m2, m1, ind, ia) *
-                                        dm(this->offset_[ia] + s2 * lmax_at + m2, nbd);
-                                }
-                            }
-                        }
-                    }
-                }
-            } else {
-                // Conventional LDA or colinear magnetism
-                for (int nbd = 0; nbd < n__; nbd++) {
-                    for (int m1 = 0; m1 < lmax_at; m1++) {
-                        for (int m2 = 0; m2 < lmax_at; m2++) {
-                            Up(this->offset_[ia] + m1, nbd) += this->hubbard_potential_(m2, m1, ispn__, ia) *
-                                dm(this->offset_[ia] + m2, nbd);
-                        }
-                    }
-                }
-            }
+            const int nb = ns * (2 * atom.type().hubbard_orbital(0).l + 1);
+            linalg(linalg_t::blas).gemm('N', 'N', nb, n__, nb, &linalg_const<double_complex>::one(),
+                                        hubbard_potential_blocks_.at(memory_t::host, 0, 0, isb, ia),
+                                        hubbard_potential_blocks_.ld(),
+                                        dm.at(memory_t::host, this->offset_[ia], 0), dm.ld(),
+                                        &linalg_const<double_complex>::zero(),
+                                        Up.at(memory_t::host, this->offset_[ia], 0), Up.ld());
         }
     }
 
     if (ctx_.processing_unit() == device_t::GPU) {
-        Up.allocate(memory_t::device);
+        Up.allocate(ctx_.mem_pool(memory_t::device));
         Up.copy_to(memory_t::device);
     }
 
@@ -62,6 +62,11 @@ class Hubbard
 
     mdarray<double_complex, 4> hubbard_potential_;
 
+    /// Hubbard potential stored as a block-diagonal operator in the basis of hubbard orbitals.
+    /** One dense block per atom and per spin block; in the non-collinear case both spins of an atom are kept in
+     *  a single block of size 2(2l+1). */
+    mdarray<double_complex, 4> hubbard_potential_blocks_;
+
     /// Type of hubbard correction to be considered.
     /** True if we consider a simple hubbard correction. Not valid if spin orbit coupling is included */
     bool approximation_{false};
@@ -85,13 +90,25 @@ class Hubbard
     /// file containing the hubbard wave functions
     std::string wave_function_file_;
 
-    void compute_occupancies(K_point&                    kp,
-                             dmatrix<double_complex>&    phi_s_psi,
-                             dmatrix<double_complex>&    dphi_s_psi,
-                             Wave_functions&             dphi,
-                             mdarray<double_complex, 5>& dn_,
-                             matrix<double_complex>&     dm,
-                             const int                   index);
+    /// Compute <psi|S d phi> for n wave-functions and include band occupancies.
+    /** The result for spin ispn is stored in the columns [ispn * n, (ispn + 1) * n) of dphi_s_psi. */
+    void compute_dphi_s_psi(K_point& kp, Wave_functions& dphi, int n, dmatrix<double_complex>& dphi_s_psi);
+
+    /// Compute the diagonal block of the occupancy matrix derivative for a single hubbard atom.
+    /** \param [in]  kp          K-point.
+     *  \param [in]  phi_s_psi   Overlap <psi|S phi> for all hubbard orbitals.
+     *  \param [in]  dphi_s_psi  Occupancy-weighted <psi|S d phi> computed by compute_dphi_s_psi().
+     *  \param [in]  n           Number of columns of dphi_s_psi per spin.
+     *  \param [in]  idx         Column of the first derivative orbital of the atom inside the spin block.
+     *  \param [in]  ia          Index of atom.
+     *  \param [out] dn          Block dn(m1, m2, ispn) of the derivative with leading dimension ld.
+     */
+    void compute_occupancies_block(K_point& kp, dmatrix<double_complex>& phi_s_psi,
+                                   dmatrix<double_complex>& dphi_s_psi, int n, int idx, int ia, double_complex* dn,
+                                   int ld);
+
+    /// Pack hubbard_potential_ into the blocks used by apply_hubbard_potential().
+    void generate_potential_blocks();
 
     void symmetrize_occupancy_matrix_noncolinear_case();
     void symmetrize_occupancy_matrix(sddk::mdarray<double_complex, 4>& om__);
@@ -189,6 +206,7 @@ class Hubbard
         } else {
             calculate_hubbard_potential_and_energy_non_colinear_case(om__);
         }
+        generate_potential_blocks();
     }
 
     inline double hubbard_energy() const
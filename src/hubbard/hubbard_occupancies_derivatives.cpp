@@ -38,6 +38,8 @@ Hubbard::compute_occupancies_derivatives(K_point& kp,
                                          Q_operator& q_op, // overlap operator
                                          mdarray<double_complex, 6>& dn__)  // Atom we shift
 {
+    PROFILE("sirius::Hubbard::compute_occupancies_derivatives");
+
     dn__.zero();
     // check if we have a norm conserving pseudo potential only. OOnly
     // derivatives of the hubbard wave functions are needed.
@@ -71,12 +73,23 @@ Hubbard::compute_occupancies_derivatives(K_point& kp,
 
       - the atom is ppus (in that case the derivative the beta projectors
       compared to the atomic displacements gives a non zero contribution)
+
+      A displacement of atom J changes only the hubbard orbitals of atom J and the beta-projectors of atom J.
+      For norm conserving pseudo potentials the derivative of S|phi> is therefore non zero only in the block of
+      orbitals of atom J and so is the derivative of the occupancy matrix. With augmentation the d S/ dr^J term
+      touches all orbitals, but only the diagonal atomic blocks of the occupancy matrix are needed.
+
+      The derivatives for the three directions are stored side by side in dphi, each direction taking ncol
+      columns, and are processed by a single inner product.
     */
 
+    /* number of columns of dphi for each direction */
+    int ncol = augment ? this->number_of_hubbard_orbitals() : max_number_of_orbitals_per_atom();
+
     /* temporary wave functions */
-    Wave_functions dphi(kp.gkvec_partition(), this->number_of_hubbard_orbitals(), ctx_.preferred_memory_t(), 1);
+    Wave_functions dphi(kp.gkvec_partition(), 3 * ncol, ctx_.preferred_memory_t(), 1);
     /* temporary wave functions */
-    Wave_functions phitmp(kp.gkvec_partition(), this->number_of_hubbard_orbitals(), ctx_.preferred_memory_t(), 1);
+    Wave_functions phitmp(kp.gkvec_partition(), 3 * ncol, ctx_.preferred_memory_t(), 1);
 
     int HowManyBands = kp.num_occupied_bands(0);
     if (ctx_.num_spins() == 2) {
@@ -86,24 +99,10 @@ Hubbard::compute_occupancies_derivatives(K_point& kp,
       d_phitmp contains the derivatives of the hubbard wave functions
       corresponding to the displacement r^I_a.
     */
-    dmatrix<double_complex> dphi_s_psi(HowManyBands, this->number_of_hubbard_orbitals() * ctx_.num_spins());
+    dmatrix<double_complex> dphi_s_psi(HowManyBands, 3 * ncol * ctx_.num_spins());
     dmatrix<double_complex> phi_s_psi(HowManyBands, this->number_of_hubbard_orbitals() * ctx_.num_spins());
-    matrix<double_complex>  dm(this->number_of_hubbard_orbitals() * ctx_.num_spins(),
-                               this->number_of_hubbard_orbitals() * ctx_.num_spins());
-    mdarray<double_complex, 5> dn_tmp(max_number_of_orbitals_per_atom(),
-                                      max_number_of_orbitals_per_atom(),
-                                      ctx_.num_spins(),
-                                      ctx_.unit_cell().num_atoms(),
-                                      3);
 
     if (ctx_.processing_unit() == device_t::GPU) {
-        dm.allocate(memory_t::device);
-        dn_tmp.allocate(memory_t::device);
-
-        /* allocation of the overlap matrices on GPU */
-        phi_s_psi.allocate(memory_t::device);
-        dphi_s_psi.allocate(memory_t::device);
-
         /* wave functions */
         phitmp.allocate(spin_range(0), memory_t::device);
         phi.allocate(spin_range(0), memory_t::device);
@@ -114,99 +113,117 @@ Hubbard::compute_occupancies_derivatives(K_point& kp,
             kp.spinor_wave_functions().copy_to(spin_range(ispn), memory_t::device, 0, kp.num_occupied_bands(ispn));
         }
     }
-    phi_s_psi.zero(memory_t::host);
-    phi_s_psi.zero(memory_t::device);
+    phi_s_psi.zero();
 
-    sirius::apply_S_operator<double_complex>(ctx_.processing_unit(), spin_range(0), 0, this->number_of_hubbard_orbitals(),
-                             kp.beta_projectors(), phi, &q_op, dphi);
+    {
+        Wave_functions sphi(kp.gkvec_partition(), this->number_of_hubbard_orbitals(), ctx_.preferred_memory_t(), 1);
+        if (ctx_.processing_unit() == device_t::GPU) {
+            sphi.allocate(spin_range(0), memory_t::device);
+        }
+        sirius::apply_S_operator<double_complex>(ctx_.processing_unit(), spin_range(0), 0,
+                                                 this->number_of_hubbard_orbitals(), kp.beta_projectors(), phi, &q_op,
+                                                 sphi);
 
-    /* compute <phi^I_m| S | psi_{nk}> */
-    for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
-        inner(ctx_.spla_context(), ispn, kp.spinor_wave_functions(), 0, kp.num_occupied_bands(ispn), dphi, 0,
-              this->number_of_hubbard_orbitals(), phi_s_psi, 0, ispn * this->number_of_hubbard_orbitals());
+        /* compute <phi^I_m| S | psi_{nk}> */
+        for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
+            inner(ctx_.spla_context(), ispn, kp.spinor_wave_functions(), 0, kp.num_occupied_bands(ispn), sphi, 0,
+                  this->number_of_hubbard_orbitals(), phi_s_psi, 0, ispn * this->number_of_hubbard_orbitals());
+        }
     }
 
+    /* location of each atom in the chunks of beta-projectors */
+    std::vector<std::pair<int, int>> atom_chunk(ctx_.unit_cell().num_atoms(), std::make_pair(-1, -1));
+    for (int ichunk = 0; ichunk < kp.beta_projectors().num_chunks(); ichunk++) {
+        for (int i = 0; i < kp.beta_projectors().chunk(ichunk).num_atoms_; i++) {
+            int ia = kp.beta_projectors().chunk(ichunk).desc_(static_cast<int>(beta_desc_idx::ia), i);
+            atom_chunk[ia] = std::make_pair(ichunk, i);
+        }
+    }
 
     for (int atom_id = 0; atom_id < ctx_.unit_cell().num_atoms(); atom_id++) {
-        dn_tmp.zero(memory_t::host);
-        dn_tmp.zero(memory_t::device);
-        for (int dir = 0; dir < 3; dir++) {
-            // reset dphi
-            dphi.pw_coeffs(0).prime().zero(memory_t::host);
-            dphi.pw_coeffs(0).prime().zero(memory_t::device);
-
-            if (ctx_.unit_cell().atom(atom_id).type().hubbard_correction()) {
-                // atom atom_id has hubbard correction so we need to compute the
-                // derivatives of the hubbard orbitals associated to the atom
-                // atom_id, the derivatives of the others hubbard orbitals been
-                // zero compared to the displacement of atom atom_id
-
-                // compute the derivative of |phi> corresponding to the
-                // atom atom_id
-                const int lmax_at = 2 * ctx_.unit_cell().atom(atom_id).type().hubbard_orbital(0).l + 1;
+        bool hub = ctx_.unit_cell().atom(atom_id).type().hubbard_correction();
+        /* nothing changes in the occupancy matrix */
+        if (!hub && !augment) {
+            continue;
+        }
 
+        // reset dphi
+        dphi.pw_coeffs(0).prime().zero(memory_t::host);
+        dphi.pw_coeffs(0).prime().zero(memory_t::device);
+
+        /* offset of the orbitals of atom_id inside the block of columns of one direction */
+        int ofs = augment ? this->offset_[atom_id] : 0;
+
+        if (hub) {
+            // atom atom_id has hubbard correction so we need to compute the
+            // derivatives of the hubbard orbitals associated to the atom
+            // atom_id, the derivatives of the others hubbard orbitals been
+            // zero compared to the displacement of atom atom_id
+            const int lmax_at = 2 * ctx_.unit_cell().atom(atom_id).type().hubbard_orbital(0).l + 1;
+
+            for (int dir = 0; dir < 3; dir++) {
                 // compute the derivatives of the hubbard wave functions
                 // |phi_m^J> (J = atom_id) compared to a displacement of atom J.
-
-                kp.compute_gradient_wave_functions(phi, this->offset_[atom_id], lmax_at, phitmp, this->offset_[atom_id], dir);
+                kp.compute_gradient_wave_functions(phi, this->offset_[atom_id], lmax_at, phitmp, dir * ncol + ofs, dir);
 
                 if (ctx_.processing_unit() == device_t::GPU) {
-                    phitmp.copy_to(spin_range(0), memory_t::device, 0, this->number_of_hubbard_orbitals());
+                    phitmp.copy_to(spin_range(0), memory_t::device, dir * ncol + ofs, lmax_at);
                 }
 
                 /* for norm conserving pp, it is enough to have the derivatives of |phi^J_m> (J = atom_id) */
-                sirius::apply_S_operator<double_complex>(ctx_.processing_unit(), spin_range(0), 0,
-                                                         this->number_of_hubbard_orbitals(), kp.beta_projectors(),
-                                                         phitmp, &q_op, dphi);
+                sirius::apply_S_operator<double_complex>(ctx_.processing_unit(), spin_range(0), dir * ncol + ofs,
+                                                         lmax_at, kp.beta_projectors(), phitmp,
+                                                         augment ? &q_op : nullptr, dphi);
             }
+        }
 
-            // compute d S/ dr^I_a |phi> and add to dphi
-            if (!ctx_.full_potential() && augment) {
-                // it is equal to
-                // \sum Q^I_ij <d \beta^I_i|phi> |\beta^I_j> + < \beta^I_i|phi> |d\beta^I_j>
-                for (int chunk__ = 0; chunk__ < kp.beta_projectors().num_chunks(); chunk__++) {
-                    for (int i = 0; i < kp.beta_projectors().chunk(chunk__).num_atoms_; i++) {
-                        // need to find the right atom in the chunks.
-                        if (kp.beta_projectors().chunk(chunk__).desc_(static_cast<int>(beta_desc_idx::ia), i) == atom_id) {
-                            kp.beta_projectors().generate(chunk__);
-                            bp_grad.generate(chunk__, dir);
-
-                            // compute Q_ij <\beta_i|\phi> |d \beta_j> and add it to d\phi
-                            {
-                                /* <beta | phi> for this chunk */
-                                auto beta_phi = kp.beta_projectors().inner<double_complex>(chunk__, phi, 0, 0,
-                                                                                           this->number_of_hubbard_orbitals());
-                                q_op.apply(chunk__, i, 0, dphi, 0, this->number_of_hubbard_orbitals(), bp_grad, beta_phi);
-                            }
-
-                            // compute Q_ij <d \beta_i|\phi> |\beta_j> and add it to d\phi
-                            {
-                                /* <dbeta | phi> for this chunk */
-                                auto dbeta_phi = bp_grad.inner<double_complex>(chunk__, phi, 0, 0,
-                                                                                this->number_of_hubbard_orbitals());
-
-                                /* apply Q operator (diagonal in spin) */
-                                /* Effectively compute Q_ij <d beta_i| phi> |beta_j> and add it dphi */
-                                q_op.apply(chunk__, i, 0, dphi, 0, this->number_of_hubbard_orbitals(),
-                                           kp.beta_projectors(), dbeta_phi);
-                            }
-                        }
-                    }
+        // compute d S/ dr^I_a |phi> and add to dphi
+        if (!ctx_.full_potential() && augment && atom_chunk[atom_id].first >= 0) {
+            // it is equal to
+            // \sum Q^I_ij <d \beta^I_i|phi> |\beta^I_j> + < \beta^I_i|phi> |d\beta^I_j>
+            // only the chunk of beta-projectors containing atom_id is needed
+            int ichunk = atom_chunk[atom_id].first;
+            int i      = atom_chunk[atom_id].second;
+
+            kp.beta_projectors().generate(ichunk);
+            /* <beta | phi> for this chunk; it does not depend on the direction */
+            auto beta_phi = kp.beta_projectors().inner<double_complex>(ichunk, phi, 0, 0,
+                                                                       this->number_of_hubbard_orbitals());
+            for (int dir = 0; dir < 3; dir++) {
+                bp_grad.generate(ichunk, dir);
+
+                // compute Q_ij <\beta_i|\phi> |d \beta_j> and add it to d\phi
+                q_op.apply(ichunk, i, 0, dphi, dir * ncol, this->number_of_hubbard_orbitals(), bp_grad, beta_phi);
+
+                // compute Q_ij <d \beta_i|\phi> |\beta_j> and add it to d\phi
+                {
+                    /* <dbeta | phi> for this chunk */
+                    auto dbeta_phi = bp_grad.inner<double_complex>(ichunk, phi, 0, 0,
+                                                                    this->number_of_hubbard_orbitals());
+
+                    /* apply Q operator (diagonal in spin) */
+                    /* Effectively compute Q_ij <d beta_i| phi> |beta_j> and add it dphi */
+                    q_op.apply(ichunk, i, 0, dphi, dir * ncol, this->number_of_hubbard_orbitals(),
+                               kp.beta_projectors(), dbeta_phi);
                 }
             }
+        }
+
+        /* <psi | d(S|phi>) for all three directions at once */
+        compute_dphi_s_psi(kp, dphi, 3 * ncol, dphi_s_psi);
 
-            compute_occupancies(kp,
-                                phi_s_psi,
-                                dphi_s_psi,
-                                dphi,
-                                dn_tmp,
-                                dm, // temporary table
-                                dir);
-        } // direction x, y, z
-
-        /* use a memcpy here */
-        std::memcpy(dn__.at(memory_t::host, 0, 0, 0, 0, 0, atom_id), dn_tmp.at(memory_t::host),
-                    sizeof(double_complex) * dn_tmp.size());
+        #pragma omp parallel for schedule(static)
+        for (int ia1 = 0; ia1 < ctx_.unit_cell().num_atoms(); ia1++) {
+            if (!ctx_.unit_cell().atom(ia1).type().hubbard_correction() || (!augment && ia1 != atom_id)) {
+                continue;
+            }
+            for (int dir = 0; dir < 3; dir++) {
+                compute_occupancies_block(kp, phi_s_psi, dphi_s_psi, 3 * ncol,
+                                          dir * ncol + (augment ? this->offset_[ia1] : 0), ia1,
+                                          dn__.at(memory_t::host, 0, 0, 0, ia1, dir, atom_id),
+                                          static_cast<int>(dn__.size(0)));
+            }
+        }
     } // atom_id
 
     if (ctx_.processing_unit() == device_t::GPU) {
@@ -227,9 +244,6 @@ Hubbard::compute_occupancies_stress_derivatives(K_point&                    kp__
 
     Beta_projectors_strain_deriv bp_strain_deriv(ctx_, kp__.gkvec(), kp__.igk_loc());
 
-    dmatrix<double_complex> dm(this->number_of_hubbard_orbitals() * ctx_.num_spins(),
-                               this->number_of_hubbard_orbitals() * ctx_.num_spins());
-
     // maximum number of occupied bands
     int HowManyBands = kp__.num_occupied_bands(0);
     if (ctx_.num_spins() == 2) {
@@ -271,10 +285,6 @@ Hubbard::compute_occupancies_stress_derivatives(K_point&                    kp__
     }
 
     if (ctx_.processing_unit() == device_t::GPU) {
-        dm.allocate(memory_t::device);
-        phi_s_psi.allocate(memory_t::device);
-        dphi_s_psi.allocate(memory_t::device);
-
         phi.allocate(spin_range(0), memory_t::device);
         phi.copy_to(spin_range(0), memory_t::device, 0, this->number_of_hubbard_orbitals());
 
@@ -291,8 +301,7 @@ Hubbard::compute_occupancies_stress_derivatives(K_point&                    kp__
     sirius::apply_S_operator<double_complex>(ctx_.processing_unit(), spin_range(0), 0, this->number_of_hubbard_orbitals(),
                              kp__.beta_projectors(), phi, &q_op__, dphi);
 
-    phi_s_psi.zero(memory_t::host);
-    phi_s_psi.zero(memory_t::device);
+    phi_s_psi.zero();
 
     /* compute <phi^I_m| S | psi_{nk}> */
     for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
@@ -376,13 +385,18 @@ Hubbard::compute_occupancies_stress_derivatives(K_point&                    kp__
                 }
             }
 
-            compute_occupancies(kp__,
-                                phi_s_psi,
-                                dphi_s_psi,
-                                dphi,
-                                dn__,
-                                dm,
-                                3 * nu + mu);
+            compute_dphi_s_psi(kp__, dphi, this->number_of_hubbard_orbitals(), dphi_s_psi);
+
+            /* only the diagonal atomic blocks of the occupancy matrix are needed */
+            #pragma omp parallel for schedule(static)
+            for (int ia1 = 0; ia1 < ctx_.unit_cell().num_atoms(); ia1++) {
+                if (ctx_.unit_cell().atom(ia1).type().hubbard_correction()) {
+                    compute_occupancies_block(kp__, phi_s_psi, dphi_s_psi, this->number_of_hubbard_orbitals(),
+                                              this->offset_[ia1], ia1,
+                                              dn__.at(memory_t::host, 0, 0, 0, ia1, 3 * nu + mu),
+                                              static_cast<int>(dn__.size(0)));
+                }
+            }
         }
     }
 
@@ -456,106 +470,50 @@ Hubbard::wavefunctions_strain_deriv(K_point& kp__, Wave_functions& dphi, mdarray
 }
 
 void
-Hubbard::compute_occupancies(K_point&                    kp,
-                             dmatrix<double_complex>&    phi_s_psi,
-                             dmatrix<double_complex>&    dphi_s_psi,
-                             Wave_functions&             dphi,
-                             mdarray<double_complex, 5>& dn__,
-                             matrix<double_complex>&     dm__,
-                             const int                   index)
+Hubbard::compute_dphi_s_psi(K_point& kp__, Wave_functions& dphi__, int n__, dmatrix<double_complex>& dphi_s_psi__)
 {
     // it is actually <psi | d(S|phi>)
-    dphi_s_psi.zero(memory_t::host);
-    dphi_s_psi.zero(memory_t::device);
-    int HowManyBands = kp.num_occupied_bands(0);
-    if (ctx_.num_spins() == 2) {
-        HowManyBands = std::max(kp.num_occupied_bands(1), kp.num_occupied_bands(0));
-    }
-
-    auto la = linalg_t::none;
-    auto mt = memory_t::none;
-    switch (ctx_.processing_unit()) {
-        case device_t::CPU: {
-            la = linalg_t::blas;
-            mt = memory_t::host;
-            break;
-        }
-        case device_t::GPU: {
-            la = linalg_t::gpublas;
-            mt = memory_t::device;
-            break;
-        }
-    }
+    dphi_s_psi__.zero();
 
     for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
-        inner(ctx_.spla_context(), ispn, kp.spinor_wave_functions(), 0, kp.num_occupied_bands(ispn),
-              dphi, //   S d |phi>
-              0, this->number_of_hubbard_orbitals(), dphi_s_psi, 0, ispn * this->number_of_hubbard_orbitals());
-    }
-
-    if (ctx_.processing_unit() == device_t::GPU) {
-        dphi_s_psi.copy_to(memory_t::host);
-        phi_s_psi.copy_to(memory_t::host);
+        inner(ctx_.spla_context(), ispn, kp__.spinor_wave_functions(), 0, kp__.num_occupied_bands(ispn),
+              dphi__, //   S d |phi>
+              0, n__, dphi_s_psi__, 0, ispn * n__);
     }
 
     /* include the occupancy directly in dphi_s_psi */
-
     for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
-        for (int n_orb = 0; n_orb < this->number_of_hubbard_orbitals(); n_orb++) {
-            for (int nbnd = 0; nbnd < kp.num_occupied_bands(ispn); nbnd++) {
-                dphi_s_psi(nbnd, ispn * this->number_of_hubbard_orbitals() + n_orb) *= kp.band_occupancy(nbnd, ispn);
+        #pragma omp parallel for schedule(static)
+        for (int i = 0; i < n__; i++) {
+            for (int nbnd = 0; nbnd < kp__.num_occupied_bands(ispn); nbnd++) {
+                dphi_s_psi__(nbnd, ispn * n__ + i) *= kp__.band_occupancy(nbnd, ispn);
             }
         }
     }
-    if (ctx_.processing_unit() == device_t::GPU) {
-        dphi_s_psi.copy_to(memory_t::device);
-    }
+}
 
-    auto alpha = double_complex(kp.weight(), 0.0);
-    linalg(la).gemm('C', 'N',
-                     this->number_of_hubbard_orbitals() * ctx_.num_spins(),
-                     this->number_of_hubbard_orbitals() * ctx_.num_spins(),
-                     HowManyBands,
-                     &alpha,
-                     dphi_s_psi.at(mt),dphi_s_psi.ld(),
-                     phi_s_psi.at(mt), phi_s_psi.ld(),
-                     &linalg_const<double_complex>::zero(),
-                     dm__.at(mt), dm__.ld());
-
-    linalg(la).gemm('C', 'N',
-                     this->number_of_hubbard_orbitals() * ctx_.num_spins(),
-                     this->number_of_hubbard_orbitals() * ctx_.num_spins(),
-                     HowManyBands,
-                     &alpha,
-                     phi_s_psi.at(mt), phi_s_psi.ld(),
-                     dphi_s_psi.at(mt), dphi_s_psi.ld(),
-                     &linalg_const<double_complex>::one(),
-                     dm__.at(mt), dm__.ld());
-
-    switch (ctx_.processing_unit()) {
-        case device_t::CPU: {
-            break;
-        }
-        case device_t::GPU: {
-            dm__.copy_to(memory_t::host);
-            break;
-        }
-    }
+void
+Hubbard::compute_occupancies_block(K_point& kp__, dmatrix<double_complex>& phi_s_psi__,
+                                   dmatrix<double_complex>& dphi_s_psi__, int n__, int idx__, int ia__,
+                                   double_complex* dn__, int ld__)
+{
+    const int lmax_at = 2 * ctx_.unit_cell().atom(ia__).type().hubbard_orbital(0).l + 1;
 
-    #pragma omp parallel for schedule(static)
-    for (int ia1 = 0; ia1 < ctx_.unit_cell().num_atoms(); ++ia1) {
-        const auto& atom = ctx_.unit_cell().atom(ia1);
-        if (atom.type().hubbard_correction()) {
-            const int lmax_at = 2 * atom.type().hubbard_orbital(0).l + 1;
-            for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
-                const int ispn_offset = ispn * this->number_of_hubbard_orbitals() + this->offset_[ia1];
-                for (int m2 = 0; m2 < lmax_at; m2++) {
-                    for (int m1 = 0; m1 < lmax_at; m1++) {
-                        dn__(m1, m2, ispn, ia1, index) = dm__(ispn_offset + m1, ispn_offset + m2);
-                    }
-                }
-            }
-        }
+    auto alpha = double_complex(kp__.weight(), 0.0);
+
+    for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
+        auto dphi_ptr = dphi_s_psi__.at(memory_t::host, 0, ispn * n__ + idx__);
+        auto phi_ptr  = phi_s_psi__.at(memory_t::host, 0, ispn * this->number_of_hubbard_orbitals() + this->offset_[ia__]);
+        auto dn_ptr   = dn__ + ld__ * ld__ * ispn;
+
+        /* dn = w * (<psi|S d phi>^H f <psi|S phi> + <psi|S phi>^H f <psi|S d phi>) */
+        linalg(linalg_t::blas).gemm('C', 'N', lmax_at, lmax_at, kp__.num_occupied_bands(ispn), &alpha,
+                                    dphi_ptr, dphi_s_psi__.ld(), phi_ptr, phi_s_psi__.ld(),
+                                    &linalg_const<double_complex>::zero(), dn_ptr, ld__);
+
+        linalg(linalg_t::blas).gemm('C', 'N', lmax_at, lmax_at, kp__.num_occupied_bands(ispn), &alpha,
+                                    phi_ptr, phi_s_psi__.ld(), dphi_ptr, dphi_s_psi__.ld(),
+                                    &linalg_const<double_complex>::one(), dn_ptr, ld__);
     }
 }
 
@@ -375,6 +375,51 @@ Hubbard::calculate_hubbard_potential_and_energy_non_colinear_case(sddk::mdarray<
  * return the potential if the first parameter is set to "get"
  */
 
+void
+Hubbard::generate_potential_blocks()
+{
+    /* number of spin blocks and number of spins in a block */
+    int nsb = (ctx_.num_mag_dims() == 3) ? 1 : ctx_.num_spins();
+    int ns  = (ctx_.num_mag_dims() == 3) ? 2 : 1;
+
+    int nbmax{0};
+    for (int ia = 0; ia < ctx_.unit_cell().num_atoms(); ia++) {
+        auto& atom = ctx_.unit_cell().atom(ia);
+        if (atom.type().hubbard_correction()) {
+            nbmax = std::max(nbmax, ns * (2 * atom.type().hubbard_orbital(0).l + 1));
+        }
+    }
+
+    if (hubbard_potential_blocks_.size(0) != static_cast<size_t>(nbmax)) {
+        hubbard_potential_blocks_ = mdarray<double_complex, 4>(nbmax, nbmax, nsb, ctx_.unit_cell().num_atoms(),
+                                                               memory_t::host, "hubbard_potential_blocks_");
+    }
+    hubbard_potential_blocks_.zero();
+
+    #pragma omp parallel for schedule(static)
+    for (int ia = 0; ia < ctx_.unit_cell().num_atoms(); ia++) {
+        auto& atom = ctx_.unit_cell().atom(ia);
+        if (!atom.type().hubbard_correction()) {
+            continue;
+        }
+        const int lmax_at = 2 * atom.type().hubbard_orbital(0).l + 1;
+        for (int isb = 0; isb < nsb; isb++) {
+            for (int s1 = 0; s1 < ns; s1++) {
+                for (int s2 = 0; s2 < ns; s2++) {
+                    /* index of the spin component of the potential */
+                    int ind = (ns == 1) ? isb : (s1 == s2) * s1 + (1 + 2 * s2 + s1) * (s1 != s2);
+                    for (int m2 = 0; m2 < lmax_at; m2++) {
+                        for (int m1 = 0; m1 < lmax_at; m1++) {
+                            hubbard_potential_blocks_(s1 * lmax_at + m1, s2 * lmax_at + m2, isb, ia) =
+                                hubbard_potential_(m2, m1, ind, ia);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
 void
 Hubbard::access_hubbard_potential(std::string const& what__, double_complex* occ__, int ld__)
 {
@@ -418,5 +463,8 @@ Hubbard::access_hubbard_potential(std::string const& what__, double_complex* occ
             }
         }
     }
+    if (what__ == "set") {
+        generate_potential_blocks();
+    }
 }
 }
@@ -297,6 +297,12 @@ struct Iterative_solver_input
         the randomized wave functions. */
     std::string init_subspace_{"lcao"};
 
+    /// Adapt the tolerance and the number of steps of the iterative solver for each k-point.
+    /** The tolerance is derived from the density mixer residual and from the change of band energies between
+        two SCF iterations; the number of steps is reduced for loose tolerances at the beginning of the SCF cycle
+        and increased close to convergence. */
+    bool adaptive_tolerance_{false};
+
     void read(json const& parser)
     {
         if (parser.count("iterative_solver")) {
@@ -315,6 +321,7 @@ struct Iterative_solver_input
             init_eval_old_          = section.value("init_eval_old", init_eval_old_);
             init_subspace_          = section.value("init_subspace", init_subspace_);
             early_restart_          = section.value("early_restart", early_restart_);
+            adaptive_tolerance_     = section.value("adaptive_tolerance", adaptive_tolerance_);
             std::transform(init_subspace_.begin(), init_subspace_.end(), init_subspace_.begin(), ::tolower);
         }
     }
@@ -410,12 +417,72 @@ struct Control_input
     bool use_second_variation_{true};
 
     /// Control the usage of the GPU memory.
-    /** Possible values are: "low", "medium" and "high". */
+    /** Possible values are: "low", "medium" and "high". With "low" memory usage on CPU the plane-wave coefficients
+        of the augmentation operator are not stored but generated on the fly for blocks of G-vectors and only
+        beta_chunk_cache_size chunks of beta-projectors are kept. */
     std::string memory_usage_{"high"};
 
     /// Number of atoms in the beta-projectors chunk.
     int beta_chunk_size_{256};
 
+    /// Number of the most recently used chunks of beta-projectors kept on CPU when memory_usage is "low".
+    int beta_chunk_cache_size_{4};
+
+    /// Keep the beta-projectors of all atoms in the GPU memory.
+    /** Chunks are generated on the first request and reused until dismiss() of the beta-projectors, i.e. during
+     *  the band solve of a k-point; the density build regenerates them. This requires num_gkvec_loc x
+     *  mt_lo_basis_size of the device memory and is disabled by default. */
+    bool beta_cache_device_{false};
+
+    /// Compute the augmentation charge in real space.
+    /** The augmentation charge Q_{\xi \xi'}(r) is tabulated on the real-space grid points inside the augmentation
+     *  sphere of each atom instead of being summed in plane waves. The cost then scales linearly with the number
+     *  of atoms. Functions are not band-limited in this case, so the result is slightly different from the
+     *  reciprocal-space evaluation. */
+    bool aug_real_space_{false};
+
+    /// Apply the non-local part of the Hamiltonian in real space.
+    /** Beta-projectors are tabulated on the coarse FFT grid points inside the spheres around atoms and the
+     *  D-operator is applied to the wave-functions in real space during the application of the local part
+     *  of Hamiltonian. To reduce the aliasing error the projectors are Fourier-filtered with a Gaussian mask
+     *  function (King-Smith et al., PRB 44, 13063 (1991)). The option is ignored on GPU and
+     *  in the non-collinear or spin-orbit case. */
+    bool beta_real_space_{false};
+
+    /// Auto-select the strategy of the dense eigen-solver for the subspace matrices of the iterative solver.
+    /** For each class of matrix sizes the replicated LAPACK, sub-grid and full-grid parallel diagonalizations
+     *  are timed during the first iterations and the fastest one is used for the rest of the run. Only
+     *  used with the parallel (ScaLAPACK or ELPA) standard eigen-solver. Disabled by default. */
+    bool subspace_evp_autotune_{false};
+
+    /// Number of bands that are transformed to real space concurrently when the density is generated.
+    /** Each OpenMP thread of a team gets its own copy of the FFT transform and a private density grid. Only used
+     *  on CPU with a serial coarse FFT. Zero or one disables the band-parallel accumulation; negative value means
+     *  the number of OpenMP threads. */
+    int density_num_fft_teams_{0};
+
+    /// Store the replicated read-only tables once per node.
+    /** Tables which are identical on all MPI ranks are placed in the MPI-3 shared-memory window of the node
+     *  and written by a single rank of the node. */
+    bool node_shared_memory_{false};
+
+    /// Number of OpenMP threads in the loops of the code.
+    /** Zero means the default number of OpenMP threads. */
+    int num_threads_loops_{0};
+
+    /// Number of threads used by the threaded BLAS and LAPACK libraries (dense linear algebra stages).
+    /** Zero means the same number of threads as for the loops. */
+    int num_threads_blas_{0};
+
+    /// Number of threads used by SpFFT and in the loops around the FFT transformations.
+    /** Zero means the same number of threads as for the loops. */
+    int num_threads_fft_{0};
+
+    /// Maximum number of the cached coarse-grid SpFFT transforms of the k-points.
+    /** K-points with the same set of G+k vectors (also from different k-point sets) share a transform. Zero
+     *  disables the cache. */
+    int spfft_cache_size_{64};
+
     void read(json const& parser)
     {
         if (parser.count("control")) {
@@ -442,6 +509,17 @@ struct Control_input
             print_neighbors_     = section.value("print_neighbors", print_neighbors_);
             memory_usage_        = section.value("memory_usage", memory_usage_);
             beta_chunk_size_     = section.value("beta_chunk_size", beta_chunk_size_);
+            beta_chunk_cache_size_ = section.value("beta_chunk_cache_size", beta_chunk_cache_size_);
+            beta_cache_device_     = section.value("beta_cache_device", beta_cache_device_);
+            aug_real_space_      = section.value("aug_real_space", aug_real_space_);
+            beta_real_space_     = section.value("beta_real_space", beta_real_space_);
+            subspace_evp_autotune_ = section.value("subspace_evp_autotune", subspace_evp_autotune_);
+            density_num_fft_teams_ = section.value("density_num_fft_teams", density_num_fft_teams_);
+            node_shared_memory_    = section.value("node_shared_memory", node_shared_memory_);
+            num_threads_loops_     = section.value("num_threads_loops", num_threads_loops_);
+            num_threads_blas_      = section.value("num_threads_blas", num_threads_blas_);
+            num_threads_fft_       = section.value("num_threads_fft", num_threads_fft_);
+            spfft_cache_size_      = section.value("spfft_cache_size", spfft_cache_size_);
 
             auto strings = {&std_evp_solver_name_, &gen_evp_solver_name_, &fft_mode_, &processing_unit_,
                             &memory_usage_};
@@ -298,11 +298,14 @@ void K_point::generate_gkvec(double gk_cutoff__)
     const auto fft_type = gkvec_->reduced() ? SPFFT_TRANS_R2C : SPFFT_TRANS_C2C;
     const auto spfft_pu = ctx_.processing_unit() == device_t::CPU ? SPFFT_PU_HOST : SPFFT_PU_GPU;
     auto gv = gkvec_partition_->get_gvec();
-    /* create transformation */
-    spfft_transform_.reset(new spfft::Transform(ctx_.spfft_grid_coarse().create_transform(
-        spfft_pu, fft_type, ctx_.fft_coarse_grid()[0], ctx_.fft_coarse_grid()[1], ctx_.fft_coarse_grid()[2],
-        ctx_.spfft_coarse().local_z_length(), gkvec_partition_->gvec_count_fft(), SPFFT_INDEX_TRIPLETS,
-        gv.at(memory_t::host))));
+    /* get the transformation; k-points with the same set of G+k vectors share it */
+    auto& cache = ctx_.spfft_cache_coarse();
+    spfft_transform_ = cache.get(ctx_.spfft_grid_coarse(), spfft_pu, fft_type, ctx_.fft_coarse_grid()[0],
+        ctx_.fft_coarse_grid()[1], ctx_.fft_coarse_grid()[2], ctx_.spfft_coarse().local_z_length(),
+        gkvec_partition_->gvec_count_fft(), gv.at(memory_t::host), ctx_.comm_fft_coarse());
+
+    ctx_.message(3, __function_name__, "SpFFT transform cache: %i transforms, %i hits, %i misses, %li Kb of keys\n",
+                 cache.size(), cache.num_hits(), cache.num_misses(), cache.index_memory() >> 10);
 }
 
 void K_point::update()
@@ -332,6 +335,10 @@ void K_point::update()
 
         }
 
+        if (ctx_.beta_real_space()) {
+            beta_projectors_rs_ = std::unique_ptr<Beta_projectors_rs>(new Beta_projectors_rs(ctx_, vk_));
+        }
+
         if (ctx_.hubbard_correction()) {
             generate_hubbard_orbitals();
         }
@@ -622,6 +629,26 @@ void K_point::get_fv_eigen_vectors(mdarray<double_complex, 2> &fv_evec__) const
 //==     }
 //== }
 
+mdarray<double, 1> K_point::band_weighted_pw_sumsqr()
+{
+    PROFILE("sirius::K_point::band_weighted_pw_sumsqr");
+
+    mdarray<double, 1> d(num_gkvec_loc());
+    d.zero();
+
+    std::vector<double> w(ctx_.num_bands());
+    for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
+        int nocc = num_occupied_bands(ispn);
+        for (int i = 0; i < nocc; i++) {
+            w[i] = band_occupancy(i, ispn);
+        }
+        auto& psi = spinor_wave_functions().pw_coeffs(ispn).prime();
+        add_weighted_row_products(num_gkvec_loc(), nocc, psi.at(memory_t::host), psi.ld(), psi.at(memory_t::host),
+                                  psi.ld(), w.data(), d.at(memory_t::host));
+    }
+    return d;
+}
+
 void K_point::test_spinor_wave_functions(int use_fft)
 {
         STOP();
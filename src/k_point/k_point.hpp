@@ -27,6 +27,7 @@
 
 #include "lapw/matching_coefficients.hpp"
 #include "beta_projectors/beta_projectors.hpp"
+#include "beta_projectors/beta_projectors_rs.hpp"
 #include "wave_functions.hpp"
 
 namespace sirius {
@@ -58,7 +59,7 @@ class K_point
     /// G-vector distribution for the FFT transformation.
     std::unique_ptr<Gvec_partition> gkvec_partition_;
 
-    std::unique_ptr<spfft::Transform> spfft_transform_;
+    std::shared_ptr<spfft::Transform> spfft_transform_;
 
     /// First-variational eigen values
     std::vector<double> fv_eigen_values_;
@@ -99,6 +100,12 @@ class K_point
     /// Band energies.
     mdarray<double, 2> band_energies_;
 
+    /// Tolerance of the iterative solver for this k-point (negative value means that global tolerance is used).
+    double iterative_solver_tolerance_{-1};
+
+    /// Maximum number of iterative solver steps for this k-point (negative value means that global value is used).
+    int iterative_solver_num_steps_{-1};
+
     /// LAPW matching coefficients for the row G+k vectors.
     /** Used to setup the distributed LAPW Hamiltonian and overlap matrices. */
     std::unique_ptr<Matching_coefficients> alm_coeffs_row_{nullptr};
@@ -174,6 +181,10 @@ class K_point
     /** Used to setup the full Hamiltonian in PP-PW case (for verification purpose only) */
     std::unique_ptr<Beta_projectors> beta_projectors_col_{nullptr};
 
+    /// Beta projectors on the real-space grid points around atoms.
+    /** Created only if the non-local part of Hamiltonian is applied in real space. */
+    std::unique_ptr<Beta_projectors_rs> beta_projectors_rs_{nullptr};
+
     /// Preconditioner matrix for Chebyshev solver.
     mdarray<double_complex, 3> p_mtrx_;
 
@@ -379,6 +390,11 @@ class K_point
     /// Test orthonormalization of spinor wave-functions
     void test_spinor_wave_functions(int use_fft);
 
+    /// Occupation-weighted sum of squares of the plane-wave coefficients of spinor wave-functions.
+    /** For each local G+k vector the sum over occupied bands and spin components \f$ \sum_{i\sigma} f_{i\sigma}
+     *  |\psi_{i\sigma}({\bf G+k})|^2 \f$ is computed. The k-point weight is not included. */
+    mdarray<double, 1> band_weighted_pw_sumsqr();
+
     /// Get the number of occupied bands for each spin channel.
     inline int num_occupied_bands(int ispn__ = -1) const
     {
@@ -432,6 +448,31 @@ class K_point
         band_occupancies_(j__, ispn__) = occ__;
     }
 
+    /// Get the tolerance of the iterative solver.
+    inline double iterative_solver_tolerance() const
+    {
+        return (iterative_solver_tolerance_ > 0) ? iterative_solver_tolerance_ : ctx_.iterative_solver_tolerance();
+    }
+
+    /// Set the tolerance of the iterative solver for this k-point.
+    inline void iterative_solver_tolerance(double tol__)
+    {
+        iterative_solver_tolerance_ = tol__;
+    }
+
+    /// Get the maximum number of iterative solver steps.
+    inline int iterative_solver_num_steps() const
+    {
+        return (iterative_solver_num_steps_ > 0) ? iterative_solver_num_steps_ :
+                                                   ctx_.iterative_solver_input().num_steps_;
+    }
+
+    /// Set the maximum number of iterative solver steps for this k-point.
+    inline void iterative_solver_num_steps(int num_steps__)
+    {
+        iterative_solver_num_steps_ = num_steps__;
+    }
+
     inline double fv_eigen_value(int i) const
     {
         return fv_eigen_values_[i];
@@ -727,6 +768,12 @@ class K_point
         return *beta_projectors_;
     }
 
+    /// Return a pointer to real-space beta-projectors or nullptr if they were not created.
+    Beta_projectors_rs* beta_projectors_rs()
+    {
+        return beta_projectors_rs_.get();
+    }
+
     Beta_projectors& beta_projectors_row()
     {
         assert(beta_projectors_ != nullptr);
@@ -175,16 +175,6 @@ void K_point_set::find_band_occupancies()
         return;
     }
 
-    double ef{0};
-    double de{0.1};
-
-    int s{1};
-    int sp;
-
-    mdarray<double, 3> bnd_occ(ctx_.num_bands(), ctx_.num_spin_dims(), num_kpoints());
-
-    double ne{0};
-
     /* target number of electrons */
     double ne_target = ctx_.unit_cell().num_valence_electrons() - ctx_.parameters_input().extra_charge_;
 
@@ -205,32 +195,87 @@ void K_point_set::find_band_occupancies()
         return;
     }
 
-    int step{0};
-    /* calculate occupations */
-    while (std::abs(ne - ne_target) >= 1e-11) {
-        /* update Efermi */
-        ef += de;
-        /* compute total number of electrons */
-        ne = 0.0;
-        for (int ik = 0; ik < num_kpoints(); ik++) {
-            for (int ispn = 0; ispn < ctx_.num_spin_dims(); ispn++) {
-                for (int j = 0; j < ctx_.num_bands(); j++) {
-                    bnd_occ(j, ispn, ik) =
-                        smearing::gaussian(kpoints_[ik]->band_energy(j, ispn) - ef, ctx_.smearing_width()) *
-                        ctx_.max_occupancy();
-                    ne += bnd_occ(j, ispn, ik) * kpoints_[ik]->weight();
-                }
+    double delta   = ctx_.smearing_width();
+    double max_occ = ctx_.max_occupancy();
+
+    /* band energies and weights of the local k-points sorted by energy */
+    std::vector<std::pair<double, double>> ew;
+    for (int ikloc = 0; ikloc < spl_num_kpoints().local_size(); ikloc++) {
+        int ik = spl_num_kpoints(ikloc);
+        for (int ispn = 0; ispn < ctx_.num_spin_dims(); ispn++) {
+            for (int j = 0; j < ctx_.num_bands(); j++) {
+                ew.push_back(std::make_pair(kpoints_[ik]->band_energy(j, ispn), kpoints_[ik]->weight() * max_occ));
             }
         }
+    }
+    std::sort(ew.begin(), ew.end());
+    int n = static_cast<int>(ew.size());
+    std::vector<double> e(n);
+    /* w_acc[i] is the total weight of the first i states */
+    std::vector<double> w(n);
+    std::vector<double> w_acc(n + 1, 0);
+    for (int i = 0; i < n; i++) {
+        e[i]         = ew[i].first;
+        w[i]         = ew[i].second;
+        w_acc[i + 1] = w_acc[i] + w[i];
+    }
 
-        sp = s;
-        s  = (ne > ne_target) ? -1 : 1;
-        /* reduce de step if we change the direction, otherwise increase the step */
-        de = (s != sp) ? (-de * 0.5) : (de * 1.25);
+    /* states outside of this window around Fermi energy are either fully occupied or empty */
+    double ewin = 8 * delta;
+
+    /* compute number of electrons and its derivative with respect to Fermi energy */
+    auto num_electrons = [&](double ef__, double& dne__) {
+        int i0 = static_cast<int>(std::lower_bound(e.begin(), e.end(), ef__ - ewin) - e.begin());
+        int i1 = static_cast<int>(std::upper_bound(e.begin(), e.end(), ef__ + ewin) - e.begin());
+        double v[] = {w_acc[i0], 0};
+        double ne{0};
+        double dne{0};
+        #pragma omp parallel for simd reduction(+:ne, dne)
+        for (int i = i0; i < i1; i++) {
+            ne += w[i] * smearing::gaussian(e[i] - ef__, delta);
+            dne += w[i] * smearing::gaussian_delta(e[i] - ef__, delta);
+        }
+        v[0] += ne;
+        v[1] = dne;
+        comm().allreduce(v, 2);
+        dne__ = v[1];
+        return v[0];
+    };
+
+    /* bracket the Fermi energy */
+    double emin = (n > 0) ? e.front() : std::numeric_limits<double>::max();
+    double emax = (n > 0) ? e.back() : -std::numeric_limits<double>::max();
+    comm().allreduce<double, mpi_op_t::min>(&emin, 1);
+    comm().allreduce<double, mpi_op_t::max>(&emax, 1);
+
+    double ef_lo = emin - ewin;
+    double ef_hi = emax + ewin;
+
+    /* safeguarded Newton iterations: Newton step is taken if it stays inside the bracket and reduces the bracket
+     * fast enough, otherwise the bracket is bisected */
+    double ef = 0.5 * (ef_lo + ef_hi);
+    double dne{0};
+    double ne = num_electrons(ef, dne);
+    int step{0};
+    while (std::abs(ne - ne_target) >= 1e-11) {
+        if (ne > ne_target) {
+            ef_hi = ef;
+        } else {
+            ef_lo = ef;
+        }
+        double ef_new = ef - (ne - ne_target) / dne;
+        if (!(dne > 0) || !(ef_new > ef_lo && ef_new < ef_hi) ||
+            std::abs(ef_new - ef) > 0.5 * (ef_hi - ef_lo)) {
+            ef_new = 0.5 * (ef_lo + ef_hi);
+        }
+        ef = ef_new;
+        ne = num_electrons(ef, dne);
 
-        if (step > 10000) {
+        if (step > 1000) {
             std::stringstream s;
-            s << "search of band occupancies failed after 10000 steps";
+            s << "search of band occupancies failed after " << step << " steps" << std::endl
+              << "  number of electrons : " << ne << std::endl
+              << "  target              : " << ne_target;
             TERMINATE(s);
         }
         step++;
@@ -238,10 +283,12 @@ void K_point_set::find_band_occupancies()
 
     energy_fermi_ = ef;
 
+    #pragma omp parallel for
     for (int ik = 0; ik < num_kpoints(); ik++) {
         for (int ispn = 0; ispn < ctx_.num_spin_dims(); ispn++) {
             for (int j = 0; j < ctx_.num_bands(); j++) {
-                kpoints_[ik]->band_occupancy(j, ispn, bnd_occ(j, ispn, ik));
+                kpoints_[ik]->band_occupancy(j, ispn,
+                    smearing::gaussian(kpoints_[ik]->band_energy(j, ispn) - ef, delta) * max_occ);
             }
         }
     }
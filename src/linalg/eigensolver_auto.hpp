@@ -0,0 +1,385 @@
+// Copyright (c) 2013-2020 Anton Kozhevnikov, Thomas Schulthess
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+// the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+//    following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+//    and the following disclaimer in the documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** \file eigensolver_auto.hpp
+ *
+ *  \brief Contains definition and implementation of the auto-tuned eigen-solver for small distributed matrices.
+ */
+
+#ifndef __EIGENSOLVER_AUTO_HPP__
+#define __EIGENSOLVER_AUTO_HPP__
+
+#include <array>
+#include <map>
+#include "eigensolver.hpp"
+#include "utils/utils.hpp"
+#include "utils/profiler.hpp"
+
+/// Eigen-solver for the small distributed matrices of the iterative subspace methods.
+/** The standard eigen-value problem is solved with one of the three strategies:
+ *    - the matrix is replicated on all ranks, diagonalized by LAPACK on a single rank and the eigen-vectors are
+ *      broadcasted back,
+ *    - the matrix is redistributed to a 2D sub-grid (half of the ranks in each direction) and diagonalized by
+ *      the parallel solver there,
+ *    - the matrix is diagonalized by the parallel solver on the full BLACS grid.
+ *
+ *  The first calls for each class of matrix sizes try all available strategies; the fastest one (maximum time
+ *  over all ranks) is stored in the tuning table and used for the rest of the run. Generalized problems are
+ *  always solved on the full grid. */
+class Eigensolver_auto : public Eigensolver
+{
+  public:
+    /// Strategy of the solution.
+    enum class strategy_t
+    {
+        /// LAPACK on a replicated matrix.
+        replicated,
+        /// Parallel solver on a sub-grid.
+        subgrid,
+        /// Parallel solver on a full grid.
+        full
+    };
+
+  private:
+    /// Parallel solver on the full grid.
+    std::unique_ptr<Eigensolver> full_solver_;
+    /// Parallel solver on the sub-grid.
+    std::unique_ptr<Eigensolver> sub_solver_;
+    /// Sequential solver.
+    std::unique_ptr<Eigensolver> lapack_solver_;
+    /// Full BLACS grid for which the sub-grid was created.
+    BLACS_grid const* grid_{nullptr};
+    /// Communicator of the sub-grid.
+    Communicator comm_sub_;
+    /// Sub-grid; it only exists on the ranks which belong to it.
+    std::unique_ptr<BLACS_grid> grid_sub_;
+    /// True if the sub-grid has more than one rank.
+    bool has_subgrid_{false};
+    /// Maximum matrix size for the replicated strategy.
+    int max_size_replicated_{8192};
+
+    /// Entry of the tuning table.
+    struct tuning_entry_t
+    {
+        /// Measured time of each strategy; negative if the strategy was not tried yet.
+        std::array<double, 3> time{{-1, -1, -1}};
+        /// Best strategy.
+        int best{-1};
+    };
+
+    /// Tuning table; the key is {class of the matrix size, is complex}.
+    std::map<std::pair<int, bool>, tuning_entry_t> tuning_table_;
+
+    /// Class of the matrix size: sizes in the range [2^{k/2}, 2^{(k+1)/2}) are treated equally.
+    static int size_class(int matrix_size__)
+    {
+        return static_cast<int>(2 * std::log2(static_cast<double>(std::max(matrix_size__, 1))));
+    }
+
+    /// Create the sub-grid for a given full grid.
+    void init_subgrid(BLACS_grid const& grid__)
+    {
+        if (grid_ == &grid__) {
+            return;
+        }
+        grid_ = &grid__;
+        grid_sub_.reset(nullptr);
+
+        int nr = std::max(1, grid__.num_ranks_row() / 2);
+        int nc = std::max(1, grid__.num_ranks_col() / 2);
+        has_subgrid_ = (nr * nc > 1);
+        if (!has_subgrid_) {
+            return;
+        }
+        bool in_sub = grid__.rank_row() < nr && grid__.rank_col() < nc;
+        comm_sub_   = grid__.comm().split(in_sub ? 0 : 1);
+        if (in_sub) {
+            grid_sub_ = std::unique_ptr<BLACS_grid>(new BLACS_grid(comm_sub_, nr, nc));
+        }
+    }
+
+    /// Collect the full upper-left n x n block of the distributed matrix on all ranks.
+    template <typename T>
+    static void gather(int n__, dmatrix<T>& A__, matrix<T>& Af__)
+    {
+        Af__.zero();
+        for (int jloc = 0; jloc < A__.num_cols_local(); jloc++) {
+            int j = A__.icol(jloc);
+            if (j < n__) {
+                for (int iloc = 0; iloc < A__.num_rows_local(); iloc++) {
+                    int i = A__.irow(iloc);
+                    if (i < n__) {
+                        Af__(i, j) = A__(iloc, jloc);
+                    }
+                }
+            }
+        }
+        A__.comm().allreduce(Af__.at(memory_t::host), static_cast<int>(Af__.size()));
+    }
+
+    /// Copy the first columns of the replicated matrix to the local panels of the distributed matrix.
+    template <typename T>
+    static void scatter(int n__, int ncol__, matrix<T> const& Af__, dmatrix<T>& A__)
+    {
+        for (int jloc = 0; jloc < A__.num_cols_local(); jloc++) {
+            int j = A__.icol(jloc);
+            if (j < ncol__) {
+                for (int iloc = 0; iloc < A__.num_rows_local(); iloc++) {
+                    int i = A__.irow(iloc);
+                    if (i < n__) {
+                        A__(iloc, jloc) = Af__(i, j);
+                    }
+                }
+            }
+        }
+    }
+
+    /// Solve with LAPACK on the first rank and broadcast the result.
+    template <typename T>
+    int solve_replicated(ftn_int matrix_size__, ftn_int nev__, dmatrix<T>& A__, double* eval__, dmatrix<T>& Z__)
+    {
+        PROFILE("Eigensolver_auto|replicated");
+
+        Communicator const& comm = A__.comm();
+
+        dmatrix<T> Af(matrix_size__, matrix_size__);
+        gather(matrix_size__, A__, Af);
+
+        dmatrix<T> Zf(matrix_size__, matrix_size__);
+        int info{0};
+        if (comm.rank() == 0) {
+            info = lapack_solver_->solve(matrix_size__, nev__, Af, eval__, Zf);
+        }
+        comm.bcast(&info, 1, 0);
+        if (info) {
+            return info;
+        }
+        comm.bcast(eval__, nev__, 0);
+        comm.bcast(Zf.at(memory_t::host), matrix_size__ * nev__, 0);
+        scatter(matrix_size__, nev__, Zf, Z__);
+
+        return info;
+    }
+
+    /// Solve with the parallel solver on a sub-grid and collect the result.
+    template <typename T>
+    int solve_subgrid(ftn_int matrix_size__, ftn_int nev__, dmatrix<T>& A__, double* eval__, dmatrix<T>& Z__)
+    {
+        PROFILE("Eigensolver_auto|subgrid");
+
+        Communicator const& comm = A__.comm();
+
+        matrix<T> Af(matrix_size__, matrix_size__);
+        gather(matrix_size__, A__, Af);
+
+        matrix<T> Zf(matrix_size__, nev__);
+        Zf.zero();
+        std::vector<double> eval(nev__, 0);
+        int info{0};
+        if (grid_sub_) {
+            int bs = A__.bs_row();
+            dmatrix<T> As(matrix_size__, matrix_size__, *grid_sub_, bs, bs);
+            dmatrix<T> Zs(matrix_size__, matrix_size__, *grid_sub_, bs, bs);
+            scatter(matrix_size__, matrix_size__, Af, As);
+            info = sub_solver_->solve(matrix_size__, nev__, As, eval.data(), Zs);
+            for (int jloc = 0; jloc < Zs.num_cols_local(); jloc++) {
+                int j = Zs.icol(jloc);
+                if (j < nev__) {
+                    for (int iloc = 0; iloc < Zs.num_rows_local(); iloc++) {
+                        Zf(Zs.irow(iloc), j) = Zs(iloc, jloc);
+                    }
+                }
+            }
+            /* only the first rank of the sub-grid contributes the eigen-values and error code */
+            if (comm_sub_.rank() != 0) {
+                std::fill(eval.begin(), eval.end(), 0);
+                info = 0;
+            }
+        }
+        comm.allreduce(&info, 1);
+        if (info) {
+            return info;
+        }
+        comm.allreduce(eval.data(), nev__);
+        std::copy(eval.begin(), eval.end(), eval__);
+        comm.allreduce(Zf.at(memory_t::host), static_cast<int>(Zf.size()));
+        scatter(matrix_size__, nev__, Zf, Z__);
+
+        return info;
+    }
+
+    /// Solve the standard eigen-value problem with the tuned strategy.
+    template <typename T>
+    int solve_auto(ftn_int matrix_size__, ftn_int nev__, dmatrix<T>& A__, double* eval__, dmatrix<T>& Z__)
+    {
+        Communicator const& comm = A__.comm();
+        if (comm.size() == 1) {
+            return lapack_solver_->solve(matrix_size__, nev__, A__, eval__, Z__);
+        }
+
+        init_subgrid(A__.blacs_grid());
+
+        std::array<bool, 3> is_available = {{matrix_size__ <= max_size_replicated_,
+                                             matrix_size__ <= max_size_replicated_ && has_subgrid_, true}};
+
+        auto& e = tuning_table_[std::make_pair(size_class(matrix_size__), std::is_same<T, double_complex>::value)];
+
+        /* pick the next strategy to try or the best one */
+        int s = e.best;
+        if (s < 0) {
+            for (int i = 0; i < 3; i++) {
+                if (is_available[i] && e.time[i] < 0) {
+                    s = i;
+                    break;
+                }
+            }
+        }
+
+        auto t0 = utils::time_now();
+        int info{0};
+        switch (static_cast<strategy_t>(s)) {
+            case strategy_t::replicated: {
+                info = solve_replicated(matrix_size__, nev__, A__, eval__, Z__);
+                break;
+            }
+            case strategy_t::subgrid: {
+                info = solve_subgrid(matrix_size__, nev__, A__, eval__, Z__);
+                break;
+            }
+            case strategy_t::full: {
+                PROFILE("Eigensolver_auto|full");
+                info = full_solver_->solve(matrix_size__, nev__, A__, eval__, Z__);
+                break;
+            }
+        }
+
+        if (e.best < 0) {
+            /* all ranks must take the same decision */
+            double t = utils::time_interval(t0);
+            comm.allreduce<double, mpi_op_t::max>(&t, 1);
+            e.time[s] = t;
+
+            bool done{true};
+            for (int i = 0; i < 3; i++) {
+                if (is_available[i] && e.time[i] < 0) {
+                    done = false;
+                }
+            }
+            if (done) {
+                for (int i = 0; i < 3; i++) {
+                    if (is_available[i] && (e.best < 0 || e.time[i] < e.time[e.best])) {
+                        e.best = i;
+                    }
+                }
+            }
+        }
+
+        return info;
+    }
+
+  public:
+    /// Constructor.
+    /** \param [in] name__ Name of the parallel eigen-solver which is used on the full grid and on the sub-grid. */
+    Eigensolver_auto(std::string name__, sddk::memory_pool* mpd__)
+        : Eigensolver(get_ev_solver_t(name__), mpd__, true, sddk::memory_t::host, sddk::memory_t::host)
+        , full_solver_(Eigensolver_factory(name__, mpd__))
+        , sub_solver_(Eigensolver_factory(name__, mpd__))
+        , lapack_solver_(Eigensolver_factory("lapack", mpd__))
+    {
+        if (!full_solver_->is_parallel()) {
+            TERMINATE("Eigensolver_auto requires a parallel eigen-solver");
+        }
+    }
+
+    int solve(ftn_int matrix_size__, dmatrix<double>& A__, double* eval__, dmatrix<double>& Z__)
+    {
+        return full_solver_->solve(matrix_size__, A__, eval__, Z__);
+    }
+
+    int solve(ftn_int matrix_size__, dmatrix<double_complex>& A__, double* eval__, dmatrix<double_complex>& Z__)
+    {
+        return full_solver_->solve(matrix_size__, A__, eval__, Z__);
+    }
+
+    int solve(ftn_int matrix_size__, ftn_int nev__, dmatrix<double>& A__, double* eval__, dmatrix<double>& Z__)
+    {
+        return solve_auto(matrix_size__, nev__, A__, eval__, Z__);
+    }
+
+    int solve(ftn_int matrix_size__, ftn_int nev__, dmatrix<double_complex>& A__, double* eval__,
+              dmatrix<double_complex>& Z__)
+    {
+        return solve_auto(matrix_size__, nev__, A__, eval__, Z__);
+    }
+
+    int solve(ftn_int matrix_size__, dmatrix<double>& A__, dmatrix<double>& B__, double* eval__,
+              dmatrix<double>& Z__)
+    {
+        return full_solver_->solve(matrix_size__, A__, B__, eval__, Z__);
+    }
+
+    int solve(ftn_int matrix_size__, dmatrix<double_complex>& A__, dmatrix<double_complex>& B__, double* eval__,
+              dmatrix<double_complex>& Z__)
+    {
+        return full_solver_->solve(matrix_size__, A__, B__, eval__, Z__);
+    }
+
+    int solve(ftn_int matrix_size__, ftn_int nev__, dmatrix<double>& A__, dmatrix<double>& B__, double* eval__,
+              dmatrix<double>& Z__)
+    {
+        return full_solver_->solve(matrix_size__, nev__, A__, B__, eval__, Z__);
+    }
+
+    int solve(ftn_int matrix_size__, ftn_int nev__, dmatrix<double_complex>& A__, dmatrix<double_complex>& B__,
+              double* eval__, dmatrix<double_complex>& Z__)
+    {
+        return full_solver_->solve(matrix_size__, nev__, A__, B__, eval__, Z__);
+    }
+
+    /// Return the chosen strategy for a given matrix size or -1 if it is not decided yet.
+    int strategy(int matrix_size__, bool is_complex__) const
+    {
+        auto key = std::make_pair(size_class(matrix_size__), is_complex__);
+        return tuning_table_.count(key) ? tuning_table_.at(key).best : -1;
+    }
+
+    /// Print the tuning table.
+    void print_tuning_table() const
+    {
+        static const char* label[] = {"replicated", "subgrid", "full"};
+        std::printf("Eigensolver_auto tuning table\n");
+        std::printf("  size range     | type    | replicated | subgrid    | full       | choice\n");
+        for (auto& e: tuning_table_) {
+            int k = e.first.first;
+            std::printf("  %6i - %6i | %-7s |", static_cast<int>(std::ceil(std::pow(2.0, k / 2.0))),
+                        static_cast<int>(std::ceil(std::pow(2.0, (k + 1) / 2.0))) - 1,
+                        e.first.second ? "complex" : "real");
+            for (int i = 0; i < 3; i++) {
+                if (e.second.time[i] < 0) {
+                    std::printf(" %10s |", "-");
+                } else {
+                    std::printf(" %10.6f |", e.second.time[i]);
+                }
+            }
+            std::printf(" %s\n", e.second.best < 0 ? "-" : label[e.second.best]);
+        }
+    }
+};
+
+#endif
@@ -54,15 +54,21 @@ class Broyden1 : public Mixer<FUNCS...>
     double beta_;
     double beta0_;
     double beta_scaling_factor_;
-    mdarray<double, 2> S_old_;
+    /// Inner products of residual differences from the previous step.
+    /** Inner products are computed from the explicitly formed differences; expanding them in terms of the residual
+     *  Gram matrix loses precision when the residuals are close to each other. */
+    sddk::mdarray<double, 2> S_old_;
   public:
-    Broyden1(std::size_t max_history, double beta, double beta0, double beta_scaling_factor)
-        : Mixer<FUNCS...>(max_history)
+    Broyden1(std::size_t max_history, double beta, double beta0, double beta_scaling_factor,
+             sddk::Communicator const& comm = sddk::Communicator::self())
+        : Mixer<FUNCS...>(max_history, comm)
         , beta_(beta)
         , beta0_(beta0)
         , beta_scaling_factor_(beta_scaling_factor)
     {
-        S_old_ = mdarray<double, 2>(max_history, max_history);
+        S_old_ = sddk::mdarray<double, 2>(max_history, max_history);
+        /* only the norm of the current residual is needed */
+        this->gram_history_ = 1;
     }
 
     void mix_impl() override
@@ -72,8 +78,6 @@ class Broyden1 : public Mixer<FUNCS...>
 
         const int history_size = static_cast<int>(std::min(this->step_, this->max_history_ - 1));
 
-        const bool normalize = false;
-
         // beta scaling
         if (this->step_ > this->max_history_) {
             const double rmse_avg = std::accumulate(this->rmse_history_.begin(), this->rmse_history_.end(), 0.0) /
@@ -88,28 +92,35 @@ class Broyden1 : public Mixer<FUNCS...>
 
         if (history_size > 0) {
             sddk::mdarray<double, 2> S(history_size, history_size);
-            S.zero();
             /* restore S from the previous step */
             for (int j1 = 0; j1 < history_size - 1; j1++) {
                 for (int j2 = 0; j2 < history_size - 1; j2++) {
-                    S(j1 + 1, j2 + 1) = this->S_old_(j1, j2);
+                    S(j1 + 1, j2 + 1) = S_old_(j1, j2);
                 }
             }
 
-            for (int j1 = 0; j1 < history_size; j1++) {
-                int i1 = this->idx_hist(this->step_ - j1);
-                int i2 = this->idx_hist(this->step_ - j1 - 1);
-                this->copy(this->residual_history_[i1], this->tmp1_);
-                this->axpy(-1.0, this->residual_history_[i2], this->tmp1_);
-                int j2 = 0;;
-                //for (int j2 = 0; j2 <= j1; j2++) {
-                    int i3 = this->idx_hist(this->step_ - j2);
-                    int i4 = this->idx_hist(this->step_ - j2 - 1);
-                    this->copy(this->residual_history_[i3], this->tmp2_);
-                    this->axpy(-1.0, this->residual_history_[i4], this->tmp2_);
-
-                    S(j2, j1) = S(j1, j2) = this->template inner_product<normalize>(this->tmp1_, this->tmp2_);
-                //}
+            /* newest residual difference */
+            this->copy(this->residual_history_[idx_step], this->tmp1_);
+            this->axpy(-1.0, this->residual_history_[this->idx_hist(this->step_ - 1)], this->tmp1_);
+
+            /* the new row of S and the projections of the current residual on the residual differences; local
+             * contributions are reduced at once */
+            std::vector<mixer_impl::InnerProductParts> parts(2 * history_size);
+            for (int j = 0; j < history_size; j++) {
+                int i1 = this->idx_hist(this->step_ - j);
+                int i2 = this->idx_hist(this->step_ - j - 1);
+                this->copy(this->residual_history_[i1], this->tmp2_);
+                this->axpy(-1.0, this->residual_history_[i2], this->tmp2_);
+
+                parts[j]                = this->inner_product_parts(this->tmp1_, this->tmp2_);
+                parts[history_size + j] = this->inner_product_parts(this->tmp2_, this->residual_history_[idx_step]);
+            }
+            this->reduce_inner_products(parts);
+
+            sddk::mdarray<double, 1> c(history_size);
+            for (int j = 0; j < history_size; j++) {
+                S(0, j) = S(j, 0) = parts[j].local + parts[j].global;
+                c(j) = parts[history_size + j].local + parts[history_size + j].global;
             }
 
             for (int j1 = 0; j1 < history_size; j1++) {
@@ -127,18 +138,6 @@ class Broyden1 : public Mixer<FUNCS...>
                 }
             }
 
-            sddk::mdarray<double, 1> c(history_size);
-            c.zero();
-            for (int j = 0; j < history_size; j++) {
-                int i1 = this->idx_hist(this->step_ - j);
-                int i2 = this->idx_hist(this->step_ - j - 1);
-
-                this->copy(this->residual_history_[i1], this->tmp1_);
-                this->axpy(-1.0, this->residual_history_[i2], this->tmp1_);
-
-                c(j) = this->template inner_product<normalize>(this->tmp1_, this->residual_history_[idx_step]);
-            }
-
             for (int j = 0; j < history_size; j++) {
                 double gamma = 0;
                 for (int i = 0; i < history_size; i++) {
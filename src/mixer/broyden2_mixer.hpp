@@ -50,8 +50,9 @@ template <typename... FUNCS>
 class Broyden2 : public Mixer<FUNCS...>
 {
   public:
-    Broyden2(std::size_t max_history, double beta, double beta0, double beta_scaling_factor, double linear_mix_rmse_tol)
-        : Mixer<FUNCS...>(max_history)
+    Broyden2(std::size_t max_history, double beta, double beta0, double beta_scaling_factor, double linear_mix_rmse_tol,
+             sddk::Communicator const& comm = sddk::Communicator::self())
+        : Mixer<FUNCS...>(max_history, comm)
         , beta_(beta)
         , beta0_(beta0)
         , beta_scaling_factor_(beta_scaling_factor)
@@ -77,19 +78,16 @@ class Broyden2 : public Mixer<FUNCS...>
 
         const double rmse = this->rmse_history_[idx_step];
 
-        const bool normalize = false;
-
         if ((history_size > 1 && rmse < this->linear_mix_rmse_tol_ && this->linear_mix_rmse_tol_ > 0) ||
             (this->linear_mix_rmse_tol_ <= 0 && this->step_ > this->max_history_)) {
+            /* inner products of residuals are taken from the Gram matrix, which is updated with each new residual */
             sddk::mdarray<double, 2> S(history_size, history_size);
-            S.zero();
             for (int j1 = 0; j1 < static_cast<int>(history_size); j1++) {
                 int i1 = this->idx_hist(this->step_ - history_size + j1);
-                for (int j2 = 0; j2 <= j1; j2++) {
+                for (int j2 = 0; j2 < static_cast<int>(history_size); j2++) {
                     int i2 = this->idx_hist(this->step_ - history_size + j2);
 
-                    S(j2, j1) = S(j1, j2) =
-                        this->template inner_product<normalize>(this->residual_history_[i1], this->residual_history_[i2]);
+                    S(j1, j2) = this->residual_gram(i1, i2);
                 }
             }
 
@@ -43,10 +43,12 @@ template <typename... FUNCS>
 class Linear : public Mixer<FUNCS...>
 {
   public:
-    explicit Linear(double beta)
-        : Mixer<FUNCS...>(2)
+    explicit Linear(double beta, sddk::Communicator const& comm = sddk::Communicator::self())
+        : Mixer<FUNCS...>(2, comm)
         , beta_(beta)
     {
+        /* only the norm of the current residual is needed */
+        this->gram_history_ = 1;
     }
 
     void mix_impl() override
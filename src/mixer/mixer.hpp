@@ -35,13 +35,17 @@
 #include <cmath>
 #include <numeric>
 
+#include "mpi/communicator.hpp"
+
 namespace sirius {
 namespace mixer {
 
 /// Describes operations on a function type used for mixing.
 /** The properties contain functions, which determine the behaviour of a given type during mixing. The inner product
  * function result is used for calculating mixing parameters. If a function should not contribute to generation of
- * mixing parameters, the inner product function should always return 0.
+ * mixing parameters, the inner product function should always return 0. If the local inner product function is
+ * provided, it is used instead of the inner product function and the local contributions of all functions are
+ * reduced at once over the communicator of the mixer.
  */
 template <typename FUNC>
 struct FunctionProperties
@@ -55,17 +59,21 @@ struct FunctionProperties
      *  \param [in]  scal_         Function, which scales the input (x = alpha * x).
      *  \param [in]  copy_         Function, which copies from one object to the other (y = x).
      *  \param [in]  axpy_         Function, which scales and adds one object to the other (y = alpha * x + y).
+     *  \param [in]  inner_local_  Optional function, which computes the local contribution to the inner product
+     *                             without the reduction.
      */
     FunctionProperties(std::function<double(const FUNC&)> size_,
                        std::function<double(const FUNC&, const FUNC&)> inner_,
                        std::function<void(double, FUNC&)> scal_,
                        std::function<void(const FUNC&, FUNC&)> copy_,
-                       std::function<void(double, const FUNC&, FUNC&)> axpy_)
+                       std::function<void(double, const FUNC&, FUNC&)> axpy_,
+                       std::function<double(const FUNC&, const FUNC&)> inner_local_ = nullptr)
         : size(size_)
         , inner(inner_)
         , scal(scal_)
         , copy(copy_)
         , axpy(axpy_)
+        , inner_local(inner_local_)
     {
     }
 
@@ -92,59 +100,85 @@ struct FunctionProperties
 
     // axpy function. y = alpha * x + y
     std::function<void(double, const FUNC&, FUNC&)> axpy;
+
+    // Local part of the inner product (optional). The mixer performs the reduction.
+    std::function<double(const FUNC&, const FUNC&)> inner_local;
 };
 
 // Implementation of templated recursive calls through tuples
 namespace mixer_impl {
 
+/// Contributions to the inner product <x|y> of two tuples of functions.
+struct InnerProductParts
+{
+    /// Local contributions, which must be reduced over the communicator of the mixer.
+    double local{0};
+    /// Local contributions normalized by the size of each function.
+    double local_normalized{0};
+    /// Contributions, which are already reduced.
+    double global{0};
+    /// Reduced contributions normalized by the size of each function.
+    double global_normalized{0};
+};
+
 /// Compute inner product <x|y> between pairs of functions in tuples and accumulate in the result.
-/** This function is used in Broyden mixers to compute inner products of residuals. */
-template <std::size_t FUNC_REVERSE_INDEX, bool normalize, typename... FUNCS>
+/** This function is used in the mixers to compute inner products of residuals. Plain and normalized contributions
+ *  are accumulated at the same time, so each pair of functions is visited only once. */
+template <std::size_t FUNC_REVERSE_INDEX, typename... FUNCS>
 struct InnerProduct
 {
-    static double apply(const std::tuple<FunctionProperties<FUNCS>...>& function_prop,
-                        const std::tuple<std::unique_ptr<FUNCS>...>& x, const std::tuple<std::unique_ptr<FUNCS>...>& y)
+    static void apply(const std::tuple<FunctionProperties<FUNCS>...>& function_prop,
+                      const std::tuple<std::unique_ptr<FUNCS>...>& x, const std::tuple<std::unique_ptr<FUNCS>...>& y,
+                      InnerProductParts& result)
     {
-        double result = 0.0;
+        auto& prop = std::get<FUNC_REVERSE_INDEX>(function_prop);
         if (std::get<FUNC_REVERSE_INDEX>(x) && std::get<FUNC_REVERSE_INDEX>(y)) {
-            /* compute inner product */
-            auto v = std::get<FUNC_REVERSE_INDEX>(function_prop)
-                          .inner(*std::get<FUNC_REVERSE_INDEX>(x), *std::get<FUNC_REVERSE_INDEX>(y));
-            /* normalize if necessary */
-            if (normalize) {
-                auto sx = std::get<FUNC_REVERSE_INDEX>(function_prop).size(*std::get<FUNC_REVERSE_INDEX>(x));
-                auto sy = std::get<FUNC_REVERSE_INDEX>(function_prop).size(*std::get<FUNC_REVERSE_INDEX>(y));
-                if (sx != sy) {
-                    throw std::runtime_error("[sirius::mixer::InnerProduct] sizes of two functions don't match");
-                }
-                v /= sx;
+            auto const& fx = *std::get<FUNC_REVERSE_INDEX>(x);
+            auto const& fy = *std::get<FUNC_REVERSE_INDEX>(y);
+            auto sx = prop.size(fx);
+            auto sy = prop.size(fy);
+            if (sx != sy) {
+                throw std::runtime_error("[sirius::mixer::InnerProduct] sizes of two functions don't match");
+            }
+            if (prop.inner_local) {
+                auto v = prop.inner_local(fx, fy);
+                result.local += v;
+                result.local_normalized += v / sx;
+            } else {
+                auto v = prop.inner(fx, fy);
+                result.global += v;
+                result.global_normalized += v / sx;
             }
-
-            result += v;
         }
-        return result + InnerProduct<FUNC_REVERSE_INDEX - 1, normalize, FUNCS...>::apply(function_prop, x, y);
+        InnerProduct<FUNC_REVERSE_INDEX - 1, FUNCS...>::apply(function_prop, x, y, result);
     }
 };
 
-template <bool normalize, typename... FUNCS>
-struct InnerProduct<0, normalize, FUNCS...>
+template <typename... FUNCS>
+struct InnerProduct<0, FUNCS...>
 {
-    static double apply(const std::tuple<FunctionProperties<FUNCS>...>& function_prop,
-                        const std::tuple<std::unique_ptr<FUNCS>...>& x, const std::tuple<std::unique_ptr<FUNCS>...>& y)
+    static void apply(const std::tuple<FunctionProperties<FUNCS>...>& function_prop,
+                      const std::tuple<std::unique_ptr<FUNCS>...>& x, const std::tuple<std::unique_ptr<FUNCS>...>& y,
+                      InnerProductParts& result)
     {
+        auto& prop = std::get<0>(function_prop);
         if (std::get<0>(x) && std::get<0>(y)) {
-            auto v = std::get<0>(function_prop).inner(*std::get<0>(x), *std::get<0>(y));
-            if (normalize) {
-                auto sx = std::get<0>(function_prop).size(*std::get<0>(x));
-                auto sy = std::get<0>(function_prop).size(*std::get<0>(y));
-                if (sx != sy) {
-                    throw std::runtime_error("[sirius::mixer::InnerProduct] sizes of two functions don't match");
-                }
-                v /= sx;
+            auto const& fx = *std::get<0>(x);
+            auto const& fy = *std::get<0>(y);
+            auto sx = prop.size(fx);
+            auto sy = prop.size(fy);
+            if (sx != sy) {
+                throw std::runtime_error("[sirius::mixer::InnerProduct] sizes of two functions don't match");
+            }
+            if (prop.inner_local) {
+                auto v = prop.inner_local(fx, fy);
+                result.local += v;
+                result.local_normalized += v / sx;
+            } else {
+                auto v = prop.inner(fx, fy);
+                result.global += v;
+                result.global_normalized += v / sx;
             }
-            return v;
-        } else {
-            return 0;
         }
     }
 };
@@ -242,12 +276,15 @@ class Mixer
 
     /// Construct a mixer. Functions have to initialized individually.
     /** \param [in]  max_history   Maximum number of steps stored, which contribute to the mixing.
-     *  \param [in]  commm         Communicator used for exchaning mixing contributions.
+     *  \param [in]  comm          Communicator used for exchaning mixing contributions.
      */
-    Mixer(std::size_t max_history)
+    Mixer(std::size_t max_history, sddk::Communicator const& comm = sddk::Communicator::self())
         : step_(0)
         , max_history_(max_history)
+        , comm_(comm)
         , rmse_history_(max_history)
+        , gram_history_(max_history)
+        , residual_gram_(max_history * max_history, 0)
         , output_history_(max_history)
         , residual_history_(max_history)
     {
@@ -352,15 +389,31 @@ class Mixer
         this->axpy(-1.0, output_history_[idx_hist(step_)], residual_history_[idx_hist(step_)]);
     }
 
-    // update rmse histroy for current step. Residuals must have been updated before.
+    // update rmse histroy and the residual Gram matrix for current step. Residuals must have been updated before.
     void update_rms()
     {
         const auto idx = idx_hist(step_);
 
-        /* compute sum of inner products; each inner product is normalized */
-        double rmse = inner_product<true>(residual_history_[idx], residual_history_[idx]);
+        /* number of residuals, which are paired with the current one: itself and the stored previous ones */
+        const auto n = std::min(step_, gram_history_ - 1) + 1;
+
+        /* only the inner products with the new residual are computed; the rest of the Gram matrix is kept from the
+         * previous steps */
+        std::vector<mixer_impl::InnerProductParts> parts(n);
+        for (std::size_t k = 0; k < n; k++) {
+            parts[k] = inner_product_parts(residual_history_[idx], residual_history_[idx_hist(step_ - k)]);
+        }
+        reduce_inner_products(parts);
+
+        for (std::size_t k = 0; k < n; k++) {
+            residual_gram(idx, idx_hist(step_ - k)) = residual_gram(idx_hist(step_ - k), idx) =
+                parts[k].local + parts[k].global;
+        }
+
+        /* sum of inner products; each inner product is normalized */
+        double rmse = parts[0].local_normalized + parts[0].global_normalized;
 
-        rmse_history_[idx_hist(step_)] = std::sqrt(rmse);
+        rmse_history_[idx] = std::sqrt(rmse);
     }
 
     // Storage index of given step
@@ -369,11 +422,50 @@ class Mixer
         return step % max_history_;
     }
 
+    // Inner product of the residuals stored at two history indices.
+    double& residual_gram(std::size_t idx1, std::size_t idx2)
+    {
+        return residual_gram_[idx1 + idx2 * max_history_];
+    }
+
+    // Local and reduced contributions to the inner product <x|y>.
+    mixer_impl::InnerProductParts inner_product_parts(const std::tuple<std::unique_ptr<FUNCS>...>& x,
+                                                      const std::tuple<std::unique_ptr<FUNCS>...>& y)
+    {
+        mixer_impl::InnerProductParts result;
+        mixer_impl::InnerProduct<sizeof...(FUNCS) - 1, FUNCS...>::apply(functions_, x, y, result);
+        return result;
+    }
+
+    // Reduce local contributions of a batch of inner products with a single allreduce.
+    void reduce_inner_products(std::vector<mixer_impl::InnerProductParts>& parts)
+    {
+        if (comm_.mpi_comm() == MPI_COMM_SELF) {
+            return;
+        }
+        std::vector<double> buf(2 * parts.size());
+        for (std::size_t k = 0; k < parts.size(); k++) {
+            buf[2 * k]     = parts[k].local;
+            buf[2 * k + 1] = parts[k].local_normalized;
+        }
+        comm_.allreduce(buf.data(), static_cast<int>(buf.size()));
+        for (std::size_t k = 0; k < parts.size(); k++) {
+            parts[k].local            = buf[2 * k];
+            parts[k].local_normalized = buf[2 * k + 1];
+        }
+    }
+
     template <bool normalize>
     double inner_product(const std::tuple<std::unique_ptr<FUNCS>...>& x,
                          const std::tuple<std::unique_ptr<FUNCS>...>& y)
     {
-        return mixer_impl::InnerProduct<sizeof...(FUNCS) - 1, normalize, FUNCS...>::apply(functions_, x, y);
+        mixer_impl::InnerProductParts result;
+        mixer_impl::InnerProduct<sizeof...(FUNCS) - 1, FUNCS...>::apply(functions_, x, y, result);
+        double v = normalize ? result.local_normalized : result.local;
+        if (comm_.mpi_comm() != MPI_COMM_SELF) {
+            comm_.allreduce(&v, 1);
+        }
+        return v + (normalize ? result.global_normalized : result.global);
     }
 
     void scale(double alpha, std::tuple<std::unique_ptr<FUNCS>...>& x)
@@ -397,9 +489,18 @@ class Mixer
     // The maximum history size kept for each function
     std::size_t max_history_;
 
+    // Communicator used for the reduction of local inner products
+    sddk::Communicator const& comm_;
+
     // Properties, describing the each function type
     std::vector<double> rmse_history_;
 
+    // Number of the most recent residuals, for which the inner products are kept
+    std::size_t gram_history_;
+
+    // Inner products of the stored residuals, indexed by the history storage index
+    std::vector<double> residual_gram_;
+
     // Properties, describing the each function type
     std::tuple<FunctionProperties<FUNCS>...> functions_;
 
@@ -41,6 +41,10 @@ FunctionProperties<Periodic_function<double>> periodic_function_property()
         return sirius::inner(x, y);
     };
 
+    auto inner_prod_local_func = [](const Periodic_function<double>& x, const Periodic_function<double>& y) -> double {
+        return sirius::inner_local(x, y);
+    };
+
     auto scal_function = [](double alpha, Periodic_function<double>& x) -> void {
         #pragma omp parallel
         {
@@ -103,7 +107,7 @@ FunctionProperties<Periodic_function<double>> periodic_function_property()
     };
 
     return FunctionProperties<Periodic_function<double>>(global_size_func, inner_prod_func, scal_function, copy_function,
-                                                         axpy_function);
+                                                         axpy_function, inner_prod_local_func);
 }
 
 FunctionProperties<Periodic_function<double>> periodic_function_property_modified(bool use_coarse_gvec__)
@@ -113,7 +117,7 @@ FunctionProperties<Periodic_function<double>> periodic_function_property_modifie
         return x.ctx().unit_cell().omega();
     };
 
-    auto inner_prod_func = [use_coarse_gvec__](Periodic_function<double> const& x, Periodic_function<double> const& y) -> double {
+    auto inner_prod_local_func = [use_coarse_gvec__](Periodic_function<double> const& x, Periodic_function<double> const& y) -> double {
         double result{0};
         int ig0 = (x.ctx().comm().rank() == 0) ? 1 : 0;
         if (use_coarse_gvec__) {
@@ -137,6 +141,11 @@ FunctionProperties<Periodic_function<double>> periodic_function_property_modifie
             result *= 2;
         }
         result *= fourpi;
+        return result;
+    };
+
+    auto inner_prod_func = [inner_prod_local_func](Periodic_function<double> const& x, Periodic_function<double> const& y) -> double {
+        double result = inner_prod_local_func(x, y);
         x.ctx().comm().allreduce(&result, 1);
         return result;
     };
@@ -215,7 +224,7 @@ FunctionProperties<Periodic_function<double>> periodic_function_property_modifie
     };
 
     return FunctionProperties<Periodic_function<double>>(global_size_func, inner_prod_func, scal_function, copy_function,
-                                                         axpy_function);
+                                                         axpy_function, inner_prod_local_func);
 }
 
 FunctionProperties<sddk::mdarray<double_complex, 4>> density_function_property()
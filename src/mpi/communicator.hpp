@@ -375,6 +375,17 @@ class Communicator
         return new_comm;
     }
 
+    /// Split the communicator into groups of ranks which can share memory (ranks of the same node).
+    inline Communicator split_shared() const
+    {
+        Communicator new_comm;
+        new_comm.mpi_comm_ = std::unique_ptr<MPI_Comm, mpi_comm_deleter>(new MPI_Comm);
+        CALL_MPI(MPI_Comm_split_type, (mpi_comm(), MPI_COMM_TYPE_SHARED, rank(), MPI_INFO_NULL,
+                                       new_comm.mpi_comm_.get()));
+        new_comm.mpi_comm_raw_ = *new_comm.mpi_comm_;
+        return new_comm;
+    }
+
     inline Communicator duplicate() const
     {
         Communicator new_comm;
@@ -731,6 +742,17 @@ class Communicator
                                  recvcounts__, rdispls__, mpi_type_wrapper<T>::kind(), mpi_comm()));
     }
 
+    template <typename T>
+    void ialltoall(T const* sendbuf__, int const* sendcounts__, int const* sdispls__, T* recvbuf__,
+                   int const* recvcounts__, int const* rdispls__, MPI_Request* req__) const
+    {
+#if defined(__PROFILE_MPI)
+        PROFILE("MPI_Ialltoallv");
+#endif
+        CALL_MPI(MPI_Ialltoallv, (sendbuf__, sendcounts__, sdispls__, mpi_type_wrapper<T>::kind(), recvbuf__,
+                                  recvcounts__, rdispls__, mpi_type_wrapper<T>::kind(), mpi_comm(), req__));
+    }
+
     //==alltoall_descriptor map_alltoall(std::vector<int> local_sizes_in, std::vector<int> local_sizes_out) const
     //=={
     //==    alltoall_descriptor a2a;
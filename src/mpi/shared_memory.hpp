@@ -0,0 +1,152 @@
+// Copyright (c) 2013-2020 Anton Kozhevnikov, Thomas Schulthess
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+// the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+//    following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+//    and the following disclaimer in the documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** \file shared_memory.hpp
+ *
+ *  \brief Allocation of read-only arrays in the MPI-3 shared-memory window of a node.
+ */
+
+#ifndef __SHARED_MEMORY_HPP__
+#define __SHARED_MEMORY_HPP__
+
+#include "mpi/communicator.hpp"
+#include "SDDK/memory.hpp"
+
+namespace sddk {
+
+/// Deleter for the memory allocated in the MPI-3 shared-memory window.
+class mpi_shared_memory_deleter : public memory_t_deleter_base
+{
+  protected:
+    class mpi_shared_memory_deleter_impl : public memory_t_deleter_base_impl
+    {
+      protected:
+        MPI_Win win_{MPI_WIN_NULL};
+
+      public:
+        mpi_shared_memory_deleter_impl(MPI_Win win__)
+            : win_(win__)
+        {
+        }
+        /// Close the access epoch and free the window; this is a collective operation on the node communicator.
+        inline void free(void* ptr__)
+        {
+            if (win_ != MPI_WIN_NULL && !Communicator::is_finalized()) {
+                CALL_MPI(MPI_Win_unlock_all, (win_));
+                CALL_MPI(MPI_Win_free, (&win_));
+            }
+        }
+    };
+
+  public:
+    explicit mpi_shared_memory_deleter(MPI_Win win__)
+    {
+        impl_ = std::unique_ptr<memory_t_deleter_base_impl>(new mpi_shared_memory_deleter_impl(win__));
+    }
+};
+
+/// Allocate n elements in the shared-memory window of the node communicator.
+/** The memory is physically allocated by the rank 0 of the node communicator; all other ranks get a pointer to the
+ *  same block. A passive-target access epoch (MPI_Win_lock_all) is opened for the lifetime of the window, so that
+ *  the ranks can be synchronized with MPI_Win_sync. This is a collective operation. */
+template <typename T>
+inline std::unique_ptr<T, memory_t_deleter_base>
+get_shared_unique_ptr(size_t n__, Communicator const& comm_node__, MPI_Win* win__ = nullptr)
+{
+    MPI_Aint size = (comm_node__.rank() == 0) ? static_cast<MPI_Aint>(n__ * sizeof(T)) : 0;
+    T* ptr{nullptr};
+    MPI_Win win;
+    CALL_MPI(MPI_Win_allocate_shared, (size, sizeof(T), MPI_INFO_NULL, comm_node__.mpi_comm(), &ptr, &win));
+
+    /* get the address of the block owned by the rank 0 */
+    MPI_Aint size0;
+    int disp_unit;
+    CALL_MPI(MPI_Win_shared_query, (win, 0, &size0, &disp_unit, &ptr));
+
+    CALL_MPI(MPI_Win_lock_all, (MPI_MODE_NOCHECK, win));
+
+    if (win__) {
+        *win__ = win;
+    }
+
+    return std::unique_ptr<T, memory_t_deleter_base>(ptr, mpi_shared_memory_deleter(win));
+}
+
+/// Handle to the shared-memory window of an array allocated by allocate_node_shared().
+/** The handle does not own the window; the window is freed together with the array. */
+class node_shared_window
+{
+  private:
+    /// Window of the array or MPI_WIN_NULL if the array is in the private memory of the rank.
+    MPI_Win win_{MPI_WIN_NULL};
+
+    /// True if the data has to be written by this rank.
+    bool writer_{true};
+
+  public:
+    node_shared_window()
+    {
+    }
+
+    node_shared_window(MPI_Win win__, bool writer__)
+        : win_(win__)
+        , writer_(writer__)
+    {
+    }
+
+    /// Return true if the data has to be written by the calling rank.
+    inline bool writer() const
+    {
+        return writer_;
+    }
+
+    /// Make the data written by the node leader visible to all ranks of the node.
+    /** Standard synchronization of the unified memory model of shared windows: the writer completes its stores
+     *  with MPI_Win_sync, the barrier orders the ranks and the readers update their view of the window with the
+     *  second MPI_Win_sync. This is a collective operation on the node communicator. */
+    inline void sync(Communicator const& comm_node__) const
+    {
+        if (win_ != MPI_WIN_NULL) {
+            CALL_MPI(MPI_Win_sync, (win_));
+            comm_node__.barrier();
+            CALL_MPI(MPI_Win_sync, (win_));
+        }
+    }
+};
+
+/// Allocate the host memory of an array which stores the same read-only data on all ranks of a node.
+/** If the node communicator has more than one rank the array is placed in the shared-memory window and only the
+ *  rank 0 of the node communicator has to fill it; otherwise the ordinary host memory is allocated. The returned
+ *  handle tells if the data has to be written by the calling rank. After the data is written, the ranks must be
+ *  synchronized with node_shared_window::sync() before the array is read. */
+template <typename T, int N>
+inline node_shared_window allocate_node_shared(mdarray<T, N>& a__, Communicator const& comm_node__)
+{
+    if (comm_node__.size() == 1 || !a__.size()) {
+        a__.allocate(memory_t::host);
+        return node_shared_window();
+    }
+    MPI_Win win;
+    a__.allocate(get_shared_unique_ptr<T>(a__.size(), comm_node__, &win));
+    return node_shared_window(win, comm_node__.rank() == 0);
+}
+
+} // namespace sddk
+
+#endif // __SHARED_MEMORY_HPP__
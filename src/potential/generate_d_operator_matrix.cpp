@@ -145,10 +145,18 @@ void Potential::generate_D_operator_matrix()
                     s << "Gvec_block_" << ib << "_veff_a";
                     utils::print_checksum(s.str(), cs);
                 }
+                /* plane-wave coefficients of Q for this block of G-vectors */
+                mdarray<double, 2> q_pw;
+                double const* q_pw_ptr{nullptr};
+                if (ctx_.processing_unit() == device_t::GPU) {
+                    q_pw_ptr = ctx_.augmentation_op(iat)->q_pw().at(mem, 0, 2 * g_begin);
+                } else {
+                    q_pw = ctx_.augmentation_op(iat)->q_pw_block(g_begin, g_end, ctx_.mem_pool(memory_t::host));
+                    q_pw_ptr = q_pw.at(memory_t::host);
+                }
                 linalg(la).gemm('N', 'N', nbf * (nbf + 1) / 2, atom_type.num_atoms(), 2 * spl_ngv_loc.local_size(ib),
                                   &linalg_const<double>::one(),
-                                  ctx_.augmentation_op(iat)->q_pw().at(mem, 0, 2 * g_begin),
-                                  ctx_.augmentation_op(iat)->q_pw().ld(),
+                                  q_pw_ptr, nbf * (nbf + 1) / 2,
                                   veff_a.at(mem), veff_a.ld(),
                                   &linalg_const<double>::one(),
                                   d_tmp.at(mem), d_tmp.ld(),
@@ -161,10 +169,10 @@ void Potential::generate_D_operator_matrix()
 
             if (ctx_.gvec().reduced()) {
                 if (comm_.rank() == 0) {
+                    auto q_pw0 = ctx_.augmentation_op(iat)->q_pw_block(0, 1, ctx_.mem_pool(memory_t::host));
                     for (int i = 0; i < atom_type.num_atoms(); i++) {
                         for (int j = 0; j < nbf * (nbf + 1) / 2; j++) {
-                            d_tmp(j, i) = 2 * d_tmp(j, i) - component(iv).f_pw_local(0).real() *
-                                ctx_.augmentation_op(iat)->q_pw(j, 0);
+                            d_tmp(j, i) = 2 * d_tmp(j, i) - component(iv).f_pw_local(0).real() * q_pw0(j, 0);
                         }
                     }
                 } else {
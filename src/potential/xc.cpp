@@ -65,14 +65,15 @@ void xc_mt_nonmagnetic(Radial_grid<double> const& rgrid__, SHT const& sht__, std
             transform(sht__, grad_rho_lm[x], grad_rho_tp[x]);
         }
         /* compute density gradient product */
-        grad_rho_grad_rho_tp = grad_rho_tp * grad_rho_tp;
+        grad_rho_grad_rho_tp = Ftp(sht__.num_points(), rgrid__);
+        dot(grad_rho_tp, grad_rho_tp, grad_rho_grad_rho_tp);
         assert(rho_tp__.size() == grad_rho_grad_rho_tp.size());
 
         vsigma_tp = Ftp(sht__.num_points(), rgrid__);
         assert(rho_tp__.size() == vsigma_tp.size());
         if (use_lapl) {
             /* backward transform Laplacian from Rlm to (theta, phi) */
-            auto lapl_rho_tp = transform(sht__, laplacian(rho_lm__));
+            lapl_rho_tp = transform(sht__, laplacian(rho_lm__));
             assert(lapl_rho_tp.size() == rho_tp__.size());
         }
     }
@@ -92,7 +93,7 @@ void xc_mt_nonmagnetic(Radial_grid<double> const& rgrid__, SHT const& sht__, std
                 exc_tp.at(memory_t::host));
 
             if (use_lapl) {
-                vxc_tp -= 2.0 * vsigma_tp * lapl_rho_tp;
+                pointwise(vxc_tp, [&](size_t i) { return vxc_tp[i] - 2.0 * vsigma_tp[i] * lapl_rho_tp[i]; });
 
                 /* compute gradient of vsgima in spherical harmonics */
                 auto grad_vsigma_lm = gradient(transform(sht__, vsigma_tp));
@@ -103,19 +104,24 @@ void xc_mt_nonmagnetic(Radial_grid<double> const& rgrid__, SHT const& sht__, std
                     transform(sht__, grad_vsigma_lm[x], grad_vsigma_tp[x]);
                 }
 
-                /* compute scalar product of two gradients */
-                auto grad_vsigma_grad_rho_tp = grad_vsigma_tp * grad_rho_tp;
-                /* add remaining term to Vxc */
-                vxc_tp -= 2.0 * grad_vsigma_grad_rho_tp;
+                /* add scalar product of two gradients to Vxc */
+                pointwise(vxc_tp, [&](size_t i) {
+                    return vxc_tp[i] - 2.0 * (grad_vsigma_tp[0][i] * grad_rho_tp[0][i] +
+                                              grad_vsigma_tp[1][i] * grad_rho_tp[1][i] +
+                                              grad_vsigma_tp[2][i] * grad_rho_tp[2][i]);
+                });
             } else {
                 Spheric_vector_function<function_domain_t::spectral, double> vsigma_grad_rho_lm(sht__.lmmax(), rgrid__);
+                /* the same buffer is reused for each Cartesian component */
+                Ftp vsigma_grad_rho_tp(sht__.num_points(), rgrid__);
                 for (int x: {0, 1, 2}) {
-                    auto vsigma_grad_rho_tp = vsigma_tp * grad_rho_tp[x];
+                    auto& grad_rho_x = grad_rho_tp[x];
+                    pointwise(vsigma_grad_rho_tp, [&](size_t i) { return vsigma_tp[i] * grad_rho_x[i]; });
                     transform(sht__, vsigma_grad_rho_tp, vsigma_grad_rho_lm[x]);
                 }
                 auto div_vsigma_grad_rho_tp = transform(sht__, divergence(vsigma_grad_rho_lm));
                 /* add remaining term to Vxc */
-                vxc_tp -= 2.0 * div_vsigma_grad_rho_tp;
+                pointwise(vxc_tp, [&](size_t i) { return vxc_tp[i] - 2.0 * div_vsigma_grad_rho_tp[i]; });
             }
         }
         exc_lm__ += transform(sht__, exc_tp);
@@ -190,9 +196,12 @@ void xc_mt_magnetic(Radial_grid<double> const& rgrid__, SHT const& sht__, int nu
             transform(sht__, grad_rho_dn_lm[x], grad_rho_dn_tp[x]);
         }
         /* compute density gradient products */
-        grad_rho_up_grad_rho_up_tp = grad_rho_up_tp * grad_rho_up_tp;
-        grad_rho_up_grad_rho_dn_tp = grad_rho_up_tp * grad_rho_dn_tp;
-        grad_rho_dn_grad_rho_dn_tp = grad_rho_dn_tp * grad_rho_dn_tp;
+        grad_rho_up_grad_rho_up_tp = Ftp(sht__.num_points(), rgrid__);
+        grad_rho_up_grad_rho_dn_tp = Ftp(sht__.num_points(), rgrid__);
+        grad_rho_dn_grad_rho_dn_tp = Ftp(sht__.num_points(), rgrid__);
+        dot(grad_rho_up_tp, grad_rho_up_tp, grad_rho_up_grad_rho_up_tp);
+        dot(grad_rho_up_tp, grad_rho_dn_tp, grad_rho_up_grad_rho_dn_tp);
+        dot(grad_rho_dn_tp, grad_rho_dn_tp, grad_rho_dn_grad_rho_dn_tp);
 
         vsigma_uu_tp = Ftp(sht__.num_points(), rgrid__);
         vsigma_ud_tp = Ftp(sht__.num_points(), rgrid__);
@@ -218,8 +227,12 @@ void xc_mt_magnetic(Radial_grid<double> const& rgrid__, SHT const& sht__, int nu
                     vsigma_ud_tp.at(memory_t::host), vsigma_dd_tp.at(memory_t::host), exc_tp.at(memory_t::host));
 
             /* directly add to Vxc available contributions */
-            vxc_up_tp -= (2.0 * vsigma_uu_tp * lapl_rho_up_tp + vsigma_ud_tp * lapl_rho_dn_tp);
-            vxc_dn_tp -= (2.0 * vsigma_dd_tp * lapl_rho_dn_tp + vsigma_ud_tp * lapl_rho_up_tp);
+            pointwise(vxc_up_tp, [&](size_t i) {
+                return vxc_up_tp[i] - (2.0 * vsigma_uu_tp[i] * lapl_rho_up_tp[i] + vsigma_ud_tp[i] * lapl_rho_dn_tp[i]);
+            });
+            pointwise(vxc_dn_tp, [&](size_t i) {
+                return vxc_dn_tp[i] - (2.0 * vsigma_dd_tp[i] * lapl_rho_dn_tp[i] + vsigma_ud_tp[i] * lapl_rho_up_tp[i]);
+            });
 
             /* forward transform vsigma to Rlm */
             auto vsigma_uu_lm = transform(sht__, vsigma_uu_tp);
@@ -241,15 +254,20 @@ void xc_mt_magnetic(Radial_grid<double> const& rgrid__, SHT const& sht__, int nu
                 grad_vsigma_dd_tp[x] = transform(sht__, grad_vsigma_dd_lm[x]);
             }
 
-            /* compute scalar product of two gradients */
-            auto grad_vsigma_uu_grad_rho_up_tp = grad_vsigma_uu_tp * grad_rho_up_tp;
-            auto grad_vsigma_dd_grad_rho_dn_tp = grad_vsigma_dd_tp * grad_rho_dn_tp;
-            auto grad_vsigma_ud_grad_rho_up_tp = grad_vsigma_ud_tp * grad_rho_up_tp;
-            auto grad_vsigma_ud_grad_rho_dn_tp = grad_vsigma_ud_tp * grad_rho_dn_tp;
-
-            /* add remaining terms to Vxc */
-            vxc_up_tp -= (2.0 * grad_vsigma_uu_grad_rho_up_tp + grad_vsigma_ud_grad_rho_dn_tp);
-            vxc_dn_tp -= (2.0 * grad_vsigma_dd_grad_rho_dn_tp + grad_vsigma_ud_grad_rho_up_tp);
+            /* add scalar products of gradients to Vxc */
+            auto dot_tp = [](Spheric_vector_function<function_domain_t::spatial, double> const& f,
+                             Spheric_vector_function<function_domain_t::spatial, double> const& g, size_t i)
+            {
+                return f[0][i] * g[0][i] + f[1][i] * g[1][i] + f[2][i] * g[2][i];
+            };
+            pointwise(vxc_up_tp, [&](size_t i) {
+                return vxc_up_tp[i] - (2.0 * dot_tp(grad_vsigma_uu_tp, grad_rho_up_tp, i) +
+                                       dot_tp(grad_vsigma_ud_tp, grad_rho_dn_tp, i));
+            });
+            pointwise(vxc_dn_tp, [&](size_t i) {
+                return vxc_dn_tp[i] - (2.0 * dot_tp(grad_vsigma_dd_tp, grad_rho_dn_tp, i) +
+                                       dot_tp(grad_vsigma_ud_tp, grad_rho_up_tp, i));
+            });
         }
         /* genertate magnetic filed and effective potential inside MT sphere */
         for (int ir = 0; ir < rgrid__.num_points(); ir++) {
@@ -27,6 +27,7 @@
 
 #include "unit_cell/unit_cell.hpp"
 #include "specfunc/sbessel.hpp"
+#include "mpi/shared_memory.hpp"
 
 namespace sirius {
 
@@ -163,11 +164,55 @@ class Radial_integrals_aug : public Radial_integrals_base<3>
   private:
     std::function<void(int, double, double*, int, int)> ri_callback_{nullptr};
 
+    /// Maximum number of pairs of radial functions.
+    int nidx_{0};
+
+    /// Flat copy of the spline coefficients of all radial integrals.
+    /** The coefficients are stored as coeffs_(k, iq, idx + nidx_ * l, iat), where k is the power of dq in the
+     *  cubic polynomial of the interval iq. This is the largest replicated table of the radial integrals; with
+     *  more than one rank per node it is placed in the node shared-memory window and the spline objects are
+     *  released after the copy. */
+    sddk::mdarray<double, 4> coeffs_;
+
     void generate();
 
+    /// Copy the spline coefficients to the flat table and release the splines.
+    void flatten(sddk::Communicator const& comm_node__)
+    {
+        int nl = static_cast<int>(values_.size(1));
+
+        coeffs_ = sddk::mdarray<double, 4>(4, nq(), nidx_ * nl, unit_cell_.num_atom_types(), sddk::memory_t::none,
+                                           "Radial_integrals_aug::coeffs_");
+        auto win = sddk::allocate_node_shared(coeffs_, comm_node__);
+        if (win.writer()) {
+            coeffs_.zero();
+            for (int iat = 0; iat < unit_cell_.num_atom_types(); iat++) {
+                for (int l = 0; l < nl; l++) {
+                    for (int idx = 0; idx < nidx_; idx++) {
+                        auto& s = values_(idx, l, iat);
+                        if (!s.num_points()) {
+                            continue;
+                        }
+                        for (int k = 0; k < 4; k++) {
+                            for (int iq = 0; iq < nq(); iq++) {
+                                coeffs_(k, iq, idx + nidx_ * l, iat) = s.coeffs()(iq, k);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        win.sync(comm_node__);
+
+        values_ = sddk::mdarray<Spline<double>, 3>();
+    }
+
   public:
+    /// Constructor.
+    /** If the node communicator is given, the table of spline coefficients is shared by the ranks of the node. */
     Radial_integrals_aug(Unit_cell const& unit_cell__, double qmax__, int np__,
-        std::function<void(int, double, double*, int, int)> ri_callback__)
+        std::function<void(int, double, double*, int, int)> ri_callback__,
+        sddk::Communicator const& comm_node__ = sddk::Communicator::self())
         : Radial_integrals_base<3>(unit_cell__, qmax__, np__)
         , ri_callback_(ri_callback__)
     {
@@ -175,9 +220,13 @@ class Radial_integrals_aug : public Radial_integrals_base<3>
             int nmax = unit_cell_.max_mt_radial_basis_size();
             int lmax = unit_cell_.lmax();
 
-            values_ = sddk::mdarray<Spline<double>, 3>(nmax * (nmax + 1) / 2, 2 * lmax + 1, unit_cell_.num_atom_types());
+            nidx_ = nmax * (nmax + 1) / 2;
+
+            values_ = sddk::mdarray<Spline<double>, 3>(nidx_, 2 * lmax + 1, unit_cell_.num_atom_types());
 
             generate();
+
+            flatten(comm_node__);
         }
     }
 
@@ -192,9 +241,12 @@ class Radial_integrals_aug : public Radial_integrals_base<3>
         if (ri_callback_ == nullptr) {
             auto idx = iqdq(q__);
 
+            double dq = idx.second;
+
             for (int l = 0; l <= 2 * lmax; l++) {
                 for (int i = 0; i < nbrf * (nbrf + 1) / 2; i++) {
-                    val(i, l) = values_(i, l, iat__)(idx.first, idx.second);
+                    auto c = coeffs_.at(sddk::memory_t::host, 0, idx.first, i + nidx_ * l, iat__);
+                    val(i, l) = c[0] + dq * (c[1] + dq * (c[2] + dq * c[3]));
                 }
             }
         } else {
@@ -240,8 +240,9 @@ splindex<splindex_t::block> Simulation_context::split_gvec_local() const
 
         ld = std::max(ld, std::max(nbf * (nbf + 1) / 2, nat));
     }
-    /* limit the size of relevant array to ~1Gb */
-    int ngv_b = (1 << 30) / sizeof(double_complex) / ld;
+    /* limit the size of relevant array to ~1Gb, or to ~128Mb with low memory usage */
+    size_t max_size = (control().memory_usage_ == "low") ? (1 << 27) : (1 << 30);
+    int ngv_b = static_cast<int>(max_size / sizeof(double_complex) / ld);
     ngv_b = std::max(1, std::min(ngv_loc, ngv_b));
     /* number of blocks of G-vectors */
     int nb = ngv_loc / ngv_b;
@@ -284,6 +285,13 @@ void Simulation_context::initialize()
     /* initialize MPI communicators */
     init_comm();
 
+    /* set the number of threads for the stages of the calculation */
+    if (control().num_threads_loops_ > 0) {
+        omp_set_num_threads(control().num_threads_loops_);
+    }
+    thread_policy_ = utils::thread_policy(control().num_threads_loops_, control().num_threads_blas_,
+                                          control().num_threads_fft_);
+
     auto print_mpi_layout = utils::get_env<int>("SIRIUS_PRINT_MPI_LAYOUT");
 
     if (control().verbosity_ >= 3 || (print_mpi_layout && *print_mpi_layout)) {
@@ -557,6 +565,11 @@ void Simulation_context::initialize()
         TERMINATE("both solvers must be sequential or parallel");
     }
 
+    if (std_solver.is_parallel() && control().subspace_evp_autotune_) {
+        subspace_evp_solver_ = std::unique_ptr<Eigensolver_auto>(
+            new Eigensolver_auto(std_evp_solver_name(), &mem_pool(memory_t::device)));
+    }
+
     /* setup BLACS grid */
     if (std_solver.is_parallel()) {
         blacs_grid_ = std::unique_ptr<BLACS_grid>(new BLACS_grid(comm_band(), npr, npc));
@@ -613,6 +626,10 @@ void Simulation_context::print_info() const
         std::printf("\n");
     }
     std::printf("maximum number of OMP threads : %i\n", omp_get_max_threads());
+    std::printf("threads of the stages         : %s, %s, %s\n",
+                thread_policy_.label(utils::thread_stage_t::loops).c_str(),
+                thread_policy_.label(utils::thread_stage_t::blas).c_str(),
+                thread_policy_.label(utils::thread_stage_t::fft).c_str());
     std::printf("number of MPI ranks per node  : %i\n", num_ranks_per_node());
     std::printf("page size (Kb)                : %li\n", utils::get_page_size() >> 10);
     std::printf("number of pages               : %li\n", utils::get_num_pages());
@@ -918,12 +935,14 @@ void Simulation_context::update()
         /* radial integrals with pw_cutoff */
         if (!aug_ri_ || aug_ri_->qmax() < new_pw_cutoff) {
             aug_ri_ = std::unique_ptr<Radial_integrals_aug<false>>(
-                new Radial_integrals_aug<false>(unit_cell(), new_pw_cutoff, settings().nprii_aug_, aug_ri_callback_));
+                new Radial_integrals_aug<false>(unit_cell(), new_pw_cutoff, settings().nprii_aug_, aug_ri_callback_,
+                                                comm_node()));
         }
 
         if (!aug_ri_djl_ || aug_ri_djl_->qmax() < new_pw_cutoff) {
             aug_ri_djl_ = std::unique_ptr<Radial_integrals_aug<true>>(
-                new Radial_integrals_aug<true>(unit_cell(), new_pw_cutoff, settings().nprii_aug_, aug_ri_djl_callback_));
+                new Radial_integrals_aug<true>(unit_cell(), new_pw_cutoff, settings().nprii_aug_, aug_ri_djl_callback_,
+                                               comm_node()));
         }
 
         if (!ps_core_ri_ || ps_core_ri_->qmax() < new_pw_cutoff) {
@@ -956,7 +975,8 @@ void Simulation_context::update()
         }
 
         /* radial integrals with pw_cutoff */
-        if (!beta_ri_ || beta_ri_->qmax() < new_gk_cutoff) {
+        bool update_beta_ri = !beta_ri_ || beta_ri_->qmax() < new_gk_cutoff;
+        if (update_beta_ri) {
             beta_ri_ = std::unique_ptr<Radial_integrals_beta<false>>(
                 new Radial_integrals_beta<false>(unit_cell(), new_gk_cutoff, settings().nprii_beta_, beta_ri_callback_));
         }
@@ -966,6 +986,12 @@ void Simulation_context::update()
                 new Radial_integrals_beta<true>(unit_cell(), new_gk_cutoff, settings().nprii_beta_, beta_ri_djl_callback_));
         }
 
+        /* filtered radial functions are rebuilt together with the radial integrals of beta-projectors */
+        if (beta_real_space() && (update_beta_ri || !beta_rs_rf_)) {
+            beta_rs_rf_ = std::unique_ptr<Beta_radial_functions_rs>(
+                new Beta_radial_functions_rs(unit_cell(), gk_cutoff()));
+        }
+
         if (!atomic_wf_ri_ || atomic_wf_ri_->qmax() < new_gk_cutoff) {
             atomic_wf_ri_ = std::unique_ptr<Radial_integrals_atomic_wf<false>>(
                 new Radial_integrals_atomic_wf<false>(unit_cell(), new_gk_cutoff, 20, false));
@@ -1006,9 +1032,13 @@ void Simulation_context::update()
         /* create spfft buffer for coarse transform */
         spfft_grid_coarse_ = std::unique_ptr<spfft::Grid>(
             new spfft::Grid(fft_coarse_grid_[0], fft_coarse_grid_[1], fft_coarse_grid_[2],
-                            gvec_coarse_partition_->zcol_count_fft(), spl_z.local_size(), spfft_pu, -1,
+                            gvec_coarse_partition_->zcol_count_fft(), spl_z.local_size(), spfft_pu,
+                            thread_policy_.num_threads(utils::thread_stage_t::fft),
                             comm_fft_coarse().mpi_comm(), SPFFT_EXCH_DEFAULT));
 
+        spfft_cache_coarse_ = std::unique_ptr<spfft_transform_cache>(
+            new spfft_transform_cache(std::max(0, control().spfft_cache_size_)));
+
         /* create spfft transformations */
         const auto fft_type_coarse = gvec_coarse().reduced() ? SPFFT_TRANS_R2C : SPFFT_TRANS_C2C;
 
@@ -1033,7 +1063,8 @@ void Simulation_context::update()
         /* create spfft buffer for fine-grained transform */
         spfft_grid_ = std::unique_ptr<spfft::Grid>(
             new spfft::Grid(fft_grid_[0], fft_grid_[1], fft_grid_[2],
-                            gvec_partition_->zcol_count_fft(), spl_z.local_size(), spfft_pu, -1,
+                            gvec_partition_->zcol_count_fft(), spl_z.local_size(), spfft_pu,
+                            thread_policy_.num_threads(utils::thread_stage_t::fft),
                             comm_fft().mpi_comm(), SPFFT_EXCH_DEFAULT));
 
         const auto fft_type = gvec().reduced() ? SPFFT_TRANS_R2C : SPFFT_TRANS_C2C;
@@ -1109,6 +1140,10 @@ void Simulation_context::update()
 
     init_atoms_to_grid_idx(control().rmt_max_);
 
+    if (!full_potential() && control().aug_real_space_) {
+        init_atoms_to_grid_aug();
+    }
+
     std::pair<int, int> limits(0, 0);
     for (int x : {0, 1, 2}) {
         limits.first  = std::min(limits.first, fft_grid().limits(x).first);
@@ -1116,16 +1151,20 @@ void Simulation_context::update()
     }
 
     /* recompute phase factors for atoms */
-    phase_factors_ = mdarray<double_complex, 3>(3, limits, unit_cell().num_atoms(), memory_t::host, "phase_factors_");
-    #pragma omp parallel for
-    for (int i = limits.first; i <= limits.second; i++) {
-        for (int ia = 0; ia < unit_cell().num_atoms(); ia++) {
-            auto pos = unit_cell().atom(ia).position();
-            for (int x : {0, 1, 2}) {
-                phase_factors_(x, i, ia) = std::exp(double_complex(0.0, twopi * (i * pos[x])));
+    phase_factors_ = mdarray<double_complex, 3>(3, limits, unit_cell().num_atoms(), memory_t::none, "phase_factors_");
+    auto win = allocate_node_shared(phase_factors_, comm_node());
+    if (win.writer()) {
+        #pragma omp parallel for
+        for (int i = limits.first; i <= limits.second; i++) {
+            for (int ia = 0; ia < unit_cell().num_atoms(); ia++) {
+                auto pos = unit_cell().atom(ia).position();
+                for (int x : {0, 1, 2}) {
+                    phase_factors_(x, i, ia) = std::exp(double_complex(0.0, twopi * (i * pos[x])));
+                }
             }
         }
     }
+    win.sync(comm_node());
 
     /* recompute phase factors for atom types */
     phase_factors_t_ = mdarray<double_complex, 2>(gvec().count(), unit_cell().num_atom_types());
@@ -1143,17 +1182,22 @@ void Simulation_context::update()
     }
 
     if (use_symmetry()) {
-        sym_phase_factors_ = mdarray<double_complex, 3>(3, limits, unit_cell().symmetry().num_mag_sym());
+        sym_phase_factors_ = mdarray<double_complex, 3>(3, limits, unit_cell().symmetry().num_mag_sym(),
+                                                        memory_t::none, "sym_phase_factors_");
 
-        #pragma omp parallel for
-        for (int i = limits.first; i <= limits.second; i++) {
-            for (int isym = 0; isym < unit_cell().symmetry().num_mag_sym(); isym++) {
-                auto t = unit_cell().symmetry().magnetic_group_symmetry(isym).spg_op.t;
-                for (int x : {0, 1, 2}) {
-                    sym_phase_factors_(x, i, isym) = std::exp(double_complex(0.0, twopi * (i * t[x])));
+        auto win_sym = allocate_node_shared(sym_phase_factors_, comm_node());
+        if (win_sym.writer()) {
+            #pragma omp parallel for
+            for (int i = limits.first; i <= limits.second; i++) {
+                for (int isym = 0; isym < unit_cell().symmetry().num_mag_sym(); isym++) {
+                    auto t = unit_cell().symmetry().magnetic_group_symmetry(isym).spg_op.t;
+                    for (int x : {0, 1, 2}) {
+                        sym_phase_factors_(x, i, isym) = std::exp(double_complex(0.0, twopi * (i * t[x])));
+                    }
                 }
             }
         }
+        win_sym.sync(comm_node());
     }
 
     /* precompute some G-vector related arrays */
@@ -1193,10 +1237,12 @@ void Simulation_context::update()
                 break;
             }
         }
+        /* with low memory usage on CPU the plane-wave coefficients of Q are generated on the fly */
+        bool store_q_pw = (this->processing_unit() == device_t::GPU) || (control().memory_usage_ != "low");
         for (int iat = 0; iat < unit_cell().num_atom_types(); iat++) {
             if (unit_cell().atom_type(iat).augment() && unit_cell().atom_type(iat).num_atoms() > 0) {
                 augmentation_op_[iat] = std::unique_ptr<Augmentation_operator>(
-                    new Augmentation_operator(unit_cell().atom_type(iat), gvec()));
+                    new Augmentation_operator(unit_cell().atom_type(iat), gvec(), store_q_pw));
                 augmentation_op_[iat]->generate_pw_coeffs(aug_ri(), gvec_tp_, *mp, mpd);
             } else {
                 augmentation_op_[iat] = nullptr;
@@ -1297,36 +1343,38 @@ void Simulation_context::print_memory_usage(const char *file__, int line__)
     }
 }
 
-void Simulation_context::init_atoms_to_grid_idx(double R__)
+std::vector<std::vector<std::pair<int, vector3d<double>>>>
+Simulation_context::find_atoms_to_grid(std::function<double(int)> R__, bool coarse__) const
 {
-    PROFILE("sirius::Simulation_context::init_atoms_to_grid_idx");
+    std::vector<std::vector<std::pair<int, vector3d<double>>>> result(unit_cell().num_atoms());
 
-    atoms_to_grid_idx_.resize(unit_cell().num_atoms());
+    auto& spfft    = coarse__ ? spfft_coarse() : this->spfft();
+    auto& fft_grid = coarse__ ? fft_coarse_grid_ : fft_grid_;
 
-    vector3d<double> delta(1.0 / spfft().dim_x(), 1.0 / spfft().dim_y(), 1.0 / spfft().dim_z());
+    vector3d<double> delta(1.0 / spfft.dim_x(), 1.0 / spfft.dim_y(), 1.0 / spfft.dim_z());
 
-    int z_off = spfft().local_z_offset();
+    int z_off = spfft.local_z_offset();
     vector3d<int> grid_beg(0, 0, z_off);
-    vector3d<int> grid_end(spfft().dim_x(), spfft().dim_y(), z_off + spfft().local_z_length());
-    std::vector<vector3d<double>> verts_cart{{-R__, -R__, -R__}, {R__, -R__, -R__}, {-R__, R__, -R__},
-                                             {R__, R__, -R__},   {-R__, -R__, R__}, {R__, -R__, R__},
-                                             {-R__, R__, R__},   {R__, R__, R__}};
-
-    auto bounds_box = [&](vector3d<double> pos) {
-        std::vector<vector3d<double>> verts;
+    vector3d<int> grid_end(spfft.dim_x(), spfft.dim_y(), z_off + spfft.local_z_length());
 
-        /* pos is a position of atom */
-        for (auto v : verts_cart) {
-            verts.push_back(pos + unit_cell().get_fractional_coordinates(v));
+    /* half-size of the box enclosing the sphere of radius R in fractional coordinates; the fractional coordinate
+     * x is the projection on the row x of the inverse lattice vectors, so its extent is R times the row length */
+    auto extent = [&](double R) {
+        auto const& ilv = unit_cell().inverse_lattice_vectors();
+        vector3d<double> e;
+        for (int x : {0, 1, 2}) {
+            e[x] = R * std::sqrt(std::pow(ilv(x, 0), 2) + std::pow(ilv(x, 1), 2) + std::pow(ilv(x, 2), 2));
         }
+        return e;
+    };
 
+    /* local grid points [first, second) in the box around the position pos */
+    auto bounds_box = [&](vector3d<double> pos, vector3d<double> e) {
         std::pair<vector3d<int>, vector3d<int>> bounds_ind;
 
         for (int x : {0, 1, 2}) {
-            std::sort(verts.begin(), verts.end(),
-                      [x](vector3d<double>& a, vector3d<double>& b) { return a[x] < b[x]; });
-            bounds_ind.first[x]  = std::max(static_cast<int>(verts[0][x] / delta[x]) - 1, grid_beg[x]);
-            bounds_ind.second[x] = std::min(static_cast<int>(verts[5][x] / delta[x]) + 1, grid_end[x]);
+            bounds_ind.first[x]  = std::max(static_cast<int>(std::floor((pos[x] - e[x]) / delta[x])), grid_beg[x]);
+            bounds_ind.second[x] = std::min(static_cast<int>(std::ceil((pos[x] + e[x]) / delta[x])) + 1, grid_end[x]);
         }
 
         return bounds_ind;
@@ -1335,24 +1383,38 @@ void Simulation_context::init_atoms_to_grid_idx(double R__)
     #pragma omp parallel for
     for (int ia = 0; ia < unit_cell().num_atoms(); ia++) {
 
-        std::vector<std::pair<int, double>> atom_to_ind_map;
+        double R = R__(ia);
+
+        auto e = extent(R);
+
+        auto pos0 = unit_cell().atom(ia).position();
+
+        /* range of periodic images of the atom whose spheres can overlap with the unit cell [0, 1)^3; the radius
+         * can be larger than the cell size, so more than the nearest images may be needed */
+        vector3d<int> t_min, t_max;
+        for (int x : {0, 1, 2}) {
+            t_min[x] = static_cast<int>(std::floor(-pos0[x] - e[x]));
+            t_max[x] = static_cast<int>(std::ceil(1 - pos0[x] + e[x]));
+        }
 
-        for (int t0 = -1; t0 <= 1; t0++) {
-            for (int t1 = -1; t1 <= 1; t1++) {
-                for (int t2 = -1; t2 <= 1; t2++) {
-                    auto pos = unit_cell().atom(ia).position() + vector3d<double>(t0, t1, t2);
+        std::vector<std::pair<int, vector3d<double>>> atom_to_ind_map;
+
+        for (int t0 = t_min[0]; t0 <= t_max[0]; t0++) {
+            for (int t1 = t_min[1]; t1 <= t_max[1]; t1++) {
+                for (int t2 = t_min[2]; t2 <= t_max[2]; t2++) {
+                    auto pos = pos0 + vector3d<double>(t0, t1, t2);
 
                     /* find the small box around this atom */
-                    auto box = bounds_box(pos);
+                    auto box = bounds_box(pos, e);
 
                     for (int j0 = box.first[0]; j0 < box.second[0]; j0++) {
                         for (int j1 = box.first[1]; j1 < box.second[1]; j1++) {
                             for (int j2 = box.first[2]; j2 < box.second[2]; j2++) {
-                                auto v = pos - vector3d<double>(delta[0] * j0, delta[1] * j1, delta[2] * j2);
-                                auto r  = unit_cell().get_cartesian_coordinates(v).length();
-                                if (r < R__) {
-                                    auto ir = fft_grid_.index_by_coord(j0, j1, j2 - z_off);
-                                    atom_to_ind_map.push_back({ir, r});
+                                auto v = vector3d<double>(delta[0] * j0, delta[1] * j1, delta[2] * j2) - pos;
+                                auto vc = unit_cell().get_cartesian_coordinates(v);
+                                if (vc.length() < R) {
+                                    auto ir = fft_grid.index_by_coord(j0, j1, j2 - z_off);
+                                    atom_to_ind_map.push_back({ir, vc});
                                 }
                             }
                         }
@@ -1361,10 +1423,62 @@ void Simulation_context::init_atoms_to_grid_idx(double R__)
             }
         }
 
+        result[ia] = std::move(atom_to_ind_map);
+    }
+
+    return result;
+}
+
+void Simulation_context::init_atoms_to_grid_idx(double R__)
+{
+    PROFILE("sirius::Simulation_context::init_atoms_to_grid_idx");
+
+    auto atoms_to_grid = find_atoms_to_grid([R__](int ia) { return R__; });
+
+    atoms_to_grid_idx_.resize(unit_cell().num_atoms());
+
+    #pragma omp parallel for
+    for (int ia = 0; ia < unit_cell().num_atoms(); ia++) {
+        std::vector<std::pair<int, double>> atom_to_ind_map;
+        for (auto& e : atoms_to_grid[ia]) {
+            atom_to_ind_map.push_back({e.first, e.second.length()});
+        }
         atoms_to_grid_idx_[ia] = std::move(atom_to_ind_map);
     }
 }
 
+void Simulation_context::init_atoms_to_grid_aug()
+{
+    PROFILE("sirius::Simulation_context::init_atoms_to_grid_aug");
+
+    /* radius of the augmentation sphere is the point beyond which all Q-radial functions vanish */
+    std::vector<double> R_aug(unit_cell().num_atom_types(), 0);
+    for (int iat = 0; iat < unit_cell().num_atom_types(); iat++) {
+        auto& atom_type = unit_cell().atom_type(iat);
+        if (!atom_type.augment()) {
+            continue;
+        }
+        int nbrf = atom_type.mt_radial_basis_size();
+        int ir_max{0};
+        for (int l = 0; l <= 2 * atom_type.indexr().lmax(); l++) {
+            for (int idxrf2 = 0; idxrf2 < nbrf; idxrf2++) {
+                for (int idxrf1 = 0; idxrf1 <= idxrf2; idxrf1++) {
+                    auto& qrf = atom_type.q_radial_function(idxrf1, idxrf2, l);
+                    for (int ir = qrf.num_points() - 1; ir > ir_max; ir--) {
+                        if (std::abs(qrf(ir)) > 1e-12) {
+                            ir_max = ir;
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+        R_aug[iat] = atom_type.radial_grid(std::min(ir_max + 1, atom_type.num_mt_points() - 1));
+    }
+
+    atoms_to_grid_aug_ = find_atoms_to_grid([&](int ia) { return R_aug[unit_cell().atom(ia).type_id()]; });
+}
+
 void Simulation_context::init_step_function()
 {
     auto v = make_periodic_function<index_domain_t::global>([&](int iat, double g)
@@ -1451,6 +1565,13 @@ void Simulation_context::init_comm()
 
     /* create communicator, orthogonal to comm_fft_coarse within a band communicator */
     comm_band_ortho_fft_coarse_ = comm_band().split(comm_fft_coarse().rank());
+
+    /* create communicator of the node */
+    if (control().node_shared_memory_) {
+        comm_node_ = comm().split_shared();
+    } else {
+        comm_node_ = Communicator::self().duplicate();
+    }
 }
 
 } // namespace sirius
@@ -31,13 +31,18 @@
 
 #include "simulation_parameters.hpp"
 #include "mpi/mpi_grid.hpp"
+#include "mpi/shared_memory.hpp"
 #include "radial/radial_integrals.hpp"
+#include "beta_projectors/beta_radial_functions_rs.hpp"
 #include "utils/utils.hpp"
+#include "utils/thread_policy.hpp"
 #include "density/augmentation_operator.hpp"
 #include "gpu/acc.hpp"
 #include "symmetry/check_gvec.hpp"
 #include "symmetry/rotation.hpp"
+#include "linalg/eigensolver_auto.hpp"
 #include "spfft/spfft.hpp"
+#include "SDDK/fft.hpp"
 
 #ifdef __GPU
 extern "C" void generate_phase_factors_gpu(int num_gvec_loc__, int num_atoms__, int const* gvec__,
@@ -81,6 +86,13 @@ class Simulation_context : public Simulation_parameters
         used to parallelize application of local Hamiltonian over bands. */
     Communicator comm_band_ortho_fft_coarse_;
 
+    /// Communicator of the ranks sharing the memory of the same node.
+    /** Used to store the replicated read-only tables once per node. */
+    Communicator comm_node_;
+
+    /// Number of threads for the different stages of the calculation.
+    utils::thread_policy thread_policy_;
+
     /// Unit cell of the simulation.
     std::unique_ptr<Unit_cell> unit_cell_;
 
@@ -106,6 +118,10 @@ class Simulation_context : public Simulation_parameters
     std::unique_ptr<spfft::Transform> spfft_transform_coarse_;
     std::unique_ptr<spfft::Grid> spfft_grid_coarse_;
 
+    /// Cache of the coarse-grid transforms of the k-points.
+    /** Declared after the coarse grid, so the cached transforms are destroyed first. */
+    std::unique_ptr<spfft_transform_cache> spfft_cache_coarse_;
+
     /// G-vectors within the Gmax cutoff.
     std::unique_ptr<Gvec> gvec_;
 
@@ -154,6 +170,9 @@ class Simulation_context : public Simulation_parameters
 
     std::function<void(int, double, double*, int)> beta_ri_djl_callback_{nullptr};
 
+    /// Fourier-filtered radial functions of beta-projectors for the real-space application of the D-operator.
+    std::unique_ptr<Beta_radial_functions_rs> beta_rs_rf_;
+
     /// Radial integrals of augmentation operator.
     std::unique_ptr<Radial_integrals_aug<false>> aug_ri_;
 
@@ -203,6 +222,10 @@ class Simulation_context : public Simulation_parameters
     /// List of real-space point indices for each of the atoms.
     std::vector<std::vector<std::pair<int, double>>> atoms_to_grid_idx_;
 
+    /// List of real-space point indices and vectors r - R_a inside the augmentation sphere of each atom.
+    /** Only populated when the augmentation charge is computed in real space. */
+    std::vector<std::vector<std::pair<int, vector3d<double>>>> atoms_to_grid_aug_;
+
     /// Plane wave expansion coefficients of the step function.
     sddk::mdarray<double_complex, 1> theta_pw_;
 
@@ -219,6 +242,9 @@ class Simulation_context : public Simulation_parameters
     /// Generalized eigen-value problem solver.
     std::unique_ptr<Eigensolver> gen_evp_solver_;
 
+    /// Auto-tuned standard eigen-value problem solver for the subspace matrices of the iterative solvers.
+    std::unique_ptr<Eigensolver_auto> subspace_evp_solver_;
+
     /// Type of host memory (pagable or page-locked) for the arrays that participate in host-to-device memory copy.
     memory_t host_memory_t_{memory_t::none};
 
@@ -291,6 +317,9 @@ class Simulation_context : public Simulation_parameters
     /// Find a list of real-space grid points around each atom.
     void init_atoms_to_grid_idx(double R__);
 
+    /// Find a list of real-space grid points inside the augmentation sphere of each atom.
+    void init_atoms_to_grid_aug();
+
     /// Get the stsrting time stamp.
     void start()
     {
@@ -346,6 +375,9 @@ class Simulation_context : public Simulation_parameters
         if (!comm().is_finalized()) {
             this->print_memory_usage(__FILE__, __LINE__);
         }
+        if (subspace_evp_solver_ && comm().rank() == 0 && control().verbosity_ >= 1) {
+            subspace_evp_solver_->print_tuning_table();
+        }
     }
 
     /// Initialize the similation (can only be called once).
@@ -371,11 +403,24 @@ class Simulation_context : public Simulation_parameters
     /// Update context after setting new lattice vectors or atomic coordinates.
     void update();
 
+    /// Find the local real-space grid points inside a sphere around each atom.
+    /** The radius of the sphere is returned by R__(ia) for each atom. The list of (grid index, r - R_a) pairs
+        is returned for each atom; all periodic images of the atom whose sphere overlaps with the unit cell
+        are taken into account, so the radius can exceed the cell size. Points of the fine
+        FFT grid are searched by default; if coarse__ is true, the coarse FFT grid is used instead. */
+    std::vector<std::vector<std::pair<int, vector3d<double>>>> find_atoms_to_grid(std::function<double(int)> R__,
+                                                                                  bool coarse__ = false) const;
+
     std::vector<std::pair<int, double>> const& atoms_to_grid_idx_map(int ia__) const
     {
         return atoms_to_grid_idx_[ia__];
     };
 
+    std::vector<std::pair<int, vector3d<double>>> const& atoms_to_grid_aug_map(int ia__) const
+    {
+        return atoms_to_grid_aug_[ia__];
+    };
+
     Unit_cell& unit_cell()
     {
         return *unit_cell_;
@@ -473,6 +518,20 @@ class Simulation_context : public Simulation_parameters
         return comm_band_ortho_fft_coarse_;
     }
 
+    /// Number of threads for the different stages of the calculation.
+    /** Stages are switched with the scoped utils::thread_guard. */
+    utils::thread_policy const& thread_policy() const
+    {
+        return thread_policy_;
+    }
+
+    /// Communicator of the ranks of the same node.
+    /** If the node-shared storage of the replicated tables is switched off, this is a self-communicator. */
+    Communicator const& comm_node() const
+    {
+        return comm_node_;
+    }
+
     void create_storage_file() const;
 
     inline std::string const& start_time_tag() const
@@ -500,6 +559,12 @@ class Simulation_context : public Simulation_parameters
         return* gen_evp_solver_;
     }
 
+    /// Standard eigen-value solver for the subspace matrices of the iterative solvers.
+    inline Eigensolver& subspace_evp_solver()
+    {
+        return (subspace_evp_solver_) ? *subspace_evp_solver_ : *std_evp_solver_;
+    }
+
     /// Phase factors \f$ e^{i {\bf G} {\bf r}_{\alpha}} \f$
     inline double_complex gvec_phase_factor(vector3d<int> G__, int ia__) const
     {
@@ -615,6 +680,20 @@ class Simulation_context : public Simulation_parameters
         return *beta_ri_djl_;
     }
 
+    inline Beta_radial_functions_rs const& beta_rs_rf() const
+    {
+        return *beta_rs_rf_;
+    }
+
+    /// True if the D-operator is applied in real space.
+    /** The real-space beta-projectors are used only if they are requested in the input and only in the spin-collinear
+     *  case without spin-orbit coupling on CPU; in all other cases the plane-wave projectors are used. */
+    inline bool beta_real_space() const
+    {
+        return control().beta_real_space_ && !full_potential() && processing_unit() == device_t::CPU &&
+               num_mag_dims() != 3 && !so_correction();
+    }
+
     inline Radial_integrals_aug<false> const& aug_ri() const
     {
         return *aug_ri_;
@@ -749,6 +828,12 @@ class Simulation_context : public Simulation_parameters
         return *spfft_grid_coarse_;
     }
 
+    /// Cache of the coarse-grid transforms for the G+k vectors of the k-points.
+    spfft_transform_cache& spfft_cache_coarse()
+    {
+        return *spfft_cache_coarse_;
+    }
+
     spfft::Transform& spfft()
     {
         return *spfft_transform_;
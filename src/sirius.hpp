@@ -40,6 +40,7 @@
 #include "utils/cmd_args.hpp"
 #include "utils/json.hpp"
 #include "utils/profiler.hpp"
+#include "utils/env.hpp"
 using json = nlohmann::json;
 
 #include "input.hpp"
@@ -77,6 +78,11 @@ inline static bool& is_initialized()
 /// Initialize the library.
 inline void initialize(bool call_mpi_init__ = true)
 {
+    /* only accumulate timer statistics (constant memory for long runs) if requested */
+    auto timer_mode = utils::get_env<std::string>("SIRIUS_TIMER_MODE");
+    if (timer_mode && *timer_mode == "aggregate") {
+        ::utils::global_rtgraph_timer.set_mode(rt_graph::TimerMode::Aggregate);
+    }
     PROFILE_START("sirius");
     PROFILE("sirius::initialize");
     if (is_initialized()) {
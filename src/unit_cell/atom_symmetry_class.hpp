@@ -147,11 +147,29 @@ class Atom_symmetry_class
 
     inline void generate_radial_functions(relativity_t rel__);
 
-    inline void sync_radial_functions(Communicator const& comm__, int const rank__);
+    /// List of (pointer, size) pairs of the arrays computed by generate_radial_functions().
+    inline std::vector<std::pair<double*, int>> radial_functions_data();
 
-    inline void sync_radial_integrals(Communicator const& comm__, int const rank__);
+    /// List of (pointer, size) pairs of the arrays computed by generate_radial_integrals().
+    inline std::vector<std::pair<double*, int>> radial_integrals_data();
 
-    inline void sync_core_charge_density(Communicator const& comm__, int const rank__);
+    /// List of (pointer, size) pairs of the arrays computed by generate_core_charge_density().
+    inline std::vector<std::pair<double*, int>> core_charge_density_data();
+
+    /// Rough estimate of the cost to compute radial functions, radial integrals and core states of this class.
+    inline double cost() const
+    {
+        int nrf = atom_type_.mt_radial_basis_size();
+        int ncore{0};
+        for (int ist = 0; ist < atom_type_.num_atomic_levels(); ist++) {
+            if (atom_type_.atomic_level(ist).core) {
+                ncore++;
+            }
+        }
+        /* radial integrals scale as a square of the number of radial functions; bound states of the Dirac
+           equation require several integrations of the radial equation to find the energy */
+        return static_cast<double>(atom_type_.num_mt_points()) * (nrf * (nrf + 1) / 2 + nrf + 10 * ncore);
+    }
 
     /// Check if local orbitals are linearly independent
     inline std::vector<int> check_lo_linear_independence(double etol__);
@@ -760,32 +778,34 @@ inline void Atom_symmetry_class::generate_radial_functions(relativity_t rel__)
     //** STOP();
 }
 
-inline void Atom_symmetry_class::sync_radial_functions(Communicator const& comm__, int const rank__)
+inline std::vector<std::pair<double*, int>> Atom_symmetry_class::radial_functions_data()
 {
-    /* don't broadcast Hamiltonian radial functions, because they are used locally */
-    int size = (int)(radial_functions_.size(0) * radial_functions_.size(1));
-    comm__.bcast(radial_functions_.at(memory_t::host), size, rank__);
-    comm__.bcast(aw_surface_derivatives_.at(memory_t::host), (int)aw_surface_derivatives_.size(), rank__);
+    /* don't sync Hamiltonian radial functions, because they are used locally */
+    int size = static_cast<int>(radial_functions_.size(0) * radial_functions_.size(1));
+    return {{radial_functions_.at(memory_t::host), size},
+            {aw_surface_derivatives_.at(memory_t::host), static_cast<int>(aw_surface_derivatives_.size())}};
     // TODO: sync enu to pass to Exciting / Elk
 }
 
-inline void Atom_symmetry_class::sync_radial_integrals(Communicator const& comm__, int const rank__)
+inline std::vector<std::pair<double*, int>> Atom_symmetry_class::radial_integrals_data()
 {
-    comm__.bcast(h_spherical_integrals_.at(memory_t::host), (int)h_spherical_integrals_.size(), rank__);
-    comm__.bcast(o_radial_integrals_.at(memory_t::host), (int)o_radial_integrals_.size(), rank__);
-    comm__.bcast(so_radial_integrals_.at(memory_t::host), (int)so_radial_integrals_.size(), rank__);
+    std::vector<std::pair<double*, int>> data{
+        {h_spherical_integrals_.at(memory_t::host), static_cast<int>(h_spherical_integrals_.size())},
+        {o_radial_integrals_.at(memory_t::host), static_cast<int>(o_radial_integrals_.size())},
+        {so_radial_integrals_.at(memory_t::host), static_cast<int>(so_radial_integrals_.size())}};
     if (atom_type_.parameters().valence_relativity() == relativity_t::iora) {
-        comm__.bcast(o1_radial_integrals_.at(memory_t::host), (int)o1_radial_integrals_.size(), rank__);
+        data.push_back({o1_radial_integrals_.at(memory_t::host), static_cast<int>(o1_radial_integrals_.size())});
     }
+    return data;
 }
 
-inline void Atom_symmetry_class::sync_core_charge_density(Communicator const& comm__, int const rank__)
+inline std::vector<std::pair<double*, int>> Atom_symmetry_class::core_charge_density_data()
 {
     assert(ae_core_charge_density_.size() != 0);
 
-    comm__.bcast(&ae_core_charge_density_[0], atom_type_.radial_grid().num_points(), rank__);
-    comm__.bcast(&core_leakage_, 1, rank__);
-    comm__.bcast(&core_eval_sum_, 1, rank__);
+    return {{&ae_core_charge_density_[0], atom_type_.radial_grid().num_points()},
+            {&core_leakage_, 1},
+            {&core_eval_sum_, 1}};
 }
 
 inline void Atom_symmetry_class::generate_radial_integrals(relativity_t rel__)
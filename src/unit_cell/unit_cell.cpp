@@ -417,21 +417,16 @@ void Unit_cell::generate_radial_functions()
 {
     PROFILE("sirius::Unit_cell::generate_radial_functions");
 
-    for (int icloc = 0; icloc < (int)spl_num_atom_symmetry_classes().local_size(); icloc++) {
-        int ic = spl_num_atom_symmetry_classes(icloc);
+    for (int ic : local_atom_symmetry_classes()) {
         atom_symmetry_class(ic).generate_radial_functions(parameters_.valence_relativity());
     }
 
-    for (int ic = 0; ic < num_atom_symmetry_classes(); ic++) {
-        int rank = spl_num_atom_symmetry_classes().local_rank(ic);
-        atom_symmetry_class(ic).sync_radial_functions(comm_, rank);
-    }
+    sync_atom_symmetry_classes([this](int ic) { return atom_symmetry_class(ic).radial_functions_data(); });
 
     if (parameters_.control().verbosity_ >= 1) {
         pstdout pout(comm_);
 
-        for (int icloc = 0; icloc < (int)spl_num_atom_symmetry_classes().local_size(); icloc++) {
-            int ic = spl_num_atom_symmetry_classes(icloc);
+        for (int ic : local_atom_symmetry_classes()) {
             atom_symmetry_class(ic).write_enu(pout);
         }
 
@@ -451,15 +446,11 @@ void Unit_cell::generate_radial_integrals()
 {
     PROFILE("sirius::Unit_cell::generate_radial_integrals");
 
-    for (int icloc = 0; icloc < spl_num_atom_symmetry_classes().local_size(); icloc++) {
-        int ic = spl_num_atom_symmetry_classes(icloc);
+    for (int ic : local_atom_symmetry_classes()) {
         atom_symmetry_class(ic).generate_radial_integrals(parameters_.valence_relativity());
     }
 
-    for (int ic = 0; ic < num_atom_symmetry_classes(); ic++) {
-        int rank = spl_num_atom_symmetry_classes().local_rank(ic);
-        atom_symmetry_class(ic).sync_radial_integrals(comm_, rank);
-    }
+    sync_atom_symmetry_classes([this](int ic) { return atom_symmetry_class(ic).radial_integrals_data(); });
 
     for (int ialoc = 0; ialoc < spl_num_atoms_.local_size(); ialoc++) {
         int ia = spl_num_atoms_[ialoc];
@@ -472,6 +463,91 @@ void Unit_cell::generate_radial_integrals()
     }
 }
 
+void Unit_cell::distribute_atom_symmetry_classes()
+{
+    int nc = num_atom_symmetry_classes();
+
+    std::vector<std::pair<double, int>> cost(nc);
+    for (int ic = 0; ic < nc; ic++) {
+        cost[ic] = std::make_pair(atom_symmetry_class(ic).cost(), ic);
+    }
+    /* heavy classes go first; sort is stable with respect to class index, so all ranks get the same result */
+    std::sort(cost.begin(), cost.end(), [](std::pair<double, int> const& a, std::pair<double, int> const& b) {
+        return (a.first > b.first) || (a.first == b.first && a.second < b.second);
+    });
+
+    std::vector<double> load(comm_.size(), 0);
+    atom_symmetry_class_rank_ = std::vector<int>(nc);
+    for (auto& e : cost) {
+        /* least loaded rank; the first one in case of a tie */
+        int rank = static_cast<int>(std::min_element(load.begin(), load.end()) - load.begin());
+        atom_symmetry_class_rank_[e.second] = rank;
+        load[rank] += e.first;
+    }
+
+    local_atom_symmetry_classes_.clear();
+    for (int ic = 0; ic < nc; ic++) {
+        if (atom_symmetry_class_rank_[ic] == comm_.rank()) {
+            local_atom_symmetry_classes_.push_back(ic);
+        }
+    }
+}
+
+void Unit_cell::sync_atom_symmetry_classes(std::function<std::vector<std::pair<double*, int>>(int)> data__)
+{
+    PROFILE("sirius::Unit_cell::sync_atom_symmetry_classes");
+
+    if (comm_.size() == 1) {
+        return;
+    }
+
+    /* size of the data for each class */
+    std::vector<int> size(num_atom_symmetry_classes(), 0);
+    for (int ic = 0; ic < num_atom_symmetry_classes(); ic++) {
+        for (auto& e : data__(ic)) {
+            size[ic] += e.second;
+        }
+    }
+
+    /* each rank contributes the data of its classes in the order of class index */
+    std::vector<int> counts(comm_.size(), 0);
+    for (int ic = 0; ic < num_atom_symmetry_classes(); ic++) {
+        counts[atom_symmetry_class_rank(ic)] += size[ic];
+    }
+    std::vector<int> offsets(comm_.size(), 0);
+    for (int r = 1; r < comm_.size(); r++) {
+        offsets[r] = offsets[r - 1] + counts[r - 1];
+    }
+
+    std::vector<double> buf(offsets.back() + counts.back());
+
+    auto pos = offsets;
+    for (int ic = 0; ic < num_atom_symmetry_classes(); ic++) {
+        int rank = atom_symmetry_class_rank(ic);
+        if (rank == comm_.rank()) {
+            for (auto& e : data__(ic)) {
+                std::copy(e.first, e.first + e.second, &buf[pos[rank]]);
+                pos[rank] += e.second;
+            }
+        } else {
+            pos[rank] += size[ic];
+        }
+    }
+
+    comm_.allgather(buf.data(), counts.data(), offsets.data());
+
+    pos = offsets;
+    for (int ic = 0; ic < num_atom_symmetry_classes(); ic++) {
+        int rank = atom_symmetry_class_rank(ic);
+        for (auto& e : data__(ic)) {
+            if (rank != comm_.rank()) {
+                std::copy(&buf[pos[rank]], &buf[pos[rank]] + e.second, e.first);
+            }
+            pos[rank] += e.second;
+        }
+    }
+}
+
 std::string Unit_cell::chemical_formula()
 {
     std::string name;
@@ -727,7 +803,7 @@ void Unit_cell::update()
 
     get_symmetry();
 
-    spl_num_atom_symmetry_classes_ = splindex<splindex_t::block>(num_atom_symmetry_classes(), comm_.size(), comm_.rank());
+    distribute_atom_symmetry_classes();
 
     volume_mt_ = 0.0;
     if (parameters_.full_potential()) {
@@ -64,8 +64,11 @@ class Unit_cell
     /// Split index of PAW atoms.
     splindex<splindex_t::block> spl_num_paw_atoms_;
 
-    /// Split index of atom symmetry classes.
-    splindex<splindex_t::block> spl_num_atom_symmetry_classes_;
+    /// Rank which computes radial functions, radial integrals and core states of each atom symmetry class.
+    std::vector<int> atom_symmetry_class_rank_;
+
+    /// List of atom symmetry classes handled by this rank.
+    std::vector<int> local_atom_symmetry_classes_;
 
     /// Bravais lattice vectors in column order.
     /** The following convention is used to transform fractional coordinates to Cartesian:
@@ -489,16 +492,29 @@ class Unit_cell
         return static_cast<int>(spl_num_atoms_[i]);
     }
 
-    inline splindex<splindex_t::block> const& spl_num_atom_symmetry_classes() const
+    /// List of atom symmetry classes handled by this rank.
+    inline std::vector<int> const& local_atom_symmetry_classes() const
     {
-        return spl_num_atom_symmetry_classes_;
+        return local_atom_symmetry_classes_;
     }
 
-    inline int spl_num_atom_symmetry_classes(int i) const
+    /// Rank which handles a given atom symmetry class.
+    inline int atom_symmetry_class_rank(int ic__) const
     {
-        return static_cast<int>(spl_num_atom_symmetry_classes_[i]);
+        return atom_symmetry_class_rank_[ic__];
     }
 
+    /// Distribute atom symmetry classes between MPI ranks.
+    /** Classes are sorted by their estimated cost and each class is given to the least loaded rank (longest
+     *  processing time first). In this way the heavy classes are spread over different ranks. */
+    void distribute_atom_symmetry_classes();
+
+    /// Synchronise data of atom symmetry classes computed by their ranks.
+    /** Data of all classes is packed into a single buffer and exchanged with one collective operation.
+     *  \param [in] data Function which returns a list of (pointer, size) pairs for a given class.
+     */
+    void sync_atom_symmetry_classes(std::function<std::vector<std::pair<double*, int>>(int)> data__);
+
     inline double volume_mt() const
     {
         return volume_mt_;
@@ -29,6 +29,7 @@
 #include "rt_graph.hpp"
 #include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <iomanip>
 #include <list>
 #include <numeric>
@@ -201,19 +202,21 @@ auto calc_median(const std::vector<double>::const_iterator& begin,
   }
 }
 
-auto print_stat(std::ostream& out, const StatFormat& format,
+auto print_stat(std::ostream& out, const StatFormat& format, const TimingNode& node,
                 const std::vector<double>& sortedTimings, double totalSum, double parentSum,
                 double currentSum, double subSum) -> void {
+  // quantiles require individual timings, which are not available for aggregated nodes
+  const bool hasTimings = !sortedTimings.empty();
   switch (format.stat) {
     case Stat::Count:
-      if (sortedTimings.size() >= 100000) {
+      if (node.count >= 100000) {
         double value;
         char prefix;
-        std::tie(value, prefix) = unit_prefix(sortedTimings.size());
+        std::tie(value, prefix) = unit_prefix(node.count);
         out << std::right << std::setw(format.space)
             << std::to_string(static_cast<int>(value)) + prefix;
       } else {
-        out << std::right << std::setw(format.space) << sortedTimings.size();
+        out << std::right << std::setw(format.space) << node.count;
       }
       break;
     case Stat::Total:
@@ -225,13 +228,21 @@ auto print_stat(std::ostream& out, const StatFormat& format,
       break;
     case Stat::Mean:
       out << std::right << std::setw(format.space)
-          << format_time(currentSum / sortedTimings.size());
+          << format_time(node.count ? currentSum / node.count : 0.0);
       break;
     case Stat::Median:
+      if (!hasTimings) {
+        out << std::right << std::setw(format.space) << "- ";
+        break;
+      }
       out << std::right << std::setw(format.space)
           << format_time(calc_median(sortedTimings.begin(), sortedTimings.end()));
       break;
     case Stat::QuartileHigh: {
+      if (!hasTimings) {
+        out << std::right << std::setw(format.space) << "- ";
+        break;
+      }
       const double upperQuartile =
           calc_median(sortedTimings.begin() + sortedTimings.size() / 2 +
                           (sortedTimings.size() % 2) * (sortedTimings.size() > 1),
@@ -239,15 +250,19 @@ auto print_stat(std::ostream& out, const StatFormat& format,
       out << std::right << std::setw(format.space) << format_time(upperQuartile);
     } break;
     case Stat::QuartileLow: {
+      if (!hasTimings) {
+        out << std::right << std::setw(format.space) << "- ";
+        break;
+      }
       const double lowerQuartile =
           calc_median(sortedTimings.begin(), sortedTimings.begin() + sortedTimings.size() / 2);
       out << std::right << std::setw(format.space) << format_time(lowerQuartile);
     } break;
     case Stat::Min:
-      out << std::right << std::setw(format.space) << format_time(sortedTimings.front());
+      out << std::right << std::setw(format.space) << format_time(node.minTime);
       break;
     case Stat::Max:
-      out << std::right << std::setw(format.space) << format_time(sortedTimings.back());
+      out << std::right << std::setw(format.space) << format_time(node.maxTime);
       break;
     case Stat::Percentage: {
       const double p =
@@ -307,7 +322,7 @@ auto print_node(const std::size_t level, std::ostream& out,
     subTime += subNode.totalTime;
   }
   for (const auto& format : formats) {
-    print_stat(out, format, sortedTimings, totalTime, parentTime, node.totalTime, subTime);
+    print_stat(out, format, node, sortedTimings, totalTime, parentTime, node.totalTime, subTime);
   }
   out << std::endl;
   for (const auto& subNode : node.subNodes) {
@@ -349,6 +364,8 @@ auto export_node_json(const std::string& padding, const std::list<internal::Timi
   const std::string subNodePadding = nodePadding + "  ";
   for (const auto& node : nodeList) {
     stream << nodePadding << "\"" << node.identifier << "\" : {" << std::endl;
+    stream << subNodePadding << "\"count\" : " << node.count << "," << std::endl;
+    stream << subNodePadding << "\"total\" : " << node.totalTime << "," << std::endl;
     stream << subNodePadding << "\"timings\" : [";
     for (const auto& value : node.timings) {
       stream << value;
@@ -407,6 +424,7 @@ auto flatten_timings_nodes(std::list<TimingNode>& rootNodes, std::list<TimingNod
       // identifier already in rootNodes -> only append timings
       it->timings.insert(it->timings.end(), n.timings.begin(), n.timings.end());
       it->startTimes.insert(it->startTimes.end(), n.startTimes.begin(), n.startTimes.end());
+      it->add_aggregate(n.count, n.totalTime, n.minTime, n.maxTime);
     }
   }
 
@@ -427,121 +445,257 @@ auto flatten_timings_nodes_from_level(std::list<TimingNode>& nodes, std::size_t
   }
 }
 
+// create tree of timings from the time stamps of a single thread
+auto process_time_stamps(const std::vector<TimeStamp>& timeStamps,
+                         const ClockType::time_point& origin, std::list<TimingNode>& results,
+                         std::ostream& warnings) -> void {
+  std::vector<TimeStampPair> timePairs;
+  timePairs.reserve(timeStamps.size() / 2);
+
+  // create pairs of start / stop timings
+  for (std::size_t i = 0; i < timeStamps.size(); ++i) {
+    if (timeStamps[i].type == TimeStampType::Start) {
+      TimeStampPair pair;
+      pair.startIdx = i;
+      pair.identifier = std::string(timeStamps[i].identifierPtr);
+      std::size_t numInnerMatchingIdentifiers = 0;
+      // search for matching stop after start
+      for (std::size_t j = i + 1; j < timeStamps.size(); ++j) {
+        // only consider matching identifiers
+        if (std::string(timeStamps[j].identifierPtr) == std::string(timeStamps[i].identifierPtr)) {
+          if (timeStamps[j].type == TimeStampType::Stop && numInnerMatchingIdentifiers == 0) {
+            // Matching stop found
+            std::chrono::duration<double> duration = timeStamps[j].time - timeStamps[i].time;
+            pair.time = duration.count();
+            duration = timeStamps[i].time - origin;
+            pair.startTime = duration.count();
+            pair.stopIdx = j;
+            timePairs.push_back(pair);
+            if (pair.time < 0 || pair.startTime < 0) {
+              warnings << "rt_graph WARNING:Measured time is negative. Non-steady system-clock?!"
+                       << std::endl;
+            }
+            break;
+          } else if (timeStamps[j].type == TimeStampType::Stop &&
+                     numInnerMatchingIdentifiers > 0) {
+            // inner stop with matching identifier
+            --numInnerMatchingIdentifiers;
+          } else if (timeStamps[j].type == TimeStampType::Start) {
+            // inner start with matching identifier
+            ++numInnerMatchingIdentifiers;
+          }
+        }
+      }
+      if (pair.stopIdx == 0) {
+        warnings << "rt_graph WARNING: Start / stop time stamps do not match for \""
+                 << timeStamps[i].identifierPtr << "\"!" << std::endl;
+      }
+    }
+  }
+
+  // create tree of timings where sub-nodes represent timings fully enclosed by another start /
+  // stop pair. Use the fact that timePairs is sorted by startIdx
+  for (std::size_t i = 0; i < timePairs.size(); ++i) {
+    auto& pair = timePairs[i];
+
+    // find potential parent by going backwards through pairs, starting with the current pair
+    // position
+    for (auto timePairIt = timePairs.rbegin() + (timePairs.size() - i);
+         timePairIt != timePairs.rend(); ++timePairIt) {
+      if (timePairIt->stopIdx > pair.stopIdx && timePairIt->nodePtr != nullptr) {
+        auto& parentNode = *(timePairIt->nodePtr);
+        // check if sub-node with identifier exists
+        bool nodeFound = false;
+        for (auto& subNode : parentNode.subNodes) {
+          if (subNode.identifier == pair.identifier) {
+            nodeFound = true;
+            subNode.add_time(pair.startTime, pair.time);
+            // mark node position in pair for finding sub-nodes
+            pair.nodePtr = &(subNode);
+            break;
+          }
+        }
+        if (!nodeFound) {
+          // create new sub-node
+          TimingNode newNode;
+          newNode.identifier = pair.identifier;
+          newNode.add_time(pair.startTime, pair.time);
+          parentNode.subNodes.push_back(std::move(newNode));
+          // mark node position in pair for finding sub-nodes
+          pair.nodePtr = &(parentNode.subNodes.back());
+        }
+        break;
+      }
+    }
+
+    // No parent found, must be top level node
+    if (pair.nodePtr == nullptr) {
+      // Check if top level node with same name exists
+      for (auto& topNode : results) {
+        if (topNode.identifier == pair.identifier) {
+          topNode.add_time(pair.startTime, pair.time);
+          pair.nodePtr = &(topNode);
+          break;
+        }
+      }
+    }
+
+    // New top level node
+    if (pair.nodePtr == nullptr) {
+      TimingNode newNode;
+      newNode.identifier = pair.identifier;
+      newNode.add_time(pair.startTime, pair.time);
+      // newNode.parent = nullptr;
+      results.push_back(std::move(newNode));
+
+      // mark node position in pair for finding sub-nodes
+      pair.nodePtr = &(results.back());
+    }
+  }
+}
+
+// convert the sub-nodes of an aggregated call tree node into timing nodes
+auto convert_aggregate_nodes(const ThreadBuffer& buffer, std::size_t nodeIdx,
+                             std::list<TimingNode>& results) -> void {
+  for (const auto childIdx : buffer.nodes[nodeIdx].children) {
+    const auto& child = buffer.nodes[childIdx];
+    TimingNode newNode;
+    newNode.identifier = child.identifierPtr;
+    newNode.add_aggregate(child.count, child.totalTime, child.minTime, child.maxTime);
+    convert_aggregate_nodes(buffer, childIdx, newNode.subNodes);
+    results.push_back(std::move(newNode));
+  }
+}
+
+auto escape_json(const char* str) -> std::string {
+  std::string result;
+  for (; *str; ++str) {
+    if (*str == '"' || *str == '\\') result += '\\';
+    result += *str;
+  }
+  return result;
+}
+
 }  // namespace
+
+// ======================
+// ThreadBuffer
+// ======================
+auto ThreadBuffer::aggregate_start(const char* identifierPtr) -> void {
+  const auto parentIdx = stack.empty() ? std::size_t(0) : stack.back().first;
+  std::size_t nodeIdx = 0;
+  // compare pointers first, identical literals in different translation units may differ
+  for (const auto childIdx : nodes[parentIdx].children) {
+    const char* childPtr = nodes[childIdx].identifierPtr;
+    if (childPtr == identifierPtr || std::strcmp(childPtr, identifierPtr) == 0) {
+      nodeIdx = childIdx;
+      break;
+    }
+  }
+  if (nodeIdx == 0) {
+    // new call path; the identifier must outlive the buffer, so store it interned
+    nodeIdx = nodes.size();
+    nodes.emplace_back();
+    nodes.back().identifierPtr = intern(identifierPtr);
+    nodes.back().parent = parentIdx;
+    nodes[parentIdx].children.push_back(nodeIdx);
+  }
+  stack.emplace_back(nodeIdx, ClockType::now());
+}
+
+auto ThreadBuffer::aggregate_stop(const char* identifierPtr) -> void {
+  const auto time = ClockType::now();
+  if (stack.empty()) {
+    ++numMismatches;
+    return;
+  }
+  auto& node = nodes[stack.back().first];
+  if (node.identifierPtr != identifierPtr && std::strcmp(node.identifierPtr, identifierPtr) != 0) {
+    ++numMismatches;
+    return;
+  }
+  const double t = std::chrono::duration<double>(time - stack.back().second).count();
+  node.minTime = node.count ? std::min(node.minTime, t) : t;
+  node.maxTime = node.count ? std::max(node.maxTime, t) : t;
+  node.totalTime += t;
+  ++node.count;
+  stack.pop_back();
+}
+
 }  // namespace internal
 
 // ======================
 // Timer
 // ======================
+auto Timer::register_thread() -> internal::ThreadBuffer& {
+  std::lock_guard<std::mutex> guard(mutex_);
+  // the thread may already own a buffer, if it alternates between several timers
+  const auto threadId = std::this_thread::get_id();
+  for (auto& buffer : buffers_) {
+    if (buffer.threadId == threadId) return buffer;
+  }
+  buffers_.emplace_back();
+  auto& buffer = buffers_.back();
+  buffer.threadId = threadId;
+  buffer.threadIndex = static_cast<int>(buffers_.size()) - 1;
+  // worker threads usually record far less than the main thread
+  buffer.timeStamps.reserve(buffers_.size() == 1 ? reserveCount_
+                                                 : std::min<std::size_t>(reserveCount_, 1000));
+  return buffer;
+}
+
+auto Timer::clear(std::size_t reserveCount) -> void {
+  std::lock_guard<std::mutex> guard(mutex_);
+  reserveCount_ = reserveCount;
+  // buffers are kept, since threads cache a pointer to them. Interned identifiers are kept, since
+  // they may still be referenced by active scoped timings.
+  for (auto& buffer : buffers_) {
+    buffer.timeStamps.clear();
+    buffer.timeStamps.shrink_to_fit();
+    buffer.timeStamps.reserve(buffer.threadIndex == 0 ? reserveCount
+                                                      : std::min<std::size_t>(reserveCount, 1000));
+    buffer.nodes.assign(1, internal::AggregateNode());
+    buffer.stack.clear();
+    buffer.numMismatches = 0;
+  }
+}
+
+auto Timer::set_mode(TimerMode mode) -> void {
+  this->clear(reserveCount_);
+  mode_ = mode;
+}
+
 auto Timer::process() const -> TimingResult {
+  std::lock_guard<std::mutex> guard(mutex_);
   std::list<internal::TimingNode> results;
   std::stringstream warnings;
 
   try {
-    std::vector<internal::TimeStampPair> timePairs;
-    timePairs.reserve(timeStamps_.size() / 2);
-
-    // create pairs of start / stop timings
-    for (std::size_t i = 0; i < timeStamps_.size(); ++i) {
-      if (timeStamps_[i].type == internal::TimeStampType::Start) {
-        internal::TimeStampPair pair;
-        pair.startIdx = i;
-        pair.identifier = std::string(timeStamps_[i].identifierPtr);
-        std::size_t numInnerMatchingIdentifiers = 0;
-        // search for matching stop after start
-        for (std::size_t j = i + 1; j < timeStamps_.size(); ++j) {
-          // only consider matching identifiers
-          if (std::string(timeStamps_[j].identifierPtr) ==
-              std::string(timeStamps_[i].identifierPtr)) {
-            if (timeStamps_[j].type == internal::TimeStampType::Stop &&
-                numInnerMatchingIdentifiers == 0) {
-              // Matching stop found
-              std::chrono::duration<double> duration = timeStamps_[j].time - timeStamps_[i].time;
-              pair.time = duration.count();
-              duration = timeStamps_[i].time - timeStamps_[0].time;
-              pair.startTime = duration.count();
-              pair.stopIdx = j;
-              timePairs.push_back(pair);
-              if (pair.time < 0 || pair.startTime < 0) {
-                warnings << "rt_graph WARNING:Measured time is negative. Non-steady system-clock?!"
-                         << std::endl;
-              }
-              break;
-            } else if (timeStamps_[j].type == internal::TimeStampType::Stop &&
-                       numInnerMatchingIdentifiers > 0) {
-              // inner stop with matching identifier
-              --numInnerMatchingIdentifiers;
-            } else if (timeStamps_[j].type == internal::TimeStampType::Start) {
-              // inner start with matching identifier
-              ++numInnerMatchingIdentifiers;
-            }
-          }
-        }
-        if (pair.stopIdx == 0) {
-          warnings << "rt_graph WARNING: Start / stop time stamps do not match for \""
-                   << timeStamps_[i].identifierPtr << "\"!" << std::endl;
-        }
-      }
+    // common time origin of all threads
+    ClockType::time_point origin = ClockType::time_point::max();
+    for (const auto& buffer : buffers_) {
+      if (!buffer.timeStamps.empty()) origin = std::min(origin, buffer.timeStamps.front().time);
     }
 
-    // create tree of timings where sub-nodes represent timings fully enclosed by another start /
-    // stop pair. Use the fact that timePairs is sorted by startIdx
-    for (std::size_t i = 0; i < timePairs.size(); ++i) {
-      auto& pair = timePairs[i];
-
-      // find potential parent by going backwards through pairs, starting with the current pair
-      // position
-      for (auto timePairIt = timePairs.rbegin() + (timePairs.size() - i);
-           timePairIt != timePairs.rend(); ++timePairIt) {
-        if (timePairIt->stopIdx > pair.stopIdx && timePairIt->nodePtr != nullptr) {
-          auto& parentNode = *(timePairIt->nodePtr);
-          // check if sub-node with identifier exists
-          bool nodeFound = false;
-          for (auto& subNode : parentNode.subNodes) {
-            if (subNode.identifier == pair.identifier) {
-              nodeFound = true;
-              subNode.add_time(pair.startTime, pair.time);
-              // mark node position in pair for finding sub-nodes
-              pair.nodePtr = &(subNode);
-              break;
-            }
-          }
-          if (!nodeFound) {
-            // create new sub-node
-            internal::TimingNode newNode;
-            newNode.identifier = pair.identifier;
-            newNode.add_time(pair.startTime, pair.time);
-            parentNode.subNodes.push_back(std::move(newNode));
-            // mark node position in pair for finding sub-nodes
-            pair.nodePtr = &(parentNode.subNodes.back());
-          }
-          break;
+    for (const auto& buffer : buffers_) {
+      std::list<internal::TimingNode> threadResults;
+      if (mode_ == TimerMode::Record) {
+        internal::process_time_stamps(buffer.timeStamps, origin, threadResults, warnings);
+      } else {
+        internal::convert_aggregate_nodes(buffer, 0, threadResults);
+        if (buffer.numMismatches || !buffer.stack.empty()) {
+          warnings << "rt_graph WARNING: Start / stop calls do not match for "
+                   << buffer.numMismatches + buffer.stack.size() << " aggregated timings!"
+                   << std::endl;
         }
       }
-
-      // No parent found, must be top level node
-      if (pair.nodePtr == nullptr) {
-        // Check if top level node with same name exists
-        for (auto& topNode : results) {
-          if (topNode.identifier == pair.identifier) {
-            topNode.add_time(pair.startTime, pair.time);
-            pair.nodePtr = &(topNode);
-            break;
-          }
+      // timings of other threads than the first one are labeled by the thread
+      if (buffer.threadIndex > 0) {
+        for (auto& node : threadResults) {
+          node.identifier = "thread " + std::to_string(buffer.threadIndex) + ": " + node.identifier;
         }
       }
-
-      // New top level node
-      if (pair.nodePtr == nullptr) {
-        internal::TimingNode newNode;
-        newNode.identifier = pair.identifier;
-        newNode.add_time(pair.startTime, pair.time);
-        // newNode.parent = nullptr;
-        results.push_back(std::move(newNode));
-
-        // mark node position in pair for finding sub-nodes
-        pair.nodePtr = &(results.back());
-      }
+      results.splice(results.end(), threadResults);
     }
   } catch (const std::exception& e) {
     warnings << "rt_graph WARNING: Processing of timings failed: " << e.what() << std::endl;
@@ -552,6 +706,33 @@ auto Timer::process() const -> TimingResult {
   return TimingResult(std::move(results), warnings.str());
 }
 
+auto Timer::trace_json() const -> std::string {
+  std::lock_guard<std::mutex> guard(mutex_);
+  ClockType::time_point origin = ClockType::time_point::max();
+  for (const auto& buffer : buffers_) {
+    if (!buffer.timeStamps.empty()) origin = std::min(origin, buffer.timeStamps.front().time);
+  }
+
+  std::stringstream stream;
+  stream << std::fixed << std::setprecision(3);
+  stream << "{\"traceEvents\" : [" << std::endl;
+  bool first = true;
+  for (const auto& buffer : buffers_) {
+    for (const auto& stamp : buffer.timeStamps) {
+      if (stamp.type == internal::TimeStampType::Empty) continue;
+      if (!first) stream << "," << std::endl;
+      first = false;
+      const std::chrono::duration<double, std::micro> ts = stamp.time - origin;
+      stream << "  {\"name\" : \"" << internal::escape_json(stamp.identifierPtr)
+             << "\", \"ph\" : \"" << (stamp.type == internal::TimeStampType::Start ? "B" : "E")
+             << "\", \"ts\" : " << ts.count() << ", \"pid\" : 0, \"tid\" : "
+             << buffer.threadIndex << "}";
+    }
+  }
+  stream << std::endl << "]}" << std::endl;
+  return stream.str();
+}
+
 auto TimingResult::json() const -> std::string {
   std::stringstream jsonStream;
   jsonStream << std::scientific;
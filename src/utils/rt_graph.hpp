@@ -29,12 +29,17 @@
 #ifndef RT_GRAPH_HPP_GUARD
 #define RT_GRAPH_HPP_GUARD
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <cstddef>
 #include <deque>
 #include <list>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 namespace rt_graph {
@@ -57,6 +62,12 @@ enum class Stat {
   SelfPercentage     // Percentage of accumulated time not spend in sub-timings
 };
 
+// Recording mode of the timer
+enum class TimerMode {
+  Record,    // store all time stamps (full statistics, start times and trace export)
+  Aggregate  // accumulate count, total, min and max per call path (constant memory)
+};
+
 // internal helper functionality
 namespace internal {
 
@@ -65,7 +76,7 @@ enum class TimeStampType { Start, Stop, Empty };
 struct TimeStamp {
   TimeStamp() : type(TimeStampType::Empty) {}
 
-  // Identifier pointer must point to compile time string literal
+  // Identifier pointer must point to compile time string literal or interned string
   TimeStamp(const char* identifier, const TimeStampType& stampType)
       : time(ClockType::now()), identifierPtr(identifier), type(stampType) {}
 
@@ -80,12 +91,56 @@ struct TimingNode {
   std::vector<double> startTimes;
   std::list<TimingNode> subNodes;
   double totalTime = 0.0;
+  std::size_t count = 0;
+  double minTime = 0.0;
+  double maxTime = 0.0;
 
   inline void add_time(double startTime, double t) {
     startTimes.push_back(startTime);
     timings.push_back(t);
-    totalTime += t;
+    add_aggregate(1, t, t, t);
+  }
+
+  // add timings without storing individual measurements
+  inline void add_aggregate(std::size_t n, double total, double tMin, double tMax) {
+    if (n == 0) return;
+    minTime = count ? std::min(minTime, tMin) : tMin;
+    maxTime = count ? std::max(maxTime, tMax) : tMax;
+    count += n;
+    totalTime += total;
+  }
+};
+
+// Node of the call tree in aggregation mode
+struct AggregateNode {
+  const char* identifierPtr = nullptr;
+  std::size_t parent = 0;
+  std::vector<std::size_t> children;
+  std::size_t count = 0;
+  double totalTime = 0.0;
+  double minTime = 0.0;
+  double maxTime = 0.0;
+};
+
+// Time stamps and identifiers of a single thread. Only the owning thread writes to the buffer.
+struct ThreadBuffer {
+  std::thread::id threadId;
+  int threadIndex = 0;
+  std::vector<TimeStamp> timeStamps;
+  // interned string identifiers; pointers to elements remain valid after insertion
+  std::unordered_set<std::string> identifierStrings;
+  // aggregation mode: call tree (node 0 is the root) and stack of open timings
+  std::vector<AggregateNode> nodes = std::vector<AggregateNode>(1);
+  std::vector<std::pair<std::size_t, ClockType::time_point>> stack;
+  std::size_t numMismatches = 0;
+
+  inline auto intern(std::string identifier) -> const char* {
+    return identifierStrings.insert(std::move(identifier)).first->c_str();
   }
+
+  auto aggregate_start(const char* identifierPtr) -> void;
+
+  auto aggregate_stop(const char* identifierPtr) -> void;
 };
 }  // namespace internal
 
@@ -121,71 +176,126 @@ private:
 class ScopedTiming;
 
 // Timer class, which allows to start / stop measurements with a given identifier.
+// Each thread records into its own buffer, so start / stop can be called from within OpenMP
+// regions. Measurements of the thread which recorded first (usually the main thread) form the
+// timing graph; graphs of other threads are added as separate root nodes labeled by the thread.
 class Timer {
 public:
   // reserve space for 1000'000 measurements
-  Timer() { timeStamps_.reserve(2 * 1000 * 1000); }
+  Timer() : Timer(1000 * 1000) {}
 
   // reserve space for given number of measurements
-  explicit Timer(std::size_t reserveCount) { timeStamps_.reserve(2 * reserveCount); }
+  explicit Timer(std::size_t reserveCount)
+      : id_(next_id()), reserveCount_(2 * reserveCount) {}
+
+  Timer(const Timer&) = delete;
+  auto operator=(const Timer&) -> Timer& = delete;
 
   // start with string literal identifier
   template <std::size_t N>
   inline auto start(const char (&identifierPtr)[N]) -> void {
-    atomic_signal_fence(std::memory_order_seq_cst);  // only prevents compiler reordering
-    timeStamps_.emplace_back(identifierPtr, internal::TimeStampType::Start);
-    atomic_signal_fence(std::memory_order_seq_cst);  // only prevents compiler reordering
+    start_with_ptr(identifierPtr);
   }
 
-  // start with string identifier (storing string object comes with some additional overhead)
+  // start with string identifier (the string is interned, so repeated identifiers are stored once)
   inline auto start(std::string identifier) -> void {
-    atomic_signal_fence(std::memory_order_seq_cst);  // only prevents compiler reordering
-    identifierStrings_.emplace_back(std::move(identifier));
-    timeStamps_.emplace_back(identifierStrings_.back().c_str(), internal::TimeStampType::Start);
-    atomic_signal_fence(std::memory_order_seq_cst);  // only prevents compiler reordering
+    auto& buffer = thread_buffer();
+    start_with_ptr(buffer.intern(std::move(identifier)), buffer);
   }
 
   // stop with string literal identifier
   template <std::size_t N>
   inline auto stop(const char (&identifierPtr)[N]) -> void {
-    atomic_signal_fence(std::memory_order_seq_cst);  // only prevents compiler reordering
-    timeStamps_.emplace_back(identifierPtr, internal::TimeStampType::Stop);
-    atomic_signal_fence(std::memory_order_seq_cst);  // only prevents compiler reordering
+    stop_with_ptr(identifierPtr);
   }
 
-  // stop with string identifier (storing string object comes with some additional overhead)
+  // stop with string identifier (the string is interned, so repeated identifiers are stored once)
   inline auto stop(std::string identifier) -> void {
-    atomic_signal_fence(std::memory_order_seq_cst);  // only prevents compiler reordering
-    identifierStrings_.emplace_back(std::move(identifier));
-    timeStamps_.emplace_back(identifierStrings_.back().c_str(), internal::TimeStampType::Stop);
-    atomic_signal_fence(std::memory_order_seq_cst);  // only prevents compiler reordering
+    auto& buffer = thread_buffer();
+    stop_with_ptr(buffer.intern(std::move(identifier)), buffer);
   }
 
-  // clear timer and reserve space for given number of new measurements.
-  inline auto clear(std::size_t reserveCount) -> void {
-    timeStamps_.clear();
-    identifierStrings_.clear();
-    this->reserve(reserveCount);
+  // clear timer and reserve space for given number of new measurements. Must not be called
+  // concurrently with start / stop.
+  auto clear(std::size_t reserveCount) -> void;
+
+  // reserve space for given number of measurements of the calling thread. Can prevent allocations
+  // at start / stop calls.
+  inline auto reserve(std::size_t reserveCount) -> void {
+    reserveCount_ = reserveCount;
+    thread_buffer().timeStamps.reserve(reserveCount);
   }
 
-  // reserve space for given number of measurements. Can prevent allocations at start / stop calls.
-  inline auto reserve(std::size_t reserveCount) -> void { timeStamps_.reserve(reserveCount); }
+  // set the recording mode; recorded measurements are discarded. Must not be called concurrently
+  // with start / stop.
+  auto set_mode(TimerMode mode) -> void;
+
+  inline auto mode() const -> TimerMode { return mode_; }
 
   // process timings into result type
   auto process() const -> TimingResult;
 
+  // export recorded time stamps of all threads in the Chrome trace event format (JSON), which can
+  // be loaded into chrome://tracing or Perfetto. Unit of time is microseconds. Empty in aggregation
+  // mode.
+  auto trace_json() const -> std::string;
+
 private:
+  static auto next_id() -> std::size_t {
+    static std::atomic<std::size_t> counter(0);
+    return ++counter;
+  }
+
+  // get buffer of the calling thread; lock is only taken at the first call of a thread
+  inline auto thread_buffer() -> internal::ThreadBuffer& {
+    thread_local std::size_t cachedId = 0;
+    thread_local internal::ThreadBuffer* cachedBuffer = nullptr;
+    if (cachedId != id_) {
+      cachedBuffer = &register_thread();
+      cachedId = id_;
+    }
+    return *cachedBuffer;
+  }
+
+  auto register_thread() -> internal::ThreadBuffer&;
+
+  inline auto start_with_ptr(const char* identifierPtr) -> void {
+    start_with_ptr(identifierPtr, thread_buffer());
+  }
+
+  inline auto start_with_ptr(const char* identifierPtr, internal::ThreadBuffer& buffer) -> void {
+    atomic_signal_fence(std::memory_order_seq_cst);  // only prevents compiler reordering
+    if (mode_ == TimerMode::Record) {
+      buffer.timeStamps.emplace_back(identifierPtr, internal::TimeStampType::Start);
+    } else {
+      buffer.aggregate_start(identifierPtr);
+    }
+    atomic_signal_fence(std::memory_order_seq_cst);  // only prevents compiler reordering
+  }
+
   inline auto stop_with_ptr(const char* identifierPtr) -> void {
+    stop_with_ptr(identifierPtr, thread_buffer());
+  }
+
+  inline auto stop_with_ptr(const char* identifierPtr, internal::ThreadBuffer& buffer) -> void {
     atomic_signal_fence(std::memory_order_seq_cst);  // only prevents compiler reordering
-    timeStamps_.emplace_back(identifierPtr, internal::TimeStampType::Stop);
+    if (mode_ == TimerMode::Record) {
+      buffer.timeStamps.emplace_back(identifierPtr, internal::TimeStampType::Stop);
+    } else {
+      buffer.aggregate_stop(identifierPtr);
+    }
     atomic_signal_fence(std::memory_order_seq_cst);  // only prevents compiler reordering
   }
 
   friend ScopedTiming;
 
-  std::vector<internal::TimeStamp> timeStamps_;
-  std::deque<std::string>
-      identifierStrings_;  // pointer to elements always remain valid after push back
+  // unique id of the timer, used to find the buffer of a thread
+  std::size_t id_;
+  std::size_t reserveCount_;
+  TimerMode mode_ = TimerMode::Record;
+  mutable std::mutex mutex_;
+  // pointer to elements always remain valid after push back
+  std::deque<internal::ThreadBuffer> buffers_;
 };
 
 // Helper class, which calls start() upon creation and stop() on timer when leaving scope with given
@@ -195,13 +305,14 @@ public:
   // timer reference must be valid for the entire lifetime
   template <std::size_t N>
   ScopedTiming(const char (&identifierPtr)[N], Timer& timer)
-      : identifierPtr_(identifierPtr), timer_(timer) {
-    timer_.start(identifierPtr);
+      : identifierPtr_(identifierPtr), timer_(timer), buffer_(timer.thread_buffer()) {
+    timer_.start_with_ptr(identifierPtr_, buffer_);
   }
 
   ScopedTiming(std::string identifier, Timer& timer)
-      : identifierPtr_(nullptr), identifier_(std::move(identifier)), timer_(timer) {
-    timer_.start(identifier_);
+      : timer_(timer), buffer_(timer.thread_buffer()) {
+    identifierPtr_ = buffer_.intern(std::move(identifier));
+    timer_.start_with_ptr(identifierPtr_, buffer_);
   }
 
   ScopedTiming(const ScopedTiming&) = delete;
@@ -209,18 +320,12 @@ public:
   auto operator=(const ScopedTiming&) -> ScopedTiming& = delete;
   auto operator=(ScopedTiming &&) -> ScopedTiming& = delete;
 
-  ~ScopedTiming() {
-    if (identifierPtr_) {
-      timer_.stop_with_ptr(identifierPtr_);
-    } else {
-      timer_.stop(std::move(identifier_));
-    }
-  }
+  ~ScopedTiming() { timer_.stop_with_ptr(identifierPtr_, buffer_); }
 
 private:
   const char* identifierPtr_;
-  std::string identifier_;
   Timer& timer_;
+  internal::ThreadBuffer& buffer_;
 };
 
 }  // namespace rt_graph
@@ -0,0 +1,140 @@
+// Copyright (c) 2013-2020 Anton Kozhevnikov, Thomas Schulthess
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+// the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+//    following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+//    and the following disclaimer in the documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** \file thread_policy.hpp
+ *
+ *  \brief Number of threads for the different stages of the calculation.
+ */
+
+#ifndef __THREAD_POLICY_HPP__
+#define __THREAD_POLICY_HPP__
+
+#include <array>
+#include <string>
+#include <sstream>
+#include "SDDK/omp.hpp"
+#include "utils/profiler.hpp"
+#if defined(__MKL)
+#include <mkl_service.h>
+#endif
+
+namespace utils {
+
+/// Stages of the calculation with a separate number of threads.
+enum class thread_stage_t : int
+{
+    /// OpenMP loops of the code; this is the default stage.
+    loops = 0,
+    /// Calls to the threaded BLAS and LAPACK libraries.
+    blas  = 1,
+    /// FFT transformations and the loops of the local Hamiltonian and density around them.
+    fft   = 2
+};
+
+/// Number of threads for each stage of the calculation.
+/** A non-positive value means the default number of OpenMP threads. */
+class thread_policy
+{
+  private:
+    std::array<int, 3> num_threads_;
+
+  public:
+    thread_policy(int num_threads_loops__ = 0, int num_threads_blas__ = 0, int num_threads_fft__ = 0)
+    {
+        int nt = omp_get_max_threads();
+        num_threads_[0] = (num_threads_loops__ > 0) ? num_threads_loops__ : nt;
+        num_threads_[1] = (num_threads_blas__ > 0) ? num_threads_blas__ : num_threads_[0];
+        num_threads_[2] = (num_threads_fft__ > 0) ? num_threads_fft__ : num_threads_[0];
+    }
+
+    /// Number of threads of a stage.
+    inline int num_threads(thread_stage_t stage__) const
+    {
+        return num_threads_[static_cast<int>(stage__)];
+    }
+
+    /// Label of the stage with the number of threads, e.g. "blas:4".
+    inline std::string label(thread_stage_t stage__) const
+    {
+        const char* names[] = {"loops", "blas", "fft"};
+        std::stringstream s;
+        s << names[static_cast<int>(stage__)] << ":" << num_threads(stage__);
+        return s.str();
+    }
+};
+
+/// Set the number of threads of a stage for the lifetime of the guard.
+/** The number of OpenMP threads (and the number of MKL threads of the calling thread) is changed at the stage
+ *  boundary and restored at the exit. Inside a parallel region the guard does nothing. The stage with its
+ *  number of threads is recorded as a timer, so the chosen settings appear in the timer output. */
+class thread_guard
+{
+  private:
+    bool active_{false};
+    int num_threads_old_{0};
+#if defined(__MKL)
+    int num_threads_mkl_old_{0};
+#endif
+#if defined(__PROFILE)
+    std::string label_;
+#endif
+    thread_guard(thread_guard const& src__) = delete;
+    thread_guard& operator=(thread_guard const& src__) = delete;
+
+  public:
+    thread_guard(thread_policy const& policy__, thread_stage_t stage__)
+    {
+        if (omp_in_parallel()) {
+            return;
+        }
+        active_          = true;
+        num_threads_old_ = omp_get_max_threads();
+        int nt           = policy__.num_threads(stage__);
+        if (nt != num_threads_old_) {
+            omp_set_num_threads(nt);
+        }
+#if defined(__MKL)
+        num_threads_mkl_old_ = mkl_set_num_threads_local(nt);
+#endif
+#if defined(__PROFILE)
+        label_ = "sirius::threads|" + policy__.label(stage__);
+        PROFILE_START(label_);
+#endif
+    }
+
+    ~thread_guard()
+    {
+        if (!active_) {
+            return;
+        }
+#if defined(__PROFILE)
+        PROFILE_STOP(label_);
+#endif
+#if defined(__MKL)
+        mkl_set_num_threads_local(num_threads_mkl_old_);
+#endif
+        if (omp_get_max_threads() != num_threads_old_) {
+            omp_set_num_threads(num_threads_old_);
+        }
+    }
+};
+
+} // namespace utils
+
+#endif // __THREAD_POLICY_HPP__